@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# usage : ./bench.sh [toutes|uniforme|groupee|riche|affamee|guerre] [nb_fourmis_max]
+# écrit le tableau dans "resultats.txt" et les courbes d'échelle au format
+# de gnuplot dans "bench.dat"
+
+SOURCE_FOLDER="../source/"
+BENCH_PATH="../source/bench.x"
+
+cp "../r3/Makefile" $SOURCE_FOLDER
+make -C $SOURCE_FOLDER depend
+make -C $SOURCE_FOLDER bench.x
+cp $BENCH_PATH "."
+
+if [ -f "bench.x" ];
+then
+    echo "Running bench.x $@!"
+    "./"bench.x "$@" | tee "resultats.txt"
+    echo "Done!"
+else
+    echo "File bench.x does not exists. Please use make first"
+fi
@@ -0,0 +1,118 @@
+/*!
+ \file aleatoire.c
+ \brief Module qui fournit le générateur pseudo-aléatoire de la simulation,
+  dont l'état peut être sauvegardé et restauré
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "binaire.h"
+#include "aleatoire.h"
+
+// générateur additif x[i] = x[i-3] + x[i-31] de random() (TYPE_3)
+#define NB_ETATS 31
+#define DECALAGE 3
+#define NB_TIRAGES_ECARTES (10*NB_ETATS)
+
+static int32_t etats[NB_ETATS];
+static int avant = DECALAGE, arriere = 0; // indices des deux termes ajoutés
+static bool seme = false;
+
+void aleatoire_semer(unsigned graine)
+{
+    int32_t mot;
+    int i;
+    
+    if(!graine)
+        graine = 1;
+    
+    //etats[i] = 16807*etats[i-1] % 2147483647 sans dépasser 31 bits
+    etats[0] = mot = graine;
+    for(i=1 ; i<NB_ETATS ; i++)
+    {
+        long haut = mot/127773, bas = mot%127773;
+        
+        mot = 16807*bas - 2836*haut;
+        if(mot < 0)
+            mot += 2147483647;
+        etats[i] = mot;
+    }
+    
+    avant = DECALAGE;
+    arriere = 0;
+    seme = true;
+    
+    for(i=0 ; i<NB_TIRAGES_ECARTES ; i++)
+        aleatoire_tirer();
+}
+
+int aleatoire_tirer(void)
+{
+    uint32_t valeur;
+    
+    if(!seme)
+        aleatoire_semer(1);
+    
+    valeur = (uint32_t) etats[avant] + (uint32_t) etats[arriere];
+    etats[avant] = (int32_t) valeur;
+    
+    avant = (avant + 1)%NB_ETATS;
+    arriere = (arriere + 1)%NB_ETATS;
+    
+    return valeur >> 1;
+}
+
+void aleatoire_ecriture_binaire(TAMPON * tampon)
+{
+    int i;
+    
+    if(!seme)
+        aleatoire_semer(1);
+    
+    for(i=0 ; i<NB_ETATS ; i++)
+        binaire_ecrire_entier32(tampon, (uint32_t) etats[i]);
+    binaire_ecrire_entier32(tampon, avant);
+    binaire_ecrire_entier32(tampon, arriere);
+}
+
+bool aleatoire_lecture_binaire(LECTURE_BINAIRE * lecture)
+{
+    int32_t lus[NB_ETATS];
+    uint32_t lu_avant, lu_arriere;
+    int i;
+    
+    for(i=0 ; i<NB_ETATS ; i++)
+        lus[i] = (int32_t) binaire_lire_entier32(lecture);
+    lu_avant = binaire_lire_entier32(lecture);
+    lu_arriere = binaire_lire_entier32(lecture);
+    
+    //les deux indices restent toujours à DECALAGE l'un de l'autre
+    if(lecture->erreur || lu_avant >= NB_ETATS || 
+       lu_arriere != (lu_avant + NB_ETATS - DECALAGE)%NB_ETATS)
+        return 0;
+    
+    for(i=0 ; i<NB_ETATS ; i++)
+        etats[i] = lus[i];
+    avant = lu_avant;
+    arriere = lu_arriere;
+    seme = true;
+    return 1;
+}
+
+void aleatoire_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter)
+{
+    uint64_t entite = empreinte_entier(empreinte_debut(), seme);
+    int i;
+    
+    //les états en partant du prochain terme ajouté, pour ne pas dépendre
+    //de la place de l'anneau où en est le générateur
+    for(i=0 ; i<NB_ETATS ; i++)
+        entite = empreinte_entier(entite, (uint32_t) etats[(avant + i)%NB_ETATS]);
+    empreinte_ajouter(empreinte, EMPREINTE_COMPTEURS,
+                      EMPREINTE_COMPTEURS_ALEATOIRE, entite, noter);
+}
@@ -0,0 +1,41 @@
+/*!
+ \file aleatoire.h
+ \brief Module qui fournit le générateur pseudo-aléatoire de la simulation,
+  dont l'état peut être sauvegardé et restauré
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef ALEATOIRE_H
+#define ALEATOIRE_H
+
+#include <stdbool.h>
+#include "binaire.h"
+#include "empreinte.h"
+
+#define ALEATOIRE_MAX 2147483647 // plus grande valeur tirée
+
+//---------------------------------------------------------------------
+// réinitialise le générateur avec la graine ; sans appel, la suite est
+// celle de la graine 1, comme pour rand()
+void aleatoire_semer(unsigned graine);
+
+//---------------------------------------------------------------------
+// tire un entier entre 0 et ALEATOIRE_MAX ; la suite est la même que
+// celle de rand() de la glibc pour la même graine
+int aleatoire_tirer(void);
+
+//---------------------------------------------------------------------
+// ajoute l'état du générateur au tampon
+void aleatoire_ecriture_binaire(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// restaure l'état du générateur écrit par aleatoire_ecriture_binaire
+bool aleatoire_lecture_binaire(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// ajoute à l'empreinte l'état du générateur, qui fixe toute la suite
+void aleatoire_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter);
+
+#endif
@@ -0,0 +1,331 @@
+/*!
+ \file arbre_kd.c
+ \brief Module qui met à disposition un arbre k-d en deux dimensions pour
+  la recherche du point le plus proche
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "utilitaire.h"
+#include "memoire.h"
+#include "arbre_kd.h"
+
+/*---------------------------------------------------------------------
+ Structure de données d'un arbre k-d
+	points : points rangés de sorte que le milieu de chaque intervalle
+             soit le noeud qui le sépare selon x (profondeur paire)
+             ou selon y (profondeur impaire)
+	nb : nombre de points
+	capacite : taille allouée du tableau points
+ ----------------------------------------------------------------------*/
+struct ArbreKd
+{
+    POINT_KD * points;
+    int nb;
+    int capacite;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données de l'état d'une recherche
+	x , y : point dont on cherche le plus proche voisin
+	indice_exclu : indice qui ne peut pas être retenu
+	distance : plus petite distance trouvée (ou la borne de départ)
+	indice : indice du point retenu
+	trouve : vrai si un point a été retenu
+ ----------------------------------------------------------------------*/
+typedef struct RechercheKd RECHERCHE_KD;
+struct RechercheKd
+{
+    double x;
+    double y;
+    int indice_exclu;
+    double distance;
+    int indice;
+    bool trouve;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données de l'état d'une recherche des k plus proches
+	x , y : point dont on cherche les voisins
+	k : nombre de voisins cherchés
+	nb : nombre de voisins déjà retenus
+	distance_max : borne de départ
+	indices, distances : voisins retenus, par distance croissante
+ ----------------------------------------------------------------------*/
+typedef struct RechercheKPlusProches RECHERCHE_K;
+struct RechercheKPlusProches
+{
+    double x;
+    double y;
+    int k;
+    int nb;
+    double distance_max;
+    int * indices;
+    double * distances;
+};
+
+static double arbre_kd_coordonnee(const POINT_KD * point, int axe);
+static void arbre_kd_selectionner(POINT_KD * points, int nb, int rang, int axe);
+static void arbre_kd_ranger(POINT_KD * points, int nb, int profondeur);
+static void arbre_kd_parcours(const POINT_KD * points, int nb, int profondeur,
+                              RECHERCHE_KD * recherche);
+static void arbre_kd_parcours_k(const POINT_KD * points, int nb, int profondeur,
+                                RECHERCHE_K * recherche);
+static double arbre_kd_borne_k(const RECHERCHE_K * recherche);
+
+ARBRE_KD * arbre_kd_creer(void)
+{
+    ARBRE_KD * arbre = NULL;
+
+    if(!(arbre = (ARBRE_KD *) memoire_allouer (sizeof(ARBRE_KD))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+
+    arbre->points = NULL;
+    arbre->nb = 0;
+    arbre->capacite = 0;
+    return arbre;
+}
+
+void arbre_kd_detruire(ARBRE_KD * arbre)
+{
+    if(!arbre)
+        return;
+
+    free(arbre->points);
+    free(arbre);
+}
+
+void arbre_kd_construire(ARBRE_KD * arbre, const POINT_KD * points, int nb)
+{
+    int i;
+
+    if(nb > arbre->capacite)
+    {
+        POINT_KD * nouveau = 
+            (POINT_KD *) memoire_reallouer (arbre->points, nb*sizeof(POINT_KD));
+        if(!nouveau)
+        {
+            printf("Problème de mémoire dans la fonction %s\n", __func__);
+            arbre->nb = 0;
+            return;
+        }
+        arbre->points = nouveau;
+        arbre->capacite = nb;
+    }
+
+    for(i=0 ; i<nb ; i++)
+        arbre->points[i] = points[i];
+    arbre->nb = nb;
+
+    arbre_kd_ranger(arbre->points, nb, 0);
+}
+
+int arbre_kd_get_nb(ARBRE_KD * arbre)
+{
+    return arbre->nb;
+}
+
+bool arbre_kd_plus_proche(ARBRE_KD * arbre, double x, double y,
+                          int indice_exclu, double distance_max,
+                          int * pindice)
+{
+    RECHERCHE_KD recherche = {x, y, indice_exclu, distance_max, 0, false};
+
+    arbre_kd_parcours(arbre->points, arbre->nb, 0, &recherche);
+
+    if(recherche.trouve)
+        *pindice = recherche.indice;
+    return recherche.trouve;
+}
+
+int arbre_kd_k_plus_proches(ARBRE_KD * arbre, double x, double y, int k,
+                            double distance_max, int * indices,
+                            double * distances)
+{
+    RECHERCHE_K recherche = {x, y, k, 0, distance_max, indices, distances};
+
+    if(k <= 0)
+        return 0;
+
+    arbre_kd_parcours_k(arbre->points, arbre->nb, 0, &recherche);
+    return recherche.nb;
+}
+
+//---------------------------------------------------------------------
+// coordonnée du point selon l'axe : 0 pour x, 1 pour y
+static double arbre_kd_coordonnee(const POINT_KD * point, int axe)
+{
+    return axe ? point->y : point->x;
+}
+
+//---------------------------------------------------------------------
+// place au rang donné le point qui y serait si l'intervalle était trié
+// selon l'axe, les points avant lui n'étant pas plus grands et ceux après
+// pas plus petits ; contrairement à qsort, n'alloue rien sur le tas
+static void arbre_kd_selectionner(POINT_KD * points, int nb, int rang, int axe)
+{
+    int gauche = 0, droite = nb - 1, i, j;
+    double pivot;
+    POINT_KD echange;
+
+    while(gauche < droite)
+    {
+        pivot = arbre_kd_coordonnee(&points[(gauche + droite)/2], axe);
+        i = gauche;
+        j = droite;
+
+        //à la sortie, [gauche, j] ne dépasse pas le pivot et [i, droite]
+        //n'est pas en dessous ; entre les deux, les points valent le pivot
+        while(i <= j)
+        {
+            while(arbre_kd_coordonnee(&points[i], axe) < pivot)
+                i++;
+            while(arbre_kd_coordonnee(&points[j], axe) > pivot)
+                j--;
+            if(i <= j)
+            {
+                echange = points[i];
+                points[i] = points[j];
+                points[j] = echange;
+                i++;
+                j--;
+            }
+        }
+
+        if(rang <= j)
+            droite = j;
+        else if(rang >= i)
+            gauche = i;
+        else
+            return;
+    }
+}
+
+//---------------------------------------------------------------------
+// place la médiane de l'intervalle selon l'axe de la profondeur et range
+// récursivement les deux moitiés de part et d'autre
+static void arbre_kd_ranger(POINT_KD * points, int nb, int profondeur)
+{
+    int milieu = nb/2;
+
+    if(nb <= 1)
+        return;
+
+    arbre_kd_selectionner(points, nb, milieu, profondeur%2);
+
+    arbre_kd_ranger(points, milieu, profondeur + 1);
+    arbre_kd_ranger(points + milieu + 1, nb - milieu - 1, profondeur + 1);
+}
+
+static void arbre_kd_parcours(const POINT_KD * points, int nb, int profondeur,
+                              RECHERCHE_KD * recherche)
+{
+    int milieu = nb/2;
+    const POINT_KD * noeud = NULL;
+    double distance, ecart;
+
+    if(nb <= 0)
+        return;
+
+    noeud = &points[milieu];
+
+    if(noeud->indice != recherche->indice_exclu)
+    {
+        // même calcul de distance que la recherche linéaire pour que
+        // les égalités soient départagées de la même façon
+        distance = utilitaire_calcul_norme(recherche->x, noeud->x,
+                                           recherche->y, noeud->y);
+
+        if(distance < recherche->distance ||
+           (recherche->trouve && distance == recherche->distance &&
+            noeud->indice > recherche->indice))
+        {
+            recherche->distance = distance;
+            recherche->indice = noeud->indice;
+            recherche->trouve = true;
+        }
+    }
+
+    ecart = profondeur%2 ? recherche->y - noeud->y : recherche->x - noeud->x;
+
+    //le côté du point est visité en premier, l'autre seulement si le plan
+    //de séparation est plus proche que la meilleure distance
+    if(ecart < 0)
+    {
+        arbre_kd_parcours(points, milieu, profondeur + 1, recherche);
+        if(-ecart <= recherche->distance)
+            arbre_kd_parcours(points + milieu + 1, nb - milieu - 1,
+                              profondeur + 1, recherche);
+    }
+    else
+    {
+        arbre_kd_parcours(points + milieu + 1, nb - milieu - 1,
+                          profondeur + 1, recherche);
+        if(ecart <= recherche->distance)
+            arbre_kd_parcours(points, milieu, profondeur + 1, recherche);
+    }
+}
+
+static void arbre_kd_parcours_k(const POINT_KD * points, int nb, int profondeur,
+                                RECHERCHE_K * recherche)
+{
+    int milieu = nb/2, i;
+    const POINT_KD * noeud = NULL;
+    double distance, ecart;
+
+    if(nb <= 0)
+        return;
+
+    noeud = &points[milieu];
+    distance = utilitaire_calcul_norme(recherche->x, noeud->x,
+                                       recherche->y, noeud->y);
+
+    //insertion par ordre croissant dans la liste des k meilleurs
+    if(distance < arbre_kd_borne_k(recherche))
+    {
+        if(recherche->nb < recherche->k)
+            recherche->nb++;
+
+        for(i=recherche->nb - 1 ; i>0 && recherche->distances[i-1] > distance ; i--)
+        {
+            recherche->distances[i] = recherche->distances[i-1];
+            recherche->indices[i] = recherche->indices[i-1];
+        }
+        recherche->distances[i] = distance;
+        recherche->indices[i] = noeud->indice;
+    }
+
+    ecart = profondeur%2 ? recherche->y - noeud->y : recherche->x - noeud->x;
+
+    if(ecart < 0)
+    {
+        arbre_kd_parcours_k(points, milieu, profondeur + 1, recherche);
+        if(-ecart < arbre_kd_borne_k(recherche))
+            arbre_kd_parcours_k(points + milieu + 1, nb - milieu - 1,
+                                profondeur + 1, recherche);
+    }
+    else
+    {
+        arbre_kd_parcours_k(points + milieu + 1, nb - milieu - 1,
+                            profondeur + 1, recherche);
+        if(ecart < arbre_kd_borne_k(recherche))
+            arbre_kd_parcours_k(points, milieu, profondeur + 1, recherche);
+    }
+}
+
+//---------------------------------------------------------------------
+// distance en dessous de laquelle un point entre dans les k meilleurs
+static double arbre_kd_borne_k(const RECHERCHE_K * recherche)
+{
+    if(recherche->nb < recherche->k)
+        return recherche->distance_max;
+    return recherche->distances[recherche->k - 1];
+}
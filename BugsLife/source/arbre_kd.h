@@ -0,0 +1,62 @@
+/*!
+ \file arbre_kd.h
+ \brief Module qui met à disposition un arbre k-d en deux dimensions pour
+  la recherche du point le plus proche
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef ARBRE_KD_H
+#define ARBRE_KD_H
+
+#include <stdbool.h>
+
+/*---------------------------------------------------------------------
+ Structure de données d'un point de l'arbre : type concret
+	x , y : coordonnées du point
+	indice : identifiant du point rendu par la recherche
+ ----------------------------------------------------------------------*/
+typedef struct PointKd POINT_KD;
+struct PointKd
+{
+    double x;
+    double y;
+    int indice;
+};
+
+typedef struct ArbreKd ARBRE_KD;
+
+//---------------------------------------------------------------------
+// crée un arbre vide
+ARBRE_KD * arbre_kd_creer(void);
+
+//---------------------------------------------------------------------
+// libère l'arbre
+void arbre_kd_detruire(ARBRE_KD * arbre);
+
+//---------------------------------------------------------------------
+// vide l'arbre puis le reconstruit équilibré à partir des nb points donnés
+void arbre_kd_construire(ARBRE_KD * arbre, const POINT_KD * points, int nb);
+
+//---------------------------------------------------------------------
+// retourne le nombre de points de l'arbre
+int arbre_kd_get_nb(ARBRE_KD * arbre);
+
+//---------------------------------------------------------------------
+// cherche le point le plus proche de (x, y) dont l'indice est différent
+// de indice_exclu et dont la distance est strictement inférieure à
+// distance_max ; à distance égale, le plus grand indice est retenu
+bool arbre_kd_plus_proche(ARBRE_KD * arbre, double x, double y,
+                          int indice_exclu, double distance_max,
+                          int * pindice);
+
+//---------------------------------------------------------------------
+// cherche les k points les plus proches de (x, y) à une distance
+// strictement inférieure à distance_max ; range leurs indices et leurs
+// distances par distance croissante et renvoie leur nombre
+int arbre_kd_k_plus_proches(ARBRE_KD * arbre, double x, double y, int k,
+                            double distance_max, int * indices,
+                            double * distances);
+
+#endif
@@ -0,0 +1,39 @@
+/*!
+ \file batch.c
+ \brief Module principal de la version sans affichage : exécute le mode
+  Batch sans GLUT, GLUI ni OpenGL
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "modele.h"
+
+int main(int argc, char *argv[])
+{
+    long nb_updates = 0;
+    char * fin = NULL;
+    
+    if(argc >= 3 && argc <= 5)
+        nb_updates = strtol(argv[2], &fin, 10);
+    if(argc < 3 || argc > 5 || *fin || nb_updates < 0)
+    {
+        printf("erreur : usage : '././batch.x nom_fichier nb_updates "
+               "[sauvegarde|- [mesures.csv|mesures.json]]'\n");
+        return EXIT_FAILURE;
+    }
+    
+    //'-' : mesures écrites sans sauvegarde de l'état final
+    if(modele_trace_ouvrir())
+        atexit(modele_trace_fermer);
+    
+    if(!modele_batch(argv[1], nb_updates,
+                     argc >= 4 && strcmp(argv[3], "-") ? argv[3] : NULL,
+                     argc == 5 ? argv[4] : NULL))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
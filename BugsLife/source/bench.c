@@ -0,0 +1,165 @@
+/*!
+ \file bench.c
+ \brief Module principal du banc d'essai : génère des familles de
+  scénarios de 10^2 à 10^6 fourmis, les met à jour un nombre fixe de fois
+  sans affichage et écrit la durée médiane et au 99e centile d'une mise à
+  jour, la mémoire occupée et le coût par fourmi
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "aleatoire.h"
+#include "compteur.h"
+#include "generateur.h"
+#include "modele.h"
+
+#define NB_TAILLES 5
+#define TAILLE_MIN 100 // chaque taille vaut dix fois la précédente
+#define FICHIER_SCENARIO "bench_scenario.txt"
+#define FICHIER_DONNEES "bench.dat"
+
+//nombre fixe de mises à jour pour chaque taille, de 10^2 à 10^6 fourmis ;
+//les naissances dépendent des fourmilières et non du nombre de fourmis :
+//des séries courtes gardent les petits scénarios près de leur taille
+static const int tab_nb_updates[NB_TAILLES] = {200, 200, 200, 50, 10};
+
+//---------------------------------------------------------------------
+// met à jour le scénario nb_updates fois et écrit ses résultats
+static bool bench_mesurer(enum FamilleScenario famille, long nb_fourmis,
+                          int nb_updates, FILE * fdonnees);
+
+//---------------------------------------------------------------------
+// compare deux durées pour qsort
+static int bench_comparer(const void * a, const void * b);
+
+//---------------------------------------------------------------------
+// retourne la mémoire résidente du processus, en octets
+static long bench_memoire(void);
+
+int main(int argc, char *argv[])
+{
+    long nb_fourmis, nb_max = TAILLE_MIN;
+    int i, f, choix = NB_FAMILLES;
+    FILE * fdonnees = NULL;
+
+    for(i=1 ; i<NB_TAILLES ; i++)
+        nb_max *= 10;
+
+    if(argc > 1 && strcmp(argv[1], "toutes"))
+        choix = generateur_famille(argv[1]);
+    if(argc > 2)
+        nb_max = atol(argv[2]);
+    if(argc > 3 || choix < 0)
+    {
+        printf("erreur : usage : '././bench.x [toutes|uniforme|groupee|"
+               "riche|affamee|guerre] [nb_fourmis_max]'\n");
+        return EXIT_FAILURE;
+    }
+
+    if(!(fdonnees = fopen(FICHIER_DONNEES, "w")))
+    {
+        printf("Impossible d'écrire %s\n", FICHIER_DONNEES);
+        return EXIT_FAILURE;
+    }
+    fprintf(fdonnees, "# famille nb_fourmis nb_updates mediane_us p99_us "
+            "ns_par_fourmi memoire_mo\n");
+    printf("%-9s %9s %7s %12s %12s %10s %9s\n", "famille", "fourmis",
+           "updates", "mediane(us)", "p99(us)", "ns/fourmi", "memoire");
+
+    //les tailles croissent d'abord : la mémoire résidente d'une ligne est
+    //celle du plus gros scénario de sa taille
+    for(i=0, nb_fourmis=TAILLE_MIN ; i<NB_TAILLES && nb_fourmis<=nb_max ;
+        i++, nb_fourmis*=10)
+        for(f=0 ; f<NB_FAMILLES ; f++)
+            if((choix == NB_FAMILLES || choix == f) &&
+               !bench_mesurer(f, nb_fourmis, tab_nb_updates[i], fdonnees))
+            {
+                fclose(fdonnees);
+                return EXIT_FAILURE;
+            }
+
+    fclose(fdonnees);
+    return EXIT_SUCCESS;
+}
+
+static bool bench_mesurer(enum FamilleScenario famille, long nb_fourmis,
+                          int nb_updates, FILE * fdonnees)
+{
+    double * tab_duree = NULL;
+    double debut, mediane, p99;
+    int i;
+
+    if(!(tab_duree = (double *) malloc (nb_updates*sizeof(double))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+
+    //la vérification de rendu 2 compare chaque paire de fourmis : elle est
+    //passée, le scénario généré est correct par construction
+    if(!generateur_ecrire(FICHIER_SCENARIO, famille, nb_fourmis) ||
+       !modele_lecture((char *) FICHIER_SCENARIO, FINAL))
+    {
+        printf("Scénario %s de %ld fourmis illisible\n", 
+               generateur_nom(famille), nb_fourmis);
+        remove(FICHIER_SCENARIO);
+        modele_nettoyer();
+        free(tab_duree);
+        return 0;
+    }
+    remove(FICHIER_SCENARIO);
+    aleatoire_semer(GENERATEUR_GRAINE);
+
+    for(i=0 ; i<nb_updates ; i++)
+    {
+        debut = compteur_horloge();
+        modele_update(true, false);
+        tab_duree[i] = compteur_horloge() - debut;
+    }
+
+    qsort(tab_duree, nb_updates, sizeof(double), bench_comparer);
+    mediane = tab_duree[nb_updates/2]*1e6;
+    p99 = tab_duree[(int) ceil(0.99*nb_updates) - 1]*1e6;
+
+    printf("%-9s %9ld %7d %12.1f %12.1f %10.1f %6.1f Mo\n", 
+           generateur_nom(famille),
+           nb_fourmis, nb_updates, mediane, p99, mediane*1e3/nb_fourmis,
+           bench_memoire()/1048576.);
+    fprintf(fdonnees, "%s %ld %d %f %f %f %f\n", generateur_nom(famille), 
+            nb_fourmis,
+            nb_updates, mediane, p99, mediane*1e3/nb_fourmis,
+            bench_memoire()/1048576.);
+    fflush(stdout);
+
+    modele_nettoyer();
+    free(tab_duree);
+    return 1;
+}
+
+static int bench_comparer(const void * a, const void * b)
+{
+    double da = *(const double *) a, db = *(const double *) b;
+
+    return (da > db) - (da < db);
+}
+
+static long bench_memoire(void)
+{
+    FILE * fstatm = NULL;
+    long taille, residente = 0;
+
+    if(!(fstatm = fopen("/proc/self/statm", "r")))
+        return 0;
+    if(fscanf(fstatm, "%ld %ld", &taille, &residente) != 2)
+        residente = 0;
+    fclose(fstatm);
+
+    return residente*sysconf(_SC_PAGESIZE);
+}
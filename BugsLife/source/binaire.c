@@ -0,0 +1,539 @@
+/*!
+ \file binaire.c
+ \brief Module qui écrit et relit des données binaires petit-boutistes,
+  rangées en sections préfixées par leur longueur
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "memoire.h"
+#include "binaire.h"
+
+#define TAILLE_MIN_TAMPON 4096
+#define TAILLE_ENTETE_SECTION 12 // type sur 32 bits, longueur sur 64 bits
+#define EXTENSION_TEMPORAIRE ".tmp"
+#define FNV_BASE UINT64_C(14695981039346656037)
+#define FNV_PREMIER UINT64_C(1099511628211)
+
+/*---------------------------------------------------------------------
+ Structure de données d'un tampon d'écriture
+	octets : contenu du tampon
+	taille : nombre d'octets écrits
+	capacite : taille allouée du tableau octets
+	erreur : vrai si la mémoire a manqué ; le tampon ne peut plus être
+             enregistré
+	projete : vrai si octets est la projection d'un fichier (mmap)
+ ----------------------------------------------------------------------*/
+struct Tampon
+{
+    unsigned char * octets;
+    size_t taille;
+    size_t capacite;
+    bool erreur;
+    bool projete;
+};
+
+static bool binaire_agrandir(TAMPON * tampon, size_t taille);
+static void binaire_liberer(TAMPON * tampon);
+static void binaire_synchroniser_dossier(const char * nom_fichier);
+static const unsigned char * binaire_avancer(LECTURE_BINAIRE * lecture,
+                                             size_t taille);
+
+TAMPON * binaire_creer(void)
+{
+    TAMPON * tampon = NULL;
+
+    if(!(tampon = (TAMPON *) malloc (sizeof(TAMPON))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+
+    tampon->octets = NULL;
+    tampon->taille = 0;
+    tampon->capacite = 0;
+    tampon->erreur = false;
+    tampon->projete = false;
+    return tampon;
+}
+
+void binaire_detruire(TAMPON * tampon)
+{
+    if(!tampon)
+        return;
+
+    binaire_liberer(tampon);
+    free(tampon);
+}
+
+void binaire_ecrire_octets(TAMPON * tampon, const void * octets, size_t taille)
+{
+    if(!binaire_agrandir(tampon, taille))
+        return;
+
+    memcpy(tampon->octets + tampon->taille, octets, taille);
+    tampon->taille += taille;
+}
+
+void binaire_ecrire_booleen(TAMPON * tampon, bool valeur)
+{
+    unsigned char octet = valeur ? 1 : 0;
+
+    binaire_ecrire_octets(tampon, &octet, 1);
+}
+
+void binaire_ecrire_entier32(TAMPON * tampon, uint32_t valeur)
+{
+    unsigned char octets[4];
+    int i;
+
+    for(i=0 ; i<4 ; i++)
+        octets[i] = (unsigned char) (valeur >> 8*i);
+    binaire_ecrire_octets(tampon, octets, 4);
+}
+
+void binaire_ecrire_entier64(TAMPON * tampon, uint64_t valeur)
+{
+    unsigned char octets[8];
+    int i;
+
+    for(i=0 ; i<8 ; i++)
+        octets[i] = (unsigned char) (valeur >> 8*i);
+    binaire_ecrire_octets(tampon, octets, 8);
+}
+
+void binaire_ecrire_float(TAMPON * tampon, float valeur)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &valeur, sizeof(bits));
+    binaire_ecrire_entier32(tampon, bits);
+}
+
+void binaire_ecrire_double(TAMPON * tampon, double valeur)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &valeur, sizeof(bits));
+    binaire_ecrire_entier64(tampon, bits);
+}
+
+void binaire_ecrire_entier_variable(TAMPON * tampon, uint32_t valeur)
+{
+    unsigned char octets[5];
+    size_t taille = 0;
+
+    //le bit de poids fort de chaque octet annonce un octet de plus
+    while(valeur >= 0x80)
+    {
+        octets[taille++] = (unsigned char) (valeur | 0x80);
+        valeur >>= 7;
+    }
+    octets[taille++] = (unsigned char) valeur;
+    binaire_ecrire_octets(tampon, octets, taille);
+}
+
+void binaire_vider(TAMPON * tampon)
+{
+    if(tampon->projete)
+        binaire_liberer(tampon);
+
+    tampon->taille = 0;
+    tampon->erreur = false;
+}
+
+bool binaire_get_erreur(const TAMPON * tampon)
+{
+    return tampon->erreur;
+}
+
+size_t binaire_debut_section(TAMPON * tampon, uint32_t type)
+{
+    size_t debut = tampon->taille;
+
+    binaire_ecrire_entier32(tampon, type);
+    binaire_ecrire_entier64(tampon, 0);
+    return debut;
+}
+
+void binaire_fin_section(TAMPON * tampon, size_t debut)
+{
+    uint64_t longueur = tampon->taille - debut - TAILLE_ENTETE_SECTION;
+    int i;
+
+    if(tampon->erreur)
+        return;
+
+    for(i=0 ; i<8 ; i++)
+        tampon->octets[debut + 4 + i] = (unsigned char) (longueur >> 8*i);
+}
+
+bool binaire_enregistrer(const TAMPON * tampon, const char * nom_fichier)
+{
+    FILE * fsortie = NULL;
+    bool reussi;
+
+    if(tampon->erreur || !(fsortie = fopen(nom_fichier, "wb")))
+        return 0;
+
+    reussi = fwrite(tampon->octets, 1, tampon->taille, fsortie) == tampon->taille;
+    if(fclose(fsortie))
+        reussi = false;
+
+    return reussi;
+}
+
+bool binaire_enregistrer_durable(const TAMPON * tampon, const char * nom_fichier)
+{
+    FILE * fsortie = NULL;
+    char * nom_temporaire = NULL;
+    bool reussi;
+
+    if(tampon->erreur)
+        return 0;
+
+    if(!(nom_temporaire = (char *) malloc (strlen(nom_fichier) + 
+                                           strlen(EXTENSION_TEMPORAIRE) + 1)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+    strcpy(nom_temporaire, nom_fichier);
+    strcat(nom_temporaire, EXTENSION_TEMPORAIRE);
+
+    if(!(fsortie = fopen(nom_temporaire, "wb")))
+    {
+        free(nom_temporaire);
+        return 0;
+    }
+
+    reussi = fwrite(tampon->octets, 1, tampon->taille, fsortie) == tampon->taille &&
+             !fflush(fsortie) && !fsync(fileno(fsortie));
+    if(fclose(fsortie))
+        reussi = false;
+
+    //le renommage remplace l'ancienne version d'un seul coup
+    if(reussi && !rename(nom_temporaire, nom_fichier))
+        binaire_synchroniser_dossier(nom_fichier);
+    else
+    {
+        remove(nom_temporaire);
+        reussi = false;
+    }
+
+    free(nom_temporaire);
+    return reussi;
+}
+
+bool binaire_charger(TAMPON * tampon, const char * nom_fichier)
+{
+    unsigned char bloc[TAILLE_MIN_TAMPON];
+    struct stat etat;
+    ssize_t nb_lus;
+    int descripteur;
+
+    if((descripteur = open(nom_fichier, O_RDONLY)) < 0)
+        return 0;
+
+    binaire_liberer(tampon);
+
+    //un fichier ordinaire non vide est projeté, les autres sont lus
+    if(!fstat(descripteur, &etat) && S_ISREG(etat.st_mode) && etat.st_size > 0)
+    {
+        void * projection = mmap(NULL, etat.st_size, PROT_READ, MAP_PRIVATE,
+                                 descripteur, 0);
+
+        if(projection != MAP_FAILED)
+        {
+            tampon->octets = (unsigned char *) projection;
+            tampon->taille = tampon->capacite = etat.st_size;
+            tampon->projete = true;
+            close(descripteur);
+            return 1;
+        }
+    }
+
+    while((nb_lus = read(descripteur, bloc, sizeof(bloc))) > 0)
+        binaire_ecrire_octets(tampon, bloc, nb_lus);
+
+    if(nb_lus < 0)
+        tampon->erreur = true;
+    close(descripteur);
+
+    return !tampon->erreur;
+}
+
+bool binaire_commence_par(const char * nom_fichier, const void * signature,
+                          size_t taille)
+{
+    FILE * fentree = NULL;
+    unsigned char debut[TAILLE_ENTETE_SECTION];
+    bool reconnu;
+
+    if(taille > sizeof(debut) || !(fentree = fopen(nom_fichier, "rb")))
+        return 0;
+
+    reconnu = fread(debut, 1, taille, fentree) == taille &&
+              !memcmp(debut, signature, taille);
+    fclose(fentree);
+
+    return reconnu;
+}
+
+LECTURE_BINAIRE binaire_lecture(const TAMPON * tampon)
+{
+    LECTURE_BINAIRE lecture = {tampon->octets, tampon->octets + tampon->taille,
+                               false};
+
+    return lecture;
+}
+
+bool binaire_lire_octets(LECTURE_BINAIRE * lecture, void * octets, size_t taille)
+{
+    const unsigned char * pos = binaire_avancer(lecture, taille);
+
+    if(!pos)
+    {
+        memset(octets, 0, taille);
+        return 0;
+    }
+
+    memcpy(octets, pos, taille);
+    return 1;
+}
+
+bool binaire_lire_booleen(LECTURE_BINAIRE * lecture)
+{
+    const unsigned char * pos = binaire_avancer(lecture, 1);
+
+    return pos && *pos;
+}
+
+uint32_t binaire_lire_entier32(LECTURE_BINAIRE * lecture)
+{
+    const unsigned char * pos = binaire_avancer(lecture, 4);
+    uint32_t valeur = 0;
+    int i;
+
+    if(pos)
+        for(i=0 ; i<4 ; i++)
+            valeur |= (uint32_t) pos[i] << 8*i;
+
+    return valeur;
+}
+
+uint64_t binaire_lire_entier64(LECTURE_BINAIRE * lecture)
+{
+    const unsigned char * pos = binaire_avancer(lecture, 8);
+    uint64_t valeur = 0;
+    int i;
+
+    if(pos)
+        for(i=0 ; i<8 ; i++)
+            valeur |= (uint64_t) pos[i] << 8*i;
+
+    return valeur;
+}
+
+float binaire_lire_float(LECTURE_BINAIRE * lecture)
+{
+    uint32_t bits = binaire_lire_entier32(lecture);
+    float valeur;
+
+    memcpy(&valeur, &bits, sizeof(valeur));
+    return valeur;
+}
+
+double binaire_lire_double(LECTURE_BINAIRE * lecture)
+{
+    uint64_t bits = binaire_lire_entier64(lecture);
+    double valeur;
+
+    memcpy(&valeur, &bits, sizeof(valeur));
+    return valeur;
+}
+
+uint32_t binaire_lire_entier_variable(LECTURE_BINAIRE * lecture)
+{
+    const unsigned char * pos = NULL;
+    uint32_t valeur = 0;
+    int decalage;
+
+    for(decalage=0 ; decalage<32 ; decalage+=7)
+    {
+        if(!(pos = binaire_avancer(lecture, 1)))
+            return 0;
+        valeur |= (uint32_t) (*pos & 0x7F) << decalage;
+        if(!(*pos & 0x80))
+            return valeur;
+    }
+
+    //plus de 5 octets : ce n'est pas un entier de 32 bits
+    lecture->erreur = true;
+    return 0;
+}
+
+uint64_t binaire_empreinte(const LECTURE_BINAIRE * lecture)
+{
+    return binaire_fnv(FNV_BASE, lecture->pos,
+                       (size_t) (lecture->fin - lecture->pos));
+}
+
+uint64_t binaire_fnv_debut(void)
+{
+    return FNV_BASE;
+}
+
+uint64_t binaire_fnv(uint64_t courante, const void * octets, size_t taille)
+{
+    const unsigned char * pos = octets;
+    size_t i;
+    
+    for(i=0 ; i<taille ; i++)
+        courante = (courante ^ pos[i])*FNV_PREMIER;
+    
+    return courante;
+}
+
+bool binaire_section(LECTURE_BINAIRE * lecture, uint32_t type,
+                     LECTURE_BINAIRE * section)
+{
+    while(!lecture->erreur && lecture->pos < lecture->fin)
+    {
+        uint32_t type_lu = binaire_lire_entier32(lecture);
+        uint64_t longueur = binaire_lire_entier64(lecture);
+        const unsigned char * debut = NULL;
+
+        if(lecture->erreur || longueur > (uint64_t) (lecture->fin - lecture->pos))
+        {
+            lecture->erreur = true;
+            return 0;
+        }
+
+        debut = binaire_avancer(lecture, longueur);
+        if(type_lu == type)
+        {
+            section->pos = debut;
+            section->fin = debut + longueur;
+            section->erreur = false;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+bool binaire_enregistrement(const LECTURE_BINAIRE * tableau, uint32_t i,
+                            size_t taille, LECTURE_BINAIRE * enregistrement)
+{
+    size_t disponible = tableau->fin - tableau->pos;
+
+    if(tableau->erreur || !taille || i >= disponible/taille)
+        return 0;
+
+    enregistrement->pos = tableau->pos + i*taille;
+    enregistrement->fin = enregistrement->pos + taille;
+    enregistrement->erreur = false;
+    return 1;
+}
+
+//---------------------------------------------------------------------
+// fait de la place pour taille octets de plus dans le tampon
+static bool binaire_agrandir(TAMPON * tampon, size_t taille)
+{
+    size_t capacite = tampon->capacite ? tampon->capacite : TAILLE_MIN_TAMPON;
+    unsigned char * octets = NULL;
+
+    if(tampon->erreur || tampon->projete)
+        return 0;
+    if(tampon->taille + taille <= tampon->capacite)
+        return 1;
+
+    while(capacite < tampon->taille + taille)
+        capacite *= 2;
+
+    if(!(octets = (unsigned char *) memoire_reallouer (tampon->octets, capacite)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        tampon->erreur = true;
+        return 0;
+    }
+
+    tampon->octets = octets;
+    tampon->capacite = capacite;
+    return 1;
+}
+
+//---------------------------------------------------------------------
+// libère le contenu du tampon, alloué ou projeté, et le laisse vide
+static void binaire_liberer(TAMPON * tampon)
+{
+    if(tampon->projete)
+        munmap(tampon->octets, tampon->capacite);
+    else
+        free(tampon->octets);
+
+    tampon->octets = NULL;
+    tampon->taille = 0;
+    tampon->capacite = 0;
+    tampon->erreur = false;
+    tampon->projete = false;
+}
+
+//---------------------------------------------------------------------
+// force sur le disque le dossier du fichier, pour que son renommage
+// survive à un arrêt du système
+static void binaire_synchroniser_dossier(const char * nom_fichier)
+{
+    const char * separateur = strrchr(nom_fichier, '/');
+    char * dossier = NULL;
+    int descripteur;
+
+    if(!separateur)
+        descripteur = open(".", O_RDONLY);
+    else
+    {
+        size_t longueur = separateur == nom_fichier ? 1 : separateur - nom_fichier;
+
+        if(!(dossier = (char *) malloc (longueur + 1)))
+            return;
+        memcpy(dossier, nom_fichier, longueur);
+        dossier[longueur] = '\0';
+        descripteur = open(dossier, O_RDONLY);
+        free(dossier);
+    }
+
+    if(descripteur >= 0)
+    {
+        fsync(descripteur);
+        close(descripteur);
+    }
+}
+
+//---------------------------------------------------------------------
+// renvoie la position des taille prochains octets et avance la lecture,
+// ou NULL s'ils dépassent la fin
+static const unsigned char * binaire_avancer(LECTURE_BINAIRE * lecture,
+                                             size_t taille)
+{
+    const unsigned char * pos = lecture->pos;
+
+    if(lecture->erreur || taille > (size_t) (lecture->fin - lecture->pos))
+    {
+        lecture->erreur = true;
+        return NULL;
+    }
+
+    lecture->pos += taille;
+    return pos;
+}
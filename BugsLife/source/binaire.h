@@ -0,0 +1,171 @@
+/*!
+ \file binaire.h
+ \brief Module qui écrit et relit des données binaires petit-boutistes,
+  rangées en sections préfixées par leur longueur
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef BINAIRE_H
+#define BINAIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*---------------------------------------------------------------------
+ Structure de données d'une lecture dans des données binaires :
+ type concret
+	pos : prochain octet à lire
+	fin : octet qui suit le dernier octet lisible
+	erreur : vrai dès qu'une lecture a dépassé fin ; les lectures
+             suivantes rendent alors 0
+ ----------------------------------------------------------------------*/
+typedef struct LectureBinaire LECTURE_BINAIRE;
+struct LectureBinaire
+{
+    const unsigned char * pos;
+    const unsigned char * fin;
+    bool erreur;
+};
+
+typedef struct Tampon TAMPON;
+
+//---------------------------------------------------------------------
+// crée un tampon vide
+TAMPON * binaire_creer(void);
+
+//---------------------------------------------------------------------
+// libère le tampon
+void binaire_detruire(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// ajoute taille octets à la fin du tampon, tels quels
+void binaire_ecrire_octets(TAMPON * tampon, const void * octets, size_t taille);
+
+//---------------------------------------------------------------------
+// ajoute un booléen sur un octet à la fin du tampon
+void binaire_ecrire_booleen(TAMPON * tampon, bool valeur);
+
+//---------------------------------------------------------------------
+// ajoute un entier de 32 bits à la fin du tampon, en petit-boutiste
+void binaire_ecrire_entier32(TAMPON * tampon, uint32_t valeur);
+
+//---------------------------------------------------------------------
+// ajoute un entier de 64 bits à la fin du tampon, en petit-boutiste
+void binaire_ecrire_entier64(TAMPON * tampon, uint64_t valeur);
+
+//---------------------------------------------------------------------
+// ajoute les 32 bits d'un float à la fin du tampon, sans arrondi
+void binaire_ecrire_float(TAMPON * tampon, float valeur);
+
+//---------------------------------------------------------------------
+// ajoute les 64 bits d'un double à la fin du tampon, sans arrondi
+void binaire_ecrire_double(TAMPON * tampon, double valeur);
+
+//---------------------------------------------------------------------
+// ajoute un entier de 32 bits à la fin du tampon sur 1 à 5 octets, 7 bits
+// par octet en commençant par les plus faibles : les petites valeurs
+// prennent moins de place
+void binaire_ecrire_entier_variable(TAMPON * tampon, uint32_t valeur);
+
+//---------------------------------------------------------------------
+// vide le tampon en gardant sa capacité, pour le réutiliser sans
+// allocation
+void binaire_vider(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// vrai si la mémoire a manqué pendant l'écriture du tampon
+bool binaire_get_erreur(const TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// commence une section : écrit son type et réserve la place de sa
+// longueur ; renvoie la position à donner à binaire_fin_section
+size_t binaire_debut_section(TAMPON * tampon, uint32_t type);
+
+//---------------------------------------------------------------------
+// termine la section commencée à debut en écrivant sa longueur
+void binaire_fin_section(TAMPON * tampon, size_t debut);
+
+//---------------------------------------------------------------------
+// écrit le contenu du tampon dans le fichier ; renvoie 0 en cas d'échec
+bool binaire_enregistrer(const TAMPON * tampon, const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// écrit le tampon dans un fichier temporaire, le force sur le disque puis
+// le renomme en nom_fichier : le fichier contient toujours soit
+// l'ancienne soit la nouvelle version ; renvoie 0 en cas d'échec
+bool binaire_enregistrer_durable(const TAMPON * tampon, const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// remplace le contenu du tampon par celui du fichier, projeté en mémoire
+// quand c'est possible ; le tampon ne peut alors plus qu'être lu. Renvoie
+// 0 si le fichier ne peut pas être lu
+bool binaire_charger(TAMPON * tampon, const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// teste si le fichier commence par les taille octets de signature
+bool binaire_commence_par(const char * nom_fichier, const void * signature,
+                          size_t taille);
+
+//---------------------------------------------------------------------
+// prépare la lecture de tout le contenu du tampon
+LECTURE_BINAIRE binaire_lecture(const TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// copie taille octets dans octets et avance la lecture
+bool binaire_lire_octets(LECTURE_BINAIRE * lecture, void * octets, size_t taille);
+
+//---------------------------------------------------------------------
+// lit un booléen écrit par binaire_ecrire_booleen
+bool binaire_lire_booleen(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// lit un entier de 32 bits écrit par binaire_ecrire_entier32
+uint32_t binaire_lire_entier32(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// lit un entier de 64 bits écrit par binaire_ecrire_entier64
+uint64_t binaire_lire_entier64(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// lit un float écrit par binaire_ecrire_float
+float binaire_lire_float(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// lit un double écrit par binaire_ecrire_double
+double binaire_lire_double(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// lit un entier écrit par binaire_ecrire_entier_variable
+uint32_t binaire_lire_entier_variable(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// calcule l'empreinte FNV-1a sur 64 bits des octets qui restent à lire,
+// sans avancer la lecture
+uint64_t binaire_empreinte(const LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// valeur de départ d'une empreinte FNV-1a sur 64 bits
+uint64_t binaire_fnv_debut(void);
+
+//---------------------------------------------------------------------
+// poursuit l'empreinte FNV-1a courante sur taille octets
+uint64_t binaire_fnv(uint64_t courante, const void * octets, size_t taille);
+
+//---------------------------------------------------------------------
+// passe les sections d'un autre type jusqu'à la section type, place son
+// contenu dans section et avance la lecture après elle ; renvoie 0 si
+// elle est absente ou tronquée
+bool binaire_section(LECTURE_BINAIRE * lecture, uint32_t type,
+                     LECTURE_BINAIRE * section);
+
+//---------------------------------------------------------------------
+// place dans enregistrement le i-ème des enregistrements de taille
+// octets rangés à partir de la position de tableau ; renvoie 0 s'il
+// dépasse la fin
+bool binaire_enregistrement(const LECTURE_BINAIRE * tableau, uint32_t i,
+                            size_t taille, LECTURE_BINAIRE * enregistrement);
+
+#endif
@@ -0,0 +1,348 @@
+/*!
+ \file compteur.c
+ \brief Module qui compte les appels des fonctions de recherche coûteuses
+  et chronomètre les étapes d'une mise à jour ; les compteurs et les
+  étapes de fourmiliere_update n'existent que si le programme est compilé
+  avec -DCOMPTEURS, sinon COMPTER et CHRONOMETRER ne font rien. Les
+  mesures de chaque mise à jour, avec les compteurs matériels relevés sur
+  demande, peuvent être écrites en CSV ou en JSON
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "memoire.h"
+#include "traceur.h"
+#include "compteur.h"
+
+static unsigned long tab_compteur[NB_COMPTEURS];
+static double tab_duree_phase[NB_PHASES];
+static bool chronometre = false;
+//durées des étapes de la mise à jour en cours, pour la surveillance
+static bool surveillance = false;
+static double tab_duree_update[PREMIERE_SOUS_PHASE];
+
+//compteurs matériels de chaque étape de modele_update et dernier relevé
+static bool releve_materiel = false;
+static uint64_t tab_releve[NB_MATERIEL];
+static uint64_t tab_materiel_phase[PREMIERE_SOUS_PHASE][NB_MATERIEL];
+
+static const char * tab_nom_compteur[NB_COMPTEURS] = {
+    "utilitaire_calcul_norme", "utilitaire_distance_point_droite",
+    "nourriture_la_plus_proche", "fourmi_nourriture_deja_prise",
+    "fourmi_etrangere_plus_proche", "fourmiliere_sur_chemin",
+    "fourmi_ouvriere_collision", "nourriture_superposition",
+    "candidats_rejetes", "collisions_testees"};
+
+static const char * tab_nom_phase[NB_PHASES] = {"enregistrement",
+    "fourmilieres", "nourriture", "trajectoires", "persistance",
+    "sauvegarde", "preparation", "naissance", "nourrissage", "rayon",
+    "ouvrieres", "gardes", "mort_fourmiliere"};
+
+//fichier des mesures et valeurs à la fin de la mise à jour précédente :
+//chaque ligne ne contient que les écarts
+static FILE * fmesures = NULL;
+static bool json = false;
+static unsigned long nb_lignes = 0;
+static unsigned long tab_compteur_avant[NB_COMPTEURS];
+static double tab_duree_avant[NB_PHASES];
+static unsigned long nb_allocations_depart = 0, nb_allocations_avant = 0;
+static uint64_t tab_materiel_avant[PREMIERE_SOUS_PHASE][NB_MATERIEL];
+
+//---------------------------------------------------------------------
+// ajoute à l'étape les évènements matériels depuis le relevé précédent
+static void compteur_relever(enum Phase phase);
+
+//---------------------------------------------------------------------
+// écrit à la suite de la ligne en cours les durées en microsecondes, les
+// compteurs et les allocations ; les étapes et compteurs absents sans
+// -DCOMPTEURS ne sont pas écrits
+static void compteur_ecrire_mesures(const double * tab_duree,
+                                    const unsigned long * tab_nb,
+                                    uint64_t tab_materiel[][NB_MATERIEL],
+                                    unsigned long nb_allocations);
+
+void compteur_incrementer(enum Compteur compteur)
+{
+    tab_compteur[compteur]++;
+}
+
+unsigned long compteur_lire(enum Compteur compteur)
+{
+    return tab_compteur[compteur];
+}
+
+void compteur_vider(void)
+{
+    int c, p;
+
+    for(c=0 ; c<NB_COMPTEURS ; c++)
+        tab_compteur[c] = 0;
+    for(p=0 ; p<NB_PHASES ; p++)
+        tab_duree_phase[p] = 0;
+    memset(tab_materiel_phase, 0, sizeof(tab_materiel_phase));
+}
+
+const char * compteur_nom(enum Compteur compteur)
+{
+    return tab_nom_compteur[compteur];
+}
+
+bool compteur_actif(void)
+{
+#ifdef COMPTEURS
+    return true;
+#else
+    return false;
+#endif
+}
+
+double compteur_horloge(void)
+{
+    struct timespec temps;
+
+    clock_gettime(CLOCK_MONOTONIC, &temps);
+    return temps.tv_sec + temps.tv_nsec*1e-9;
+}
+
+void compteur_chronometre(bool actif)
+{
+    chronometre = actif;
+}
+
+void compteur_materiel(bool actif)
+{
+    releve_materiel = actif && materiel_actif();
+    if(releve_materiel)
+        materiel_lire(tab_releve);
+}
+
+void compteur_surveiller(bool actif)
+{
+    surveillance = actif;
+}
+
+double compteur_depart(void)
+{
+    return chronometre || surveillance || traceur_actif() ? 
+           compteur_horloge() : 0;
+}
+
+double compteur_debut_update(void)
+{
+    int p;
+
+    for(p=0 ; p<PREMIERE_SOUS_PHASE ; p++)
+        tab_duree_update[p] = 0;
+    if(chronometre && releve_materiel)
+        materiel_lire(tab_releve);
+    return compteur_depart();
+}
+
+void compteur_chronometrer(enum Phase phase, double * debut)
+{
+    double fin;
+
+    if(!chronometre && !surveillance && !traceur_actif())
+        return;
+
+    if(chronometre && releve_materiel && phase < PREMIERE_SOUS_PHASE)
+        compteur_relever(phase);
+    fin = compteur_horloge();
+    if(chronometre)
+        tab_duree_phase[phase] += fin - *debut;
+    //les étapes de fourmiliere_update, répétées pour chaque fourmilière,
+    //rempliraient la chronologie
+    if(phase < PREMIERE_SOUS_PHASE)
+    {
+        tab_duree_update[phase] += fin - *debut;
+        traceur_intervalle_fin(tab_nom_phase[phase], *debut, fin);
+    }
+    *debut = fin;
+}
+
+double compteur_duree(enum Phase phase)
+{
+    return tab_duree_phase[phase];
+}
+
+double compteur_duree_update(enum Phase phase)
+{
+    return phase < PREMIERE_SOUS_PHASE ? tab_duree_update[phase] : 0;
+}
+
+const char * compteur_nom_phase(enum Phase phase)
+{
+    return tab_nom_phase[phase];
+}
+
+uint64_t compteur_materiel_lire(enum Phase phase,
+                                enum EvenementMateriel evenement)
+{
+    return phase < PREMIERE_SOUS_PHASE ? tab_materiel_phase[phase][evenement]
+                                       : 0;
+}
+
+bool compteur_export_ouvrir(const char * nom_fichier)
+{
+    size_t longueur = strlen(nom_fichier);
+    int c, p, e;
+
+    if(!(fmesures = fopen(nom_fichier, "w")))
+    {
+        printf("Impossible d'écrire %s\n", nom_fichier);
+        return 0;
+    }
+
+    json = longueur >= 5 && !strcmp(nom_fichier + longueur - 5, ".json");
+    nb_lignes = 0;
+    compteur_vider();
+    for(c=0 ; c<NB_COMPTEURS ; c++)
+        tab_compteur_avant[c] = 0;
+    for(p=0 ; p<NB_PHASES ; p++)
+        tab_duree_avant[p] = 0;
+    memset(tab_materiel_avant, 0, sizeof(tab_materiel_avant));
+    nb_allocations_depart = nb_allocations_avant = memoire_get_nb_allocations();
+
+    if(json)
+    {
+        fprintf(fmesures, "{\"updates\": [");
+        return 1;
+    }
+
+    fprintf(fmesures, "update");
+    for(p=0 ; p<(compteur_actif() ? NB_PHASES : PREMIERE_SOUS_PHASE) ; p++)
+        fprintf(fmesures, ",%s_us", tab_nom_phase[p]);
+    for(c=0 ; c<NB_COMPTEURS && compteur_actif() ; c++)
+        fprintf(fmesures, ",%s", tab_nom_compteur[c]);
+    for(p=0 ; p<PREMIERE_SOUS_PHASE && releve_materiel ; p++)
+        for(e=0 ; e<NB_MATERIEL ; e++)
+            if(materiel_disponible(e))
+                fprintf(fmesures, ",%s_%s", tab_nom_phase[p], materiel_nom(e));
+    fprintf(fmesures, ",allocations\n");
+    return 1;
+}
+
+void compteur_export_update(void)
+{
+    double tab_duree[NB_PHASES];
+    unsigned long tab_nb[NB_COMPTEURS];
+    uint64_t tab_materiel[PREMIERE_SOUS_PHASE][NB_MATERIEL];
+    unsigned long nb_allocations = memoire_get_nb_allocations();
+    int c, p, e;
+
+    if(!fmesures)
+        return;
+
+    for(p=0 ; p<NB_PHASES ; p++)
+    {
+        tab_duree[p] = tab_duree_phase[p] - tab_duree_avant[p];
+        tab_duree_avant[p] = tab_duree_phase[p];
+    }
+    for(c=0 ; c<NB_COMPTEURS ; c++)
+    {
+        tab_nb[c] = tab_compteur[c] - tab_compteur_avant[c];
+        tab_compteur_avant[c] = tab_compteur[c];
+    }
+    for(p=0 ; p<PREMIERE_SOUS_PHASE ; p++)
+        for(e=0 ; e<NB_MATERIEL ; e++)
+        {
+            tab_materiel[p][e] = tab_materiel_phase[p][e] - 
+                                 tab_materiel_avant[p][e];
+            tab_materiel_avant[p][e] = tab_materiel_phase[p][e];
+        }
+
+    nb_lignes++;
+    if(json)
+        fprintf(fmesures, "%s\n  {\"update\": %lu", nb_lignes > 1 ? "," : "",
+                nb_lignes);
+    else
+        fprintf(fmesures, "%lu", nb_lignes);
+    compteur_ecrire_mesures(tab_duree, tab_nb, tab_materiel,
+                            nb_allocations - nb_allocations_avant);
+    fprintf(fmesures, json ? "}" : "\n");
+    nb_allocations_avant = nb_allocations;
+}
+
+bool compteur_export_fermer(void)
+{
+    bool reussi;
+
+    if(!fmesures)
+        return 1;
+
+    if(json)
+        fprintf(fmesures, "\n], \"total\": {\"updates\": %lu", nb_lignes);
+    else
+        fprintf(fmesures, "total");
+    compteur_ecrire_mesures(tab_duree_phase, tab_compteur, tab_materiel_phase,
+                            memoire_get_nb_allocations() -
+                            nb_allocations_depart);
+    fprintf(fmesures, json ? "}}\n" : "\n");
+
+    reussi = !ferror(fmesures);
+    if(fclose(fmesures))
+        reussi = false;
+    fmesures = NULL;
+    return reussi;
+}
+
+static void compteur_relever(enum Phase phase)
+{
+    uint64_t tab_valeur[NB_MATERIEL];
+    int e;
+
+    materiel_lire(tab_valeur);
+    for(e=0 ; e<NB_MATERIEL ; e++)
+    {
+        tab_materiel_phase[phase][e] += tab_valeur[e] - tab_releve[e];
+        tab_releve[e] = tab_valeur[e];
+    }
+}
+
+static void compteur_ecrire_mesures(const double * tab_duree,
+                                    const unsigned long * tab_nb,
+                                    uint64_t tab_materiel[][NB_MATERIEL],
+                                    unsigned long nb_allocations)
+{
+    int c, p, e;
+
+    for(p=0 ; p<(compteur_actif() ? NB_PHASES : PREMIERE_SOUS_PHASE) ; p++)
+    {
+        if(json)
+            fprintf(fmesures, ", \"%s_us\": %.3f", tab_nom_phase[p],
+                    tab_duree[p]*1e6);
+        else
+            fprintf(fmesures, ",%.3f", tab_duree[p]*1e6);
+    }
+    for(c=0 ; c<NB_COMPTEURS && compteur_actif() ; c++)
+    {
+        if(json)
+            fprintf(fmesures, ", \"%s\": %lu", tab_nom_compteur[c], tab_nb[c]);
+        else
+            fprintf(fmesures, ",%lu", tab_nb[c]);
+    }
+    for(p=0 ; p<PREMIERE_SOUS_PHASE && releve_materiel ; p++)
+        for(e=0 ; e<NB_MATERIEL ; e++)
+        {
+            if(!materiel_disponible(e))
+                continue;
+            if(json)
+                fprintf(fmesures, ", \"%s_%s\": %llu", tab_nom_phase[p],
+                        materiel_nom(e), 
+                        (unsigned long long) tab_materiel[p][e]);
+            else
+                fprintf(fmesures, ",%llu",
+                        (unsigned long long) tab_materiel[p][e]);
+        }
+
+    if(json)
+        fprintf(fmesures, ", \"allocations\": %lu", nb_allocations);
+    else
+        fprintf(fmesures, ",%lu", nb_allocations);
+}
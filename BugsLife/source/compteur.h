@@ -0,0 +1,135 @@
+/*!
+ \file compteur.h
+ \brief Module qui compte les appels des fonctions de recherche coûteuses
+  et chronomètre les étapes d'une mise à jour ; les compteurs et les
+  étapes de fourmiliere_update n'existent que si le programme est compilé
+  avec -DCOMPTEURS, sinon COMPTER et CHRONOMETRER ne font rien. Les
+  mesures de chaque mise à jour, avec les compteurs matériels relevés sur
+  demande, peuvent être écrites en CSV ou en JSON
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef COMPTEUR_H
+#define COMPTEUR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "materiel.h"
+
+enum Compteur {COMPTEUR_CALCUL_NORME, COMPTEUR_DISTANCE_POINT_DROITE,
+    COMPTEUR_NOURRITURE_LA_PLUS_PROCHE, COMPTEUR_NOURRITURE_DEJA_PRISE,
+    COMPTEUR_ETRANGERE_PLUS_PROCHE, COMPTEUR_SUR_CHEMIN,
+    COMPTEUR_OUVRIERE_COLLISION, COMPTEUR_NOURRITURE_SUPERPOSITION,
+    COMPTEUR_CANDIDAT_REJETE, COMPTEUR_COLLISION_TESTEE, NB_COMPTEURS};
+
+// étapes de modele_update, toujours chronométrées pendant le mode Batch,
+// puis étapes de fourmiliere_update, seulement avec -DCOMPTEURS
+enum Phase {PHASE_ENREGISTREMENT, PHASE_FOURMILIERE, PHASE_NOURRITURE,
+    PHASE_TRAJECTOIRE, PHASE_PERSISTANCE, PHASE_SAUVEGARDE,
+    PHASE_PREPARATION, PHASE_NAISSANCE, PHASE_NOURRISSAGE, PHASE_RAYON,
+    PHASE_OUVRIERES, PHASE_GARDES, PHASE_MORT_FOURMILIERE, NB_PHASES};
+
+#define PREMIERE_SOUS_PHASE PHASE_PREPARATION
+
+#ifdef COMPTEURS
+#define COMPTER(compteur) compteur_incrementer(compteur)
+#define CHRONO_DEPART(debut) double debut = compteur_depart()
+#define CHRONOMETRER(phase, debut) compteur_chronometrer(phase, &debut)
+#else
+#define COMPTER(compteur)
+#define CHRONO_DEPART(debut)
+#define CHRONOMETRER(phase, debut)
+#endif
+
+//---------------------------------------------------------------------
+// ajoute un appel au compteur
+void compteur_incrementer(enum Compteur compteur);
+
+//---------------------------------------------------------------------
+// retourne le nombre d'appels comptés depuis compteur_vider
+unsigned long compteur_lire(enum Compteur compteur);
+
+//---------------------------------------------------------------------
+// remet tous les compteurs et toutes les durées à zéro
+void compteur_vider(void);
+
+//---------------------------------------------------------------------
+// retourne le nom de la fonction ou de l'évènement compté
+const char * compteur_nom(enum Compteur compteur);
+
+//---------------------------------------------------------------------
+// retourne vrai si ce module a été compilé avec -DCOMPTEURS
+bool compteur_actif(void);
+
+//---------------------------------------------------------------------
+// retourne le temps d'une horloge monotone, en secondes
+double compteur_horloge(void);
+
+//---------------------------------------------------------------------
+// démarre ou arrête le chronométrage des étapes
+void compteur_chronometre(bool actif);
+
+//---------------------------------------------------------------------
+// relève aussi, pendant le chronométrage, les compteurs matériels ouverts
+// à la fin de chaque étape de modele_update
+void compteur_materiel(bool actif);
+
+//---------------------------------------------------------------------
+// chronomètre les étapes de chaque mise à jour même hors du mode Batch,
+// pour signaler les mises à jour trop longues
+void compteur_surveiller(bool actif);
+
+//---------------------------------------------------------------------
+// retourne l'heure de début d'une étape, 0 si rien n'est chronométré,
+// surveillé ni tracé
+double compteur_depart(void);
+
+//---------------------------------------------------------------------
+// comme compteur_depart, au début de modele_update : remet à zéro les
+// durées de la mise à jour ; les évènements matériels entre deux mises à
+// jour ne sont comptés dans aucune étape
+double compteur_debut_update(void);
+
+//---------------------------------------------------------------------
+// ajoute le temps écoulé depuis *debut à la durée de l'étape phase et
+// repart de maintenant, seulement pendant le chronométrage ; les étapes
+// de modele_update sont aussi ajoutées à la chronologie en cours
+void compteur_chronometrer(enum Phase phase, double * debut);
+
+//---------------------------------------------------------------------
+// retourne la durée cumulée de l'étape depuis compteur_vider, en secondes
+double compteur_duree(enum Phase phase);
+
+//---------------------------------------------------------------------
+// retourne la durée de l'étape de modele_update pendant la dernière mise
+// à jour, en secondes
+double compteur_duree_update(enum Phase phase);
+
+//---------------------------------------------------------------------
+// retourne le nom de l'étape
+const char * compteur_nom_phase(enum Phase phase);
+
+//---------------------------------------------------------------------
+// retourne le compte cumulé de l'évènement matériel pendant l'étape de
+// modele_update depuis compteur_vider
+uint64_t compteur_materiel_lire(enum Phase phase,
+                                enum EvenementMateriel evenement);
+
+//---------------------------------------------------------------------
+// ouvre le fichier des mesures de chaque mise à jour : JSON si son nom
+// finit par .json, CSV sinon
+bool compteur_export_ouvrir(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// écrit les durées, les compteurs, les évènements matériels et les
+// allocations de la mise à jour qui se termine, si le fichier des mesures est ouvert
+void compteur_export_update(void);
+
+//---------------------------------------------------------------------
+// écrit le total de toutes les mises à jour et ferme le fichier ;
+// renvoie 0 si une écriture a échoué
+bool compteur_export_fermer(void);
+
+#endif
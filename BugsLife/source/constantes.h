@@ -22,7 +22,7 @@
 #define FEED_RATE      	0.002  // 0.01
 #define BIRTH_RATE     	0.0005 //0.01
 #define MAX_RENDU1     	5 
-#define	MAX_FOURMILIERE 10
+#define	MAX_FOURMILIERE 10000
 #define MAX_LINE 		120
 
 #endif
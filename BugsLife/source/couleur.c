@@ -0,0 +1,66 @@
+/*!
+ \file couleur.c
+ \brief Module qui donne la couleur de chaque fourmilière, sans dépendre
+  d'OpenGL : les versions avec et sans affichage partagent le même calcul
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <math.h>
+#include "couleur.h"
+
+#define NOMBRE_OR 0.618033988749895
+
+static const COULEUR tab_couleurs[NB_COLOR] = {
+    [ROUGE] = { 1., 0., 0. },
+    [VERT] = { 0., 1., 0. },
+    [BLEU] = { 0., 0., 1. },
+    [MAGENTA] = { 1., 0., 1. },
+    [CYAN] = { 0., 1., 1. },
+    [JAUNE] = { 1., 1., 0. },
+    [MARRON] = { 0.34, 0.16, 0. },
+    [ORANGE] = { 1., 0.5, 0. },
+    [GRIS] = { 0.5, 0.5, 0.5 },
+    [ROSE] = { 0.992, 0.424, 0.62 },
+    [NOIR] = { 0., 0., 0. }};
+
+//---------------------------------------------------------------------
+// couleur de teinte répartie par le nombre d'or pour que deux rangs
+// voisins restent bien distincts (conversion TSV -> RVB)
+static COULEUR couleur_generee(int rang);
+
+int couleur_fourmiliere(unsigned indice_f)
+{
+    if(indice_f < NOIR)
+        return indice_f;
+    return NB_COLOR + (indice_f - NOIR);
+}
+
+COULEUR couleur_composantes(int col)
+{
+    if(col < NB_COLOR)
+        return tab_couleurs[col];
+    return couleur_generee(col - NB_COLOR);
+}
+
+static COULEUR couleur_generee(int rang)
+{
+    const float saturation = 0.8, valeur = 0.85;
+    float teinte = 6*fmod(0.1 + rang*NOMBRE_OR, 1.);
+    int secteur = (int) teinte;
+    float f = teinte - secteur;
+    float p = valeur*(1 - saturation);
+    float q = valeur*(1 - saturation*f);
+    float t = valeur*(1 - saturation*(1 - f));
+    
+    switch(secteur)
+    {
+        case 0 : return (COULEUR) { valeur, t, p };
+        case 1 : return (COULEUR) { q, valeur, p };
+        case 2 : return (COULEUR) { p, valeur, t };
+        case 3 : return (COULEUR) { p, q, valeur };
+        case 4 : return (COULEUR) { t, p, valeur };
+        default : return (COULEUR) { valeur, p, q };
+    }
+}
@@ -0,0 +1,37 @@
+/*!
+ \file couleur.h
+ \brief Module qui donne la couleur de chaque fourmilière, sans dépendre
+  d'OpenGL : les versions avec et sans affichage partagent le même calcul
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef COULEUR_H
+#define COULEUR_H
+
+/*---------------------------------------------------------------------
+ Structure de données d'une couleur : type concret
+	r, g, b : composantes rouge, verte et bleue, entre 0 et 1
+ ----------------------------------------------------------------------*/
+typedef struct Couleur COULEUR;
+struct Couleur
+{
+    float r;
+    float g;
+    float b;
+};
+
+enum CouleurNom {ROUGE, VERT, BLEU, MAGENTA, CYAN, JAUNE, MARRON, ORANGE,
+				 GRIS, ROSE, NOIR, NB_COLOR};
+
+//---------------------------------------------------------------------
+// renvoie la couleur d'une fourmilière : les NOIR premières fourmilières
+// prennent les couleurs nommées, les suivantes une couleur générée
+int couleur_fourmiliere(unsigned indice_f);
+
+//---------------------------------------------------------------------
+// renvoie les composantes de la couleur col, nommée ou générée
+COULEUR couleur_composantes(int col);
+
+#endif
@@ -0,0 +1,414 @@
+/*!
+ \file differentiel.c
+ \brief Module principal du contrôle différentiel : met à jour chaque
+  scénario du banc d'essai avec le moteur de référence puis avec une
+  variante optimisée, compare l'empreinte du monde toutes les periode
+  mises à jour et donne la première mise à jour et la première entité
+  qui diffèrent ; une variante peut aussi être comparée à elle-même pour
+  vérifier son déterminisme
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "aleatoire.h"
+#include "empreinte.h"
+#include "fourmi.h"
+#include "generateur.h"
+#include "modele.h"
+
+#define FICHIER_SCENARIO "differentiel_scenario.txt"
+#define NB_FOURMIS_DEFAUT 1000
+#define NB_UPDATES_DEFAUT 200
+#define PERIODE_DEFAUT 10
+
+// la référence n'active aucune optimisation du choix des nourritures
+enum Variante {REFERENCE, LOT, CACHE, NB_VARIANTES};
+
+static const char * tab_nom_variante[NB_VARIANTES] = {"reference", "lot",
+    "cache"};
+
+static enum Variante temoin = REFERENCE; // moteur auquel la variante est comparée
+
+/*---------------------------------------------------------------------
+ Structure de données d'une entité notée pendant le calcul d'une
+ empreinte
+	genre : genre de l'entité
+	indice : indice de l'entité dans son genre
+	empreinte : empreinte de l'entité
+ ----------------------------------------------------------------------*/
+typedef struct Entite ENTITE;
+struct Entite
+{
+    enum GenreEmpreinte genre;
+    unsigned indice;
+    uint64_t empreinte;
+};
+
+static ENTITE * tab_entite = NULL;
+static size_t nb_entite = 0;
+static size_t taille_tab_entite = 0;
+static bool entites_completes = true; // aucune entité perdue faute de mémoire
+
+//---------------------------------------------------------------------
+// compare la variante au témoin sur le scénario déjà écrit ;
+// renvoie 1 si leurs empreintes sont identiques, 0 sinon ou en cas
+// d'erreur
+static bool differentiel_famille(enum FamilleScenario famille,
+                                 enum Variante variante, int nb_updates,
+                                 int periode);
+
+//---------------------------------------------------------------------
+// relit le scénario, sème le générateur, règle le moteur sur la variante
+// et le met à jour nb_updates fois
+static bool differentiel_charger(enum Variante variante, int nb_updates);
+
+//---------------------------------------------------------------------
+// retourne l'empreinte du monde courant
+static uint64_t differentiel_empreinte(void);
+
+//---------------------------------------------------------------------
+// retourne la première mise à jour entre debut (exclue), où les deux
+// moteurs étaient identiques, et fin (incluse) où la variante diverge ;
+// -1 en cas d'erreur
+static int differentiel_localiser(enum Variante variante, int debut, int fin);
+
+//---------------------------------------------------------------------
+// écrit les genres et la première entité qui diffèrent à la mise à jour
+static bool differentiel_signaler(enum Variante variante, int update);
+
+//---------------------------------------------------------------------
+// relève le monde de la variante à la mise à jour et range ses entités
+// par genre, indice puis empreinte
+static bool differentiel_entites(enum Variante variante, int update,
+                                 EMPREINTE * empreinte);
+
+//---------------------------------------------------------------------
+// ajoute l'entité au tableau, appelée par modele_empreinte
+static void differentiel_noter(enum GenreEmpreinte genre, unsigned indice,
+                               uint64_t empreinte);
+
+//---------------------------------------------------------------------
+// compare deux entités pour qsort
+static int differentiel_comparer(const void * a, const void * b);
+
+//---------------------------------------------------------------------
+// écrit la famille, la variante et le témoin s'il n'est pas la référence
+static void differentiel_nommer(enum FamilleScenario famille,
+                                enum Variante variante);
+
+int main(int argc, char *argv[])
+{
+    long nb_fourmis = NB_FOURMIS_DEFAUT;
+    int nb_updates = NB_UPDATES_DEFAUT, periode = PERIODE_DEFAUT;
+    int f, v, choix = NB_FAMILLES, variante = NB_VARIANTES, t = REFERENCE;
+    bool identiques = true, lisible;
+
+    if(argc > 1 && strcmp(argv[1], "toutes"))
+        choix = generateur_famille(argv[1]);
+    if(argc > 2)
+        nb_fourmis = atol(argv[2]);
+    if(argc > 3)
+        nb_updates = atoi(argv[3]);
+    if(argc > 4)
+        periode = atoi(argv[4]);
+    if(argc > 5 && strcmp(argv[5], "toutes"))
+        for(variante=0 ; variante<NB_VARIANTES &&
+            strcmp(argv[5], tab_nom_variante[variante]) ; variante++);
+    if(argc > 6)
+        for(t=0 ; t<NB_VARIANTES && strcmp(argv[6], tab_nom_variante[t]) ; t++);
+    if(argc > 7 || choix < 0 || nb_fourmis < 1 || nb_updates < 0 ||
+       periode < 1 || (argc > 5 && strcmp(argv[5], "toutes") &&
+                       variante == NB_VARIANTES) || t == NB_VARIANTES)
+    {
+        printf("erreur : usage : '././differentiel.x [toutes|uniforme|"
+               "groupee|riche|affamee|guerre] [nb_fourmis] [nb_updates] "
+               "[periode] [toutes|reference|lot|cache] "
+               "[reference|lot|cache]'\n");
+        return EXIT_FAILURE;
+    }
+    temoin = t;
+
+    for(f=0 ; f<NB_FAMILLES ; f++)
+    {
+        if(choix != NB_FAMILLES && choix != f)
+            continue;
+
+        lisible = generateur_ecrire(FICHIER_SCENARIO, f, nb_fourmis);
+        //sans variante demandée, chaque optimisation est comparée au
+        //témoin ; une variante comparée à elle-même vérifie son déterminisme
+        for(v=LOT ; lisible && v<NB_VARIANTES ; v++)
+            if(variante == NB_VARIANTES || variante == v)
+                identiques &= differentiel_famille(f, v, nb_updates, periode);
+        if(variante == REFERENCE)
+            identiques &= differentiel_famille(f, REFERENCE, nb_updates,
+                                               periode);
+        remove(FICHIER_SCENARIO);
+
+        if(!lisible)
+        {
+            printf("Scénario %s de %ld fourmis illisible\n",
+                   generateur_nom(f), nb_fourmis);
+            identiques = false;
+        }
+    }
+
+    modele_nettoyer();
+    free(tab_entite);
+    return identiques ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool differentiel_famille(enum FamilleScenario famille,
+                                 enum Variante variante, int nb_updates,
+                                 int periode)
+{
+    uint64_t * tab_reference = NULL;
+    int nb_points = (nb_updates + periode - 1)/periode + 1;
+    int i, update, precedente, divergence;
+
+    if(!(tab_reference = (uint64_t *) malloc (nb_points*sizeof(uint64_t))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+
+    //empreintes du témoin à chaque point de contrôle : la mise à jour
+    //i*periode, et la dernière
+    if(!differentiel_charger(temoin, 0))
+    {
+        free(tab_reference);
+        return 0;
+    }
+    tab_reference[0] = differentiel_empreinte();
+    for(i=1, update=0 ; i<nb_points ; i++)
+    {
+        for( ; update < i*periode && update < nb_updates ; update++)
+            modele_update(true, false);
+        tab_reference[i] = differentiel_empreinte();
+    }
+
+    if(!differentiel_charger(variante, 0))
+    {
+        free(tab_reference);
+        return 0;
+    }
+    for(i=0, update=0, precedente=0 ; i<nb_points ; i++)
+    {
+        for( ; update < i*periode && update < nb_updates ; update++)
+            modele_update(true, false);
+        if(differentiel_empreinte() != tab_reference[i])
+            break;
+        precedente = update;
+    }
+    free(tab_reference);
+
+    if(i == nb_points)
+    {
+        differentiel_nommer(famille, variante);
+        printf("identique sur %d mises à jour\n", nb_updates);
+        return 1;
+    }
+
+    //le monde lu est le même pour toutes les variantes : seule une mise
+    //à jour peut diverger
+    divergence = i ? differentiel_localiser(variante, precedente, update) : 0;
+    if(divergence < 0)
+        return 0;
+    differentiel_nommer(famille, variante);
+    printf("diverge à la mise à jour %d\n", divergence);
+    differentiel_signaler(variante, divergence);
+    return 0;
+}
+
+static bool differentiel_charger(enum Variante variante, int nb_updates)
+{
+    int i;
+
+    //la vérification de rendu 2 est passée, comme pour le banc d'essai
+    modele_nettoyer();
+    if(!modele_lecture((char *) FICHIER_SCENARIO, FINAL))
+        return 0;
+    aleatoire_semer(GENERATEUR_GRAINE);
+    fourmi_set_affectation_lot(variante == LOT);
+    fourmi_set_cache_but(variante == CACHE);
+
+    for(i=0 ; i<nb_updates ; i++)
+        modele_update(true, false);
+    return 1;
+}
+
+static uint64_t differentiel_empreinte(void)
+{
+    EMPREINTE empreinte;
+
+    modele_empreinte(&empreinte, NULL);
+    return empreinte_totale(&empreinte);
+}
+
+static int differentiel_localiser(enum Variante variante, int debut, int fin)
+{
+    uint64_t * tab_reference = NULL;
+    int update;
+
+    if(!(tab_reference = (uint64_t *) malloc ((fin - debut)*sizeof(uint64_t))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return -1;
+    }
+
+    //les deux moteurs sont rejoués depuis le scénario jusqu'au dernier
+    //point identique, puis comparés à chaque mise à jour
+    if(!differentiel_charger(temoin, debut))
+    {
+        free(tab_reference);
+        return -1;
+    }
+    for(update=debut+1 ; update<=fin ; update++)
+    {
+        modele_update(true, false);
+        tab_reference[update - debut - 1] = differentiel_empreinte();
+    }
+
+    if(!differentiel_charger(variante, debut))
+    {
+        free(tab_reference);
+        return -1;
+    }
+    for(update=debut+1 ; update<fin ; update++)
+    {
+        modele_update(true, false);
+        if(differentiel_empreinte() != tab_reference[update - debut - 1])
+            break;
+    }
+
+    free(tab_reference);
+    return update;
+}
+
+static bool differentiel_signaler(enum Variante variante, int update)
+{
+    EMPREINTE reference, optimisee;
+    ENTITE * tab_reference = NULL;
+    size_t nb_reference, i = 0, j = 0;
+    int g, ordre;
+
+    if(!differentiel_entites(temoin, update, &reference))
+        return 0;
+    //les entités de la référence sont gardées de côté
+    tab_reference = tab_entite;
+    nb_reference = nb_entite;
+    tab_entite = NULL;
+    nb_entite = taille_tab_entite = 0;
+    if(!differentiel_entites(variante, update, &optimisee))
+    {
+        free(tab_reference);
+        return 0;
+    }
+
+    printf("    genres différents :");
+    for(g=0 ; g<NB_GENRES_EMPREINTE ; g++)
+        if(reference.somme[g] != optimisee.somme[g])
+            printf(" %s", empreinte_nom(g));
+    printf("\n");
+
+    while(i < nb_reference && j < nb_entite &&
+          !differentiel_comparer(&tab_reference[i], &tab_entite[j]))
+    {
+        i++;
+        j++;
+    }
+
+    if(i == nb_reference && j == nb_entite)
+        printf("    aucune entité différente\n");
+    else if(i < nb_reference && j < nb_entite &&
+            tab_reference[i].genre == tab_entite[j].genre &&
+            tab_reference[i].indice == tab_entite[j].indice)
+        printf("    première entité différente : %s %u (%016llx contre "
+               "%016llx)\n", empreinte_nom(tab_reference[i].genre),
+               tab_reference[i].indice,
+               (unsigned long long) tab_reference[i].empreinte,
+               (unsigned long long) tab_entite[j].empreinte);
+    else
+    {
+        //l'entité rangée la première n'existe que dans l'un des moteurs
+        ordre = j == nb_entite ? -1 : i == nb_reference ? 1 :
+                differentiel_comparer(&tab_reference[i], &tab_entite[j]);
+        if(ordre < 0)
+            printf("    première entité différente : %s %u, absente de la "
+                   "variante\n", empreinte_nom(tab_reference[i].genre),
+                   tab_reference[i].indice);
+        else
+            printf("    première entité différente : %s %u, absente du "
+                   "témoin %s\n", empreinte_nom(tab_entite[j].genre),
+                   tab_entite[j].indice, tab_nom_variante[temoin]);
+    }
+
+    free(tab_reference);
+    return 1;
+}
+
+static bool differentiel_entites(enum Variante variante, int update,
+                                 EMPREINTE * empreinte)
+{
+    if(!differentiel_charger(variante, update))
+        return 0;
+
+    nb_entite = 0;
+    entites_completes = true;
+    modele_empreinte(empreinte, differentiel_noter);
+    if(!entites_completes)
+        return 0;
+
+    qsort(tab_entite, nb_entite, sizeof(ENTITE), differentiel_comparer);
+    return 1;
+}
+
+static void differentiel_noter(enum GenreEmpreinte genre, unsigned indice,
+                               uint64_t empreinte)
+{
+    ENTITE * nouveau = NULL;
+    size_t taille;
+
+    if(nb_entite == taille_tab_entite)
+    {
+        taille = taille_tab_entite ? 2*taille_tab_entite : 1024;
+        if(!(nouveau = (ENTITE *) realloc (tab_entite, taille*sizeof(ENTITE))))
+        {
+            if(entites_completes)
+                printf("Problème de mémoire dans la fonction %s\n", __func__);
+            entites_completes = false;
+            return;
+        }
+        tab_entite = nouveau;
+        taille_tab_entite = taille;
+    }
+
+    tab_entite[nb_entite].genre = genre;
+    tab_entite[nb_entite].indice = indice;
+    tab_entite[nb_entite].empreinte = empreinte;
+    nb_entite++;
+}
+
+static int differentiel_comparer(const void * a, const void * b)
+{
+    const ENTITE * ea = (const ENTITE *) a, * eb = (const ENTITE *) b;
+
+    if(ea->genre != eb->genre)
+        return ea->genre < eb->genre ? -1 : 1;
+    if(ea->indice != eb->indice)
+        return ea->indice < eb->indice ? -1 : 1;
+    return (ea->empreinte > eb->empreinte) - (ea->empreinte < eb->empreinte);
+}
+
+static void differentiel_nommer(enum FamilleScenario famille,
+                                enum Variante variante)
+{
+    printf("%-9s %-9s ", generateur_nom(famille), tab_nom_variante[variante]);
+    if(temoin != REFERENCE)
+        printf("contre %-9s ", tab_nom_variante[temoin]);
+}
@@ -0,0 +1,93 @@
+/*!
+ \file empreinte.c
+ \brief Module qui calcule l'empreinte de l'état du monde : chaque entité
+  a sa propre empreinte, et leur somme ne dépend pas de l'ordre des
+  listes, pour comparer deux variantes du moteur
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "binaire.h"
+#include "empreinte.h"
+
+static const char * tab_nom_genre[NB_GENRES_EMPREINTE] = {"fourmiliere",
+    "ouvriere", "garde", "nourriture", "compteurs"};
+
+//---------------------------------------------------------------------
+// mélange les bits de l'empreinte d'une entité (finaliseur de
+// MurmurHash3) : deux entités proches ont des empreintes sans rapport et
+// leur somme ne s'annule pas
+static uint64_t empreinte_melanger(uint64_t valeur);
+
+void empreinte_vider(EMPREINTE * empreinte)
+{
+    int g;
+
+    for(g=0 ; g<NB_GENRES_EMPREINTE ; g++)
+        empreinte->somme[g] = 0;
+}
+
+uint64_t empreinte_debut(void)
+{
+    return binaire_fnv_debut();
+}
+
+uint64_t empreinte_entier(uint64_t courante, uint64_t valeur)
+{
+    unsigned char octets[8];
+    int i;
+
+    //FNV-1a sur les octets de poids faible en premier, quel que soit
+    //le boutisme de la machine
+    for(i=0 ; i<8 ; i++, valeur >>= 8)
+        octets[i] = (unsigned char) (valeur & 0xff);
+    return binaire_fnv(courante, octets, sizeof(octets));
+}
+
+uint64_t empreinte_reel(uint64_t courante, double valeur)
+{
+    uint64_t bits;
+
+    if(valeur == 0)
+        valeur = 0;
+    memcpy(&bits, &valeur, sizeof(bits));
+    return empreinte_entier(courante, bits);
+}
+
+void empreinte_ajouter(EMPREINTE * empreinte, enum GenreEmpreinte genre,
+                       unsigned indice, uint64_t entite, NOTER_ENTITE noter)
+{
+    entite = empreinte_melanger(empreinte_entier(entite, genre));
+    empreinte->somme[genre] += entite;
+    if(noter)
+        noter(genre, indice, entite);
+}
+
+uint64_t empreinte_totale(const EMPREINTE * empreinte)
+{
+    uint64_t totale = empreinte_debut();
+    int g;
+
+    for(g=0 ; g<NB_GENRES_EMPREINTE ; g++)
+        totale = empreinte_entier(totale, empreinte->somme[g]);
+    return totale;
+}
+
+const char * empreinte_nom(enum GenreEmpreinte genre)
+{
+    return tab_nom_genre[genre];
+}
+
+static uint64_t empreinte_melanger(uint64_t valeur)
+{
+    valeur ^= valeur >> 33;
+    valeur *= UINT64_C(0xff51afd7ed558ccd);
+    valeur ^= valeur >> 33;
+    valeur *= UINT64_C(0xc4ceb9fe1a85ec53);
+    valeur ^= valeur >> 33;
+    return valeur;
+}
@@ -0,0 +1,71 @@
+/*!
+ \file empreinte.h
+ \brief Module qui calcule l'empreinte de l'état du monde : chaque entité
+  a sa propre empreinte, et leur somme ne dépend pas de l'ordre des
+  listes, pour comparer deux variantes du moteur
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef EMPREINTE_H
+#define EMPREINTE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum GenreEmpreinte {EMPREINTE_FOURMILIERE, EMPREINTE_OUVRIERE,
+    EMPREINTE_GARDE, EMPREINTE_NOURRITURE, EMPREINTE_COMPTEURS,
+    NB_GENRES_EMPREINTE};
+
+// compteurs globaux, chacun étant une entité du genre EMPREINTE_COMPTEURS
+enum CompteurEmpreinte {EMPREINTE_COMPTEURS_FOURMILIERE,
+    EMPREINTE_COMPTEURS_FOURMI, EMPREINTE_COMPTEURS_NOURRITURE,
+    EMPREINTE_COMPTEURS_ALEATOIRE};
+
+/*---------------------------------------------------------------------
+ Structure de données de l'empreinte du monde : type concret
+	somme : somme des empreintes des entités de chaque genre
+ ----------------------------------------------------------------------*/
+typedef struct Empreinte EMPREINTE;
+struct Empreinte
+{
+    uint64_t somme[NB_GENRES_EMPREINTE];
+};
+
+// appelée pour chaque entité ajoutée, si elle n'est pas NULL
+typedef void (*NOTER_ENTITE)(enum GenreEmpreinte genre, unsigned indice,
+                             uint64_t empreinte);
+
+//---------------------------------------------------------------------
+// met toutes les sommes à zéro
+void empreinte_vider(EMPREINTE * empreinte);
+
+//---------------------------------------------------------------------
+// empreinte de départ d'une entité
+uint64_t empreinte_debut(void);
+
+//---------------------------------------------------------------------
+// ajoute un entier à l'empreinte d'une entité
+uint64_t empreinte_entier(uint64_t courante, uint64_t valeur);
+
+//---------------------------------------------------------------------
+// ajoute un réel à l'empreinte d'une entité, bit à bit ; 0 et -0 sont
+// confondus
+uint64_t empreinte_reel(uint64_t courante, double valeur);
+
+//---------------------------------------------------------------------
+// termine l'empreinte d'une entité, l'ajoute à la somme de son genre et
+// la donne à noter
+void empreinte_ajouter(EMPREINTE * empreinte, enum GenreEmpreinte genre,
+                       unsigned indice, uint64_t entite, NOTER_ENTITE noter);
+
+//---------------------------------------------------------------------
+// retourne l'empreinte du monde, qui combine tous les genres
+uint64_t empreinte_totale(const EMPREINTE * empreinte);
+
+//---------------------------------------------------------------------
+// retourne le nom du genre
+const char * empreinte_nom(enum GenreEmpreinte genre);
+
+#endif
@@ -0,0 +1,398 @@
+/*!
+ \file enregistreur.c
+ \brief Module qui enregistre l'évolution des fourmilières en blocs
+  binaires rangés par colonnes, écrits en arrière-plan, et qui les
+  exporte au format texte de gnuplot
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "memoire.h"
+#include "binaire.h"
+#include "traceur.h"
+#include "enregistreur.h"
+
+// fichier : signature et version, puis une section par bloc de lignes
+#define SIGNATURE_ENREGISTREMENT "BUGSSERI"
+#define TAILLE_SIGNATURE 8
+#define VERSION_ENREGISTREMENT 1
+#define SECTION_BLOC 0x434F4C42 // "BLOC"
+#define NB_LIGNES_BLOC 256
+#define NB_TAMPONS 2 // un bloc s'écrit pendant que le suivant se remplit
+#define TAILLE_LIGNE_COLONNE 17 // présence, nbF, nbO, nbG et total_food
+
+/*---------------------------------------------------------------------
+ Structure de données des colonnes d'une fourmilière dans un bloc
+	presentes : vrai si la fourmilière existait à cette ligne
+	nbF , nbO , nbG , total_food : valeurs de la fourmilière à chaque
+	                               ligne
+ ----------------------------------------------------------------------*/
+typedef struct Colonne COLONNE;
+struct Colonne
+{
+    unsigned char presentes[NB_LIGNES_BLOC];
+    uint32_t nbF[NB_LIGNES_BLOC];
+    uint32_t nbO[NB_LIGNES_BLOC];
+    uint32_t nbG[NB_LIGNES_BLOC];
+    float total_food[NB_LIGNES_BLOC];
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un enregistreur
+	fichier : fichier ouvert en ajout, écrit seulement par le fil
+	nb_update , nb_nourriture : colonnes globales du bloc en cours
+	colonnes : colonnes de chaque fourmilière du bloc en cours
+	capacite_colonnes : taille allouée du tableau colonnes
+	nb_colonnes : nombre de fourmilières du bloc en cours
+	nb_lignes : nombre de lignes du bloc en cours
+	tampons : blocs mis en forme, écrits à tour de rôle
+	suivant : tampon où mettre en forme le prochain bloc
+	fil : fil d'écriture
+	verrou , condition : protègent a_ecrire, arret et erreur
+	a_ecrire : tampon confié au fil, NULL s'il n'écrit rien
+	arret : demande au fil de s'arrêter
+	erreur : vrai si une écriture a échoué
+ ----------------------------------------------------------------------*/
+struct Enregistreur
+{
+    FILE * fichier;
+    uint32_t nb_update[NB_LIGNES_BLOC];
+    uint32_t nb_nourriture[NB_LIGNES_BLOC];
+    COLONNE * colonnes;
+    int capacite_colonnes;
+    int nb_colonnes;
+    int nb_lignes;
+    TAMPON * tampons[NB_TAMPONS];
+    int suivant;
+    pthread_t fil;
+    pthread_mutex_t verrou;
+    pthread_cond_t condition;
+    TAMPON * a_ecrire;
+    bool arret;
+    bool erreur;
+};
+
+static void enregistreur_vider_bloc(ENREGISTREUR * enregistreur);
+static void enregistreur_confier(ENREGISTREUR * enregistreur, TAMPON * tampon);
+static void * enregistreur_ecrire(void * argument);
+static bool enregistreur_exporter_bloc(LECTURE_BINAIRE * bloc, FILE * fsortie);
+static uint32_t enregistreur_entier32(const unsigned char * octets);
+
+ENREGISTREUR * enregistreur_creer(const char * nom_fichier)
+{
+    ENREGISTREUR * enregistreur = NULL;
+    int i;
+
+    if(!(enregistreur = (ENREGISTREUR *) malloc (sizeof(ENREGISTREUR))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+
+    enregistreur->colonnes = NULL;
+    enregistreur->capacite_colonnes = 0;
+    enregistreur->nb_colonnes = 0;
+    enregistreur->nb_lignes = 0;
+    enregistreur->suivant = 0;
+    enregistreur->a_ecrire = NULL;
+    enregistreur->arret = false;
+    enregistreur->erreur = false;
+    for(i=0 ; i<NB_TAMPONS ; i++)
+        enregistreur->tampons[i] = binaire_creer();
+
+    if(!enregistreur->tampons[0] || !enregistreur->tampons[1] ||
+       !(enregistreur->fichier = fopen(nom_fichier, "wb")))
+    {
+        for(i=0 ; i<NB_TAMPONS ; i++)
+            binaire_detruire(enregistreur->tampons[i]);
+        free(enregistreur);
+        return NULL;
+    }
+
+    pthread_mutex_init(&enregistreur->verrou, NULL);
+    pthread_cond_init(&enregistreur->condition, NULL);
+    if(pthread_create(&enregistreur->fil, NULL, enregistreur_ecrire, enregistreur))
+    {
+        fclose(enregistreur->fichier);
+        for(i=0 ; i<NB_TAMPONS ; i++)
+            binaire_detruire(enregistreur->tampons[i]);
+        pthread_cond_destroy(&enregistreur->condition);
+        pthread_mutex_destroy(&enregistreur->verrou);
+        free(enregistreur);
+        return NULL;
+    }
+
+    //l'en-tête part comme un premier bloc
+    binaire_ecrire_octets(enregistreur->tampons[0], SIGNATURE_ENREGISTREMENT,
+                          TAILLE_SIGNATURE);
+    binaire_ecrire_entier32(enregistreur->tampons[0], VERSION_ENREGISTREMENT);
+    enregistreur_confier(enregistreur, enregistreur->tampons[0]);
+    enregistreur->suivant = 1;
+
+    return enregistreur;
+}
+
+bool enregistreur_detruire(ENREGISTREUR * enregistreur)
+{
+    bool reussi;
+    int i;
+
+    if(!enregistreur)
+        return 1;
+
+    if(enregistreur->nb_lignes)
+        enregistreur_vider_bloc(enregistreur);
+
+    pthread_mutex_lock(&enregistreur->verrou);
+    enregistreur->arret = true;
+    pthread_cond_broadcast(&enregistreur->condition);
+    pthread_mutex_unlock(&enregistreur->verrou);
+
+    //le fil termine d'abord le bloc en cours
+    pthread_join(enregistreur->fil, NULL);
+
+    reussi = !enregistreur->erreur;
+    if(fclose(enregistreur->fichier))
+        reussi = false;
+
+    for(i=0 ; i<NB_TAMPONS ; i++)
+        binaire_detruire(enregistreur->tampons[i]);
+    free(enregistreur->colonnes);
+    pthread_cond_destroy(&enregistreur->condition);
+    pthread_mutex_destroy(&enregistreur->verrou);
+    free(enregistreur);
+
+    return reussi;
+}
+
+void enregistreur_ligne(ENREGISTREUR * enregistreur, uint32_t nb_update,
+                        int nb_colonnes, int nb_nourriture)
+{
+    int ligne, i;
+
+    //un bloc n'a qu'un nombre de fourmilières
+    if(enregistreur->nb_lignes == NB_LIGNES_BLOC ||
+       (enregistreur->nb_lignes && nb_colonnes != enregistreur->nb_colonnes))
+        enregistreur_vider_bloc(enregistreur);
+
+    if(!enregistreur->nb_lignes)
+    {
+        if(!memoire_reserver((void **) &enregistreur->colonnes,
+                             &enregistreur->capacite_colonnes, nb_colonnes,
+                             sizeof(COLONNE)))
+        {
+            pthread_mutex_lock(&enregistreur->verrou);
+            enregistreur->erreur = true;
+            pthread_mutex_unlock(&enregistreur->verrou);
+            return;
+        }
+        enregistreur->nb_colonnes = nb_colonnes;
+    }
+
+    ligne = enregistreur->nb_lignes++;
+    enregistreur->nb_update[ligne] = nb_update;
+    enregistreur->nb_nourriture[ligne] = nb_nourriture;
+    for(i=0 ; i<nb_colonnes ; i++)
+        enregistreur->colonnes[i].presentes[ligne] = 0;
+}
+
+void enregistreur_colonie(ENREGISTREUR * enregistreur, int indice, int nbF,
+                          int nbO, int nbG, float total_food)
+{
+    int ligne = enregistreur->nb_lignes - 1;
+    COLONNE * colonne = NULL;
+
+    if(ligne < 0 || indice < 0 || indice >= enregistreur->nb_colonnes)
+        return;
+
+    colonne = &enregistreur->colonnes[indice];
+    colonne->presentes[ligne] = 1;
+    colonne->nbF[ligne] = nbF;
+    colonne->nbO[ligne] = nbO;
+    colonne->nbG[ligne] = nbG;
+    colonne->total_food[ligne] = total_food;
+}
+
+bool enregistreur_exporter_gnuplot(const char * nom_enregistrement,
+                                   const char * nom_gnuplot)
+{
+    TAMPON * tampon = NULL;
+    LECTURE_BINAIRE lecture, bloc;
+    FILE * fsortie = NULL;
+    char signature[TAILLE_SIGNATURE];
+    bool reussi;
+
+    if(!(tampon = binaire_creer()))
+        return 0;
+
+    if(!binaire_charger(tampon, nom_enregistrement))
+    {
+        binaire_detruire(tampon);
+        return 0;
+    }
+
+    lecture = binaire_lecture(tampon);
+    binaire_lire_octets(&lecture, signature, TAILLE_SIGNATURE);
+    reussi = !memcmp(signature, SIGNATURE_ENREGISTREMENT, TAILLE_SIGNATURE) &&
+             binaire_lire_entier32(&lecture) == VERSION_ENREGISTREMENT &&
+             (fsortie = fopen(nom_gnuplot, "w"));
+
+    while(reussi && binaire_section(&lecture, SECTION_BLOC, &bloc))
+        reussi = enregistreur_exporter_bloc(&bloc, fsortie);
+    reussi = reussi && !lecture.erreur;
+
+    if(fsortie && fclose(fsortie))
+        reussi = false;
+    binaire_detruire(tampon);
+
+    return reussi;
+}
+
+//---------------------------------------------------------------------
+// met le bloc en cours en forme, colonne après colonne, et le confie au
+// fil d'écriture
+static void enregistreur_vider_bloc(ENREGISTREUR * enregistreur)
+{
+    TAMPON * tampon = enregistreur->tampons[enregistreur->suivant];
+    int nb_lignes = enregistreur->nb_lignes, i, j;
+    size_t debut;
+
+    //l'autre tampon peut encore être en cours d'écriture, pas celui-ci
+    binaire_vider(tampon);
+    debut = binaire_debut_section(tampon, SECTION_BLOC);
+    binaire_ecrire_entier32(tampon, nb_lignes);
+    binaire_ecrire_entier32(tampon, enregistreur->nb_colonnes);
+
+    for(j=0 ; j<nb_lignes ; j++)
+        binaire_ecrire_entier32(tampon, enregistreur->nb_update[j]);
+    for(j=0 ; j<nb_lignes ; j++)
+        binaire_ecrire_entier32(tampon, enregistreur->nb_nourriture[j]);
+
+    for(i=0 ; i<enregistreur->nb_colonnes ; i++)
+    {
+        COLONNE * colonne = &enregistreur->colonnes[i];
+
+        binaire_ecrire_octets(tampon, colonne->presentes, nb_lignes);
+        for(j=0 ; j<nb_lignes ; j++)
+            binaire_ecrire_entier32(tampon, colonne->nbF[j]);
+        for(j=0 ; j<nb_lignes ; j++)
+            binaire_ecrire_entier32(tampon, colonne->nbO[j]);
+        for(j=0 ; j<nb_lignes ; j++)
+            binaire_ecrire_entier32(tampon, colonne->nbG[j]);
+        for(j=0 ; j<nb_lignes ; j++)
+            binaire_ecrire_float(tampon, colonne->total_food[j]);
+    }
+    binaire_fin_section(tampon, debut);
+
+    enregistreur_confier(enregistreur, tampon);
+    enregistreur->suivant = (enregistreur->suivant + 1)%NB_TAMPONS;
+    enregistreur->nb_lignes = 0;
+}
+
+//---------------------------------------------------------------------
+// attend que le fil ait fini le bloc précédent puis lui confie le tampon
+static void enregistreur_confier(ENREGISTREUR * enregistreur, TAMPON * tampon)
+{
+    double debut = traceur_debut();
+
+    pthread_mutex_lock(&enregistreur->verrou);
+    while(enregistreur->a_ecrire)
+        pthread_cond_wait(&enregistreur->condition, &enregistreur->verrou);
+    enregistreur->a_ecrire = tampon;
+    pthread_cond_broadcast(&enregistreur->condition);
+    pthread_mutex_unlock(&enregistreur->verrou);
+    traceur_intervalle("confier_enregistrement", debut);
+}
+
+//---------------------------------------------------------------------
+// boucle du fil : ajoute chaque tampon confié à la fin du fichier
+static void * enregistreur_ecrire(void * argument)
+{
+    ENREGISTREUR * enregistreur = (ENREGISTREUR *) argument;
+    LECTURE_BINAIRE contenu;
+    size_t taille;
+    double debut;
+    bool reussi;
+
+    traceur_nommer_fil("enregistreur");
+    pthread_mutex_lock(&enregistreur->verrou);
+    while(true)
+    {
+        while(!enregistreur->a_ecrire && !enregistreur->arret)
+            pthread_cond_wait(&enregistreur->condition, &enregistreur->verrou);
+        if(!enregistreur->a_ecrire)
+            break;
+
+        pthread_mutex_unlock(&enregistreur->verrou);
+        debut = traceur_debut();
+        contenu = binaire_lecture(enregistreur->a_ecrire);
+        taille = contenu.fin - contenu.pos;
+        reussi = !binaire_get_erreur(enregistreur->a_ecrire) &&
+                 fwrite(contenu.pos, 1, taille, enregistreur->fichier) == taille &&
+                 !fflush(enregistreur->fichier);
+        traceur_intervalle("ecriture_enregistrement", debut);
+        pthread_mutex_lock(&enregistreur->verrou);
+
+        if(!reussi)
+            enregistreur->erreur = true;
+        enregistreur->a_ecrire = NULL;
+        pthread_cond_broadcast(&enregistreur->condition);
+    }
+    pthread_mutex_unlock(&enregistreur->verrou);
+
+    return NULL;
+}
+
+//---------------------------------------------------------------------
+// écrit les lignes d'un bloc comme fourmiliere_ecriture_gnuplot les
+// écrivait : la mise à jour puis la nourriture de chaque fourmilière,
+// ou 0 si elle n'existe plus
+static bool enregistreur_exporter_bloc(LECTURE_BINAIRE * bloc, FILE * fsortie)
+{
+    uint32_t nb_lignes = binaire_lire_entier32(bloc);
+    uint32_t nb_colonnes = binaire_lire_entier32(bloc);
+    size_t taille_colonne = (size_t) nb_lignes*TAILLE_LIGNE_COLONNE;
+    uint32_t i, j;
+
+    if(bloc->erreur || nb_lignes > NB_LIGNES_BLOC ||
+       (size_t) (bloc->fin - bloc->pos) !=
+       2*sizeof(uint32_t)*nb_lignes + (size_t) nb_colonnes*taille_colonne)
+        return 0;
+
+    for(j=0 ; j<nb_lignes ; j++)
+    {
+        fprintf(fsortie, "%d ", (int) enregistreur_entier32(bloc->pos + 4*j));
+
+        for(i=0 ; i<nb_colonnes ; i++)
+        {
+            const unsigned char * colonne =
+                bloc->pos + 2*sizeof(uint32_t)*nb_lignes + i*taille_colonne;
+
+            if(colonne[j])
+                fprintf(fsortie, "%d ",
+                        (int) enregistreur_entier32(colonne + nb_lignes + 4*j));
+            else
+                fprintf(fsortie, "0");
+        }
+
+        fprintf(fsortie, "\n");
+    }
+
+    return !ferror(fsortie);
+}
+
+//---------------------------------------------------------------------
+// relit un entier de 32 bits écrit en petit-boutiste
+static uint32_t enregistreur_entier32(const unsigned char * octets)
+{
+    LECTURE_BINAIRE lecture = {octets, octets + 4, false};
+
+    return binaire_lire_entier32(&lecture);
+}
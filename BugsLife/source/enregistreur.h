@@ -0,0 +1,45 @@
+/*!
+ \file enregistreur.h
+ \brief Module qui enregistre l'évolution des fourmilières en blocs
+  binaires rangés par colonnes, écrits en arrière-plan, et qui les
+  exporte au format texte de gnuplot
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef ENREGISTREUR_H
+#define ENREGISTREUR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct Enregistreur ENREGISTREUR;
+
+//---------------------------------------------------------------------
+// crée le fichier d'enregistrement et lance son fil d'écriture
+ENREGISTREUR * enregistreur_creer(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// écrit le dernier bloc, arrête le fil d'écriture et ferme le fichier ;
+// renvoie 0 si une écriture a échoué
+bool enregistreur_detruire(ENREGISTREUR * enregistreur);
+
+//---------------------------------------------------------------------
+// commence la ligne d'une mise à jour ; toutes les fourmilières sont
+// absentes jusqu'à ce que enregistreur_colonie les remplisse
+void enregistreur_ligne(ENREGISTREUR * enregistreur, uint32_t nb_update,
+                        int nb_colonnes, int nb_nourriture);
+
+//---------------------------------------------------------------------
+// remplit la colonne de la fourmilière indice dans la ligne en cours
+void enregistreur_colonie(ENREGISTREUR * enregistreur, int indice, int nbF,
+                          int nbO, int nbG, float total_food);
+
+//---------------------------------------------------------------------
+// réécrit un enregistrement au format texte de gnuplot : une ligne par
+// mise à jour avec la nourriture de chaque fourmilière
+bool enregistreur_exporter_gnuplot(const char * nom_enregistrement,
+                                   const char * nom_gnuplot);
+
+#endif
@@ -14,8 +14,21 @@
 #include "error.h"
 #include "utilitaire.h"
 #include "graphic.h"
+#include "couleur.h"
+#include "arbre_kd.h"
+#include "grille.h"
+#include "memoire.h"
+#include "compteur.h"
 #include "fourmi.h"
 
+#define NB_CANDIDATS 8 // nourritures candidates par ouvrière libre
+#define TAILLE_CELLULE_OUVRIERE 2.
+// indice_o, indice_f, age, posx, posy, butx, buty, bool_nourriture,
+// bool_contact, but_en_cache, but_affecte, mort
+#define TAILLE_BINAIRE_OUVRIERE (3*4 + 4*8 + 2*4 + 3*1)
+// indice_g, indice_f, age, x, y, butx, buty, bool_contact, mort
+#define TAILLE_BINAIRE_GARDE (3*4 + 4*8 + 4 + 1)
+
 /*---------------------------------------------------------------------
  Structure de données d'une fourmi ouvrière
 	indice_o : indice de l'ouvrière
@@ -27,8 +40,27 @@
                       nourriture ou non
 	bool_contact : booléen qui indique si l'ouvrière est en collision
                    avec une autre fourmi ou pas
+	but_en_cache : booléen qui indique si le but est une nourriture
+                   choisie lors d'une mise à jour précédente, dont la
+                   distance borne la recherche suivante (seulement si
+                   cache_but est activé)
+	indexee : booléen qui indique si l'ouvrière est dans les grilles des
+              buts et des positions (seulement si cache_but est activé)
+	index_butx, index_buty, index_posx, index_posy : but et position
+                                                     sous lesquels elle
+                                                     y a été rangée
+	but_affecte : booléen qui indique si l'affectation par lot a donné
+                  une nourriture pour but à l'ouvrière lors de cette mise
+                  à jour (seulement si affectation_lot est activé)
+	mort : booléen qui indique si l'ouvrière est morte pendant la mise à
+           jour et doit être retirée de la liste au compactage
+	trace : identifiant et dernière position enregistrée
 	suivant : pointeur de type structure Ouvriere qui pointe sur
               l'ouvrière suivante de la liste chainée
+	precedent : ouvrière précédente de la liste chainée, pour la retirer
+                en temps constant
+	suivant_fourmiliere : ouvrière suivante de la même fourmilière, dans
+                          l'ordre de la liste chainée
  ----------------------------------------------------------------------*/
 struct Ouvriere
 {
@@ -41,7 +73,18 @@ struct Ouvriere
     double buty;
     int bool_nourriture;
     int bool_contact;
+    bool but_en_cache;
+    bool but_affecte;
+    bool mort;
+    bool indexee;
+    double index_butx;
+    double index_buty;
+    double index_posx;
+    double index_posy;
+    TRACE trace;
     OUVRIERE * suivant;
+    OUVRIERE * precedent;
+    OUVRIERE * suivant_fourmiliere;
 };
 
 /*---------------------------------------------------------------------
@@ -53,8 +96,15 @@ struct Ouvriere
 	butx, buty : coordonnées du but de la garde
 	bool_contact : booléen qui indique si la garde est en collision
                    avec une autre ouvrière ou pas
+	mort : booléen qui indique si la garde est morte pendant la mise à
+           jour et doit être retirée de la liste au compactage
+	trace : identifiant et dernière position enregistrée
 	suivant : pointeur de type structure Garde qui pointe sur la
               garde suivante de la liste chainée
+	precedent : garde précédente de la liste chainée, pour la retirer en
+                temps constant
+	suivant_fourmiliere : garde suivante de la même fourmilière, dans
+                          l'ordre de la liste chainée
  ----------------------------------------------------------------------*/
 struct Garde
 {
@@ -66,14 +116,91 @@ struct Garde
     double butx;
     double buty;
     int bool_contact;
+    bool mort;
+    TRACE trace;
     GARDE * suivant;
+    GARDE * precedent;
+    GARDE * suivant_fourmiliere;
 };
 
 static OUVRIERE * tete_ouvriere = NULL;
 static GARDE * tete_garde = NULL;
+static POOL * pool_ouvriere = NULL;
+static POOL * pool_garde = NULL;
 
 static int last_o, last_g; // dernier indice attribué
 
+static TRAJECTOIRE * trajectoire = NULL; // trajectoires (désactivées)
+
+static bool cache_but = true; // réutilisation du but choisi (activée)
+// ouvrières rangées par but et par position si cache_but est activé :
+// les grilles suivent chaque changement de but, chaque déplacement et
+// chaque ouvrière retirée au compactage
+static GRILLE * grille_but = NULL;
+static GRILLE * grille_position = NULL;
+static int nb_indexees = 0;
+
+/*---------------------------------------------------------------------
+ Structure de données des fourmis d'une fourmilière, chainées par
+ suivant_fourmiliere ; refaite au début de chaque mise à jour
+	tete_ouvriere, queue_ouvriere : première et dernière ouvrières
+	tete_garde, queue_garde : première et dernière gardes
+ ----------------------------------------------------------------------*/
+typedef struct Chaine CHAINE;
+struct Chaine
+{
+    OUVRIERE * tete_ouvriere;
+    OUVRIERE * queue_ouvriere;
+    GARDE * tete_garde;
+    GARDE * queue_garde;
+};
+
+// chaine des fourmis de chaque fourmilière, par indice_f
+static CHAINE * tab_chaines = NULL;
+static int nb_chaines = 0;
+static int taille_tab_chaines = 0;
+
+/*---------------------------------------------------------------------
+ Structure de données d'une affectation possible entre une ouvrière libre
+ et une nourriture
+	distance : distance entre l'ouvrière et la nourriture
+	ouvriere : ouvrière libre
+	nourriture : rang de la nourriture dans l'arbre des nourritures
+ ----------------------------------------------------------------------*/
+typedef struct Candidat CANDIDAT;
+struct Candidat
+{
+    double distance;
+    OUVRIERE * ouvriere;
+    int nourriture;
+};
+
+static bool affectation_lot = false; // affectation par lot (désactivée)
+// arbres et marques construits une fois par mise à jour
+static bool lot_a_jour = false;
+static ARBRE_KD * arbre_ouvriere = NULL; // positions au début du tick
+static POINT_KD * tab_points_ouvriere = NULL;
+static int taille_points_ouvriere = 0;
+static ARBRE_KD * arbre_nourriture = NULL; // nourritures au début du tick
+static CANDIDAT * tab_candidats = NULL;
+static int taille_candidats = 0;
+// nourritures les plus proches d'une ouvrière, et ouvrières sans
+// nourriture dont la recherche doit être élargie
+static int * tab_indices_lot = NULL;
+static double * tab_distances_lot = NULL;
+static int taille_indices_lot = 0, taille_distances_lot = 0;
+static OUVRIERE ** tab_a_elargir = NULL;
+static int taille_a_elargir = 0;
+// indice_f + 1 de la dernière fourmilière qui a pris chaque nourriture
+static unsigned * tab_nourriture_prise = NULL;
+static int taille_nourriture_prise = 0;
+
+// positions où les ouvrières mortes pendant la mise à jour lâchent leur
+// nourriture, déposées en une fois au compactage
+static double * tab_depot_x = NULL;
+static double * tab_depot_y = NULL;
+static int taille_depot_x = 0, taille_depot_y = 0;
+
 static bool paix = true; 
 /* paix = true : etat lorsque l'ouvriere peut aller chercher des nourritures
  * paix = false : etat lorsque l'ouvriere n'a pas en vue de nourritures qui 
@@ -81,14 +208,64 @@ static bool paix = true;
  * elle attaque dans la fourmiliere la plus proche qui a de la nourriture
 */ 
 
-bool fourmi_ouvriere_lecture(char tab[MAX_LINE], int o, int f)
+//---------------------------------------------------------------------
+// retourne la chaine des fourmis de la fourmilière, agrandit le tableau
+// des chaines si nécessaire ; NULL en cas de problème de mémoire
+static CHAINE * fourmi_chaine(unsigned indice_f);
+
+//---------------------------------------------------------------------
+// retourne la chaine de la fourmilière si elle a déjà des fourmis, NULL
+// sinon
+static CHAINE * fourmi_chaine_existante(unsigned indice_f);
+
+//---------------------------------------------------------------------
+// vide la chaine
+static void fourmi_chaine_vider(CHAINE * chaine);
+
+//---------------------------------------------------------------------
+// refait la chaine de chaque fourmilière dans l'ordre des listes
+static void fourmi_chainer(void);
+
+//---------------------------------------------------------------------
+// construit les arbres des ouvrières et des nourritures et efface les
+// marques des nourritures prises pour la mise à jour en cours
+static void fourmi_preparer_lot(void);
+
+//---------------------------------------------------------------------
+// ajoute aux candidats les nourritures qui conviennent parmi les
+// nb_voulus plus proches de l'ouvrière ; *pelargir est vrai s'il en
+// reste de plus lointaines ; renvoie 0 en cas de problème de mémoire
+static bool fourmi_proposer(OUVRIERE * ouvriere, unsigned indice_f,
+                            int nb_voulus, int * pnb_candidats,
+                            bool * pelargir);
+
+//---------------------------------------------------------------------
+// apparie les candidats : les paires les plus courtes d'abord, sans
+// reprendre une ouvrière affectée ni une nourriture déjà prise
+static void fourmi_apparier(unsigned indice_f, int nb_candidats);
+
+//---------------------------------------------------------------------
+// crée les grilles des buts et des positions si cache_but est activé ;
+// renvoie 0 si elles ne servent pas ou en cas de problème de mémoire
+static bool fourmi_creer_grilles(void);
+
+//---------------------------------------------------------------------
+// range l'ouvrière dans les grilles sous son but et sa position actuels,
+// si cache_but est activé
+static void fourmi_ouvriere_indexer(OUVRIERE * ouvriere);
+
+//---------------------------------------------------------------------
+// retire l'ouvrière des grilles où elle est rangée
+static void fourmi_ouvriere_desindexer(OUVRIERE * ouvriere);
+
+bool fourmi_ouvriere_lecture(CURSEUR * ligne, int o, int f)
 {
     int nb_caract, bool_nourriture;
     unsigned age;
     double posx, posy, butx, buty;
     
-    nb_caract = sscanf(tab, " %u %lf %lf %lf %lf %d", &age, &posx, &posy, &butx, 
-					   &buty, &bool_nourriture);
+    nb_caract = lecteur_scanner(ligne, " %u %lf %lf %lf %lf %d", &age, &posx, 
+                                &posy, &butx, &buty, &bool_nourriture);
     
     fourmi_ouvriere_ajouter();
     
@@ -101,6 +278,11 @@ bool fourmi_ouvriere_lecture(char tab[MAX_LINE], int o, int f)
     tete_ouvriere->buty = buty;
     tete_ouvriere->bool_nourriture = bool_nourriture;
     tete_ouvriere->bool_contact = false;
+    tete_ouvriere->but_en_cache = false;
+    tete_ouvriere->but_affecte = false;
+    tete_ouvriere->mort = false;
+    tete_ouvriere->indexee = false;
+    fourmi_ouvriere_indexer(tete_ouvriere);
     
     last_o = o;
     
@@ -110,13 +292,44 @@ bool fourmi_ouvriere_lecture(char tab[MAX_LINE], int o, int f)
 void fourmi_ouvriere_ajouter()
 {
     OUVRIERE * nouveau = NULL;
-    if(!(nouveau = (OUVRIERE *) malloc (sizeof(OUVRIERE))))
+    
+    if(!pool_ouvriere)
+        pool_ouvriere = memoire_pool_creer(sizeof(OUVRIERE), 
+                                           memoire_arene_scenario());
+    if(!pool_ouvriere || 
+       !(nouveau = (OUVRIERE *) memoire_pool_prendre(pool_ouvriere)))
         printf("Probleme de mémoire dans la fonction %s\n", __func__);
     
+    trajectoire_trace_initialiser(&nouveau->trace);
+    nouveau->precedent = NULL;
     nouveau->suivant = tete_ouvriere;
+    if(tete_ouvriere)
+        tete_ouvriere->precedent = nouveau;
     tete_ouvriere = nouveau;
 }
 
+void fourmi_ouvriere_reserver(int nb)
+{
+    if(!pool_ouvriere)
+        pool_ouvriere = memoire_pool_creer(sizeof(OUVRIERE), 
+                                           memoire_arene_scenario());
+    if(pool_ouvriere)
+        memoire_pool_reserver(pool_ouvriere, nb);
+    
+    //la place de la nourriture lâchée si elles meurent pendant la même
+    //mise à jour, et leurs cellules dans les grilles des buts et des
+    //positions
+    memoire_reserver((void **) &tab_depot_x, &taille_depot_x, nb, 
+                     sizeof(double));
+    memoire_reserver((void **) &tab_depot_y, &taille_depot_y, nb, 
+                     sizeof(double));
+    if(fourmi_creer_grilles())
+    {
+        grille_reserver(grille_but, nb);
+        grille_reserver(grille_position, nb);
+    }
+}
+
 bool fourmi_ouvriere_erreur(int nb_caract, int f, int o, unsigned age,
                             double posx, double posy)
 {
@@ -140,11 +353,10 @@ bool fourmi_ouvriere_erreur(int nb_caract, int f, int o, unsigned age,
     return 1;
 }
 
-bool fourmi_garde_lecture(char tab[MAX_LINE], int f, int * pg, int nbG,
+bool fourmi_garde_lecture(CURSEUR * ligne, int f, int * pg, int nbG,
                           double centre_x, double centre_y,
                           double rayon_fourmiliere, bool * pfin_ligne)
 {
-    char * deb = tab, * fin = NULL;
     int g;
     unsigned age;
     double x, y;
@@ -155,7 +367,8 @@ bool fourmi_garde_lecture(char tab[MAX_LINE], int f, int * pg, int nbG,
     
     for(g=*pg; g < nbG ; g++)
     {
-        if(sscanf(deb, "%u %lf %lf", &age, &x, &y) < 3)
+        //le curseur avance sur la ligne à chaque garde lue
+        if(lecteur_scanner(ligne, "%u %lf %lf", &age, &x, &y) < 3)
         {
             *pg = g;
             *pfin_ligne = true;
@@ -170,19 +383,13 @@ bool fourmi_garde_lecture(char tab[MAX_LINE], int f, int * pg, int nbG,
         tete_garde->x = x;
         tete_garde->y = y;
         tete_garde->bool_contact = false;
+        tete_garde->mort = false;
         tete_garde->butx = centre_x;
         tete_garde->buty = centre_y;
         
         if(!fourmi_garde_erreur(f, g, age, x, y, centre_x, centre_y, 
 								rayon_fourmiliere))
             return 0;
-        
-        int m;
-        for(m = 0; m < 3; m++)
-        {
-            strtod(deb, &fin);
-            deb = fin;
-        }
     }
     
     last_g = g;
@@ -193,13 +400,28 @@ bool fourmi_garde_lecture(char tab[MAX_LINE], int f, int * pg, int nbG,
 void fourmi_garde_ajouter()
 {
     GARDE * nouveau = NULL;
-    if(!(nouveau = (GARDE *) malloc (sizeof(GARDE))))
+    
+    if(!pool_garde)
+        pool_garde = memoire_pool_creer(sizeof(GARDE), memoire_arene_scenario());
+    if(!pool_garde || !(nouveau = (GARDE *) memoire_pool_prendre(pool_garde)))
         printf("Probleme de mémoire dans la fonction %s\n", __func__);
     
+    trajectoire_trace_initialiser(&nouveau->trace);
+    nouveau->precedent = NULL;
     nouveau->suivant = tete_garde;
+    if(tete_garde)
+        tete_garde->precedent = nouveau;
     tete_garde = nouveau;
 }
 
+void fourmi_garde_reserver(int nb)
+{
+    if(!pool_garde)
+        pool_garde = memoire_pool_creer(sizeof(GARDE), memoire_arene_scenario());
+    if(pool_garde)
+        memoire_pool_reserver(pool_garde, nb);
+}
+
 bool fourmi_garde_erreur(int f, int g, unsigned age, double x, double y,
                          double centre_x, double centre_y, double rayon_fourmiliere)
 {
@@ -274,7 +496,8 @@ void fourmi_ouvriere_dessine(void)
     while(courant)
     {
         graphic_draw_circle(courant->posx, courant->posy, RAYON_FOURMI, 
-							GRAPHIC_EMPTY, courant->indice_f);
+							GRAPHIC_EMPTY, 
+							couleur_fourmiliere(courant->indice_f));
         if(courant->bool_nourriture)
             graphic_draw_circle(courant->posx, courant->posy, RAYON_FOOD, 
 								GRAPHIC_EMPTY, NOIR);
@@ -289,7 +512,7 @@ void fourmi_garde_dessine(void)
     while(courant)
     {
         graphic_draw_circle(courant->x, courant->y, RAYON_FOURMI, GRAPHIC_FILLED,
-                            courant->indice_f);
+                            couleur_fourmiliere(courant->indice_f));
         graphic_draw_circle(courant->x, courant->y, RAYON_FOURMI, GRAPHIC_EMPTY, 
 							NOIR);
         courant = courant->suivant;
@@ -302,130 +525,177 @@ void fourmi_vider(void)
     fourmi_garde_vider();
 
     paix = true;
+    //sans fourmi d'un genre dans le prochain scénario, son dernier indice
+    //resterait celui de l'ancien
+    last_o = 0;
+    last_g = 0;
 }
 
 void fourmi_ouvriere_vider(void)
 {
-    OUVRIERE * a_retirer = NULL;
-    
-    while(tete_ouvriere)
-    {
-        a_retirer = tete_ouvriere;
-        tete_ouvriere = tete_ouvriere->suivant;
-        free(a_retirer);
-        a_retirer = NULL;
-    }
-    
+    //les ouvrières sont rendues toutes ensemble avec leur réserve
     tete_ouvriere = NULL;
+    nb_chaines = 0;
+    if(pool_ouvriere)
+        memoire_pool_vider(pool_ouvriere);
+    
+    if(grille_but)
+        grille_vider(grille_but);
+    if(grille_position)
+        grille_vider(grille_position);
+    nb_indexees = 0;
 }
 
 void fourmi_garde_vider(void)
 {
-    GARDE * a_retirer = NULL;
-    
-    while(tete_garde)
-    {
-        a_retirer = tete_garde;
-        tete_garde = tete_garde->suivant;
-        free(a_retirer);
-        a_retirer = NULL;
-    }
-    
     tete_garde = NULL;
+    nb_chaines = 0;
+    if(pool_garde)
+        memoire_pool_vider(pool_garde);
 }
 
 int fourmi_ouvriere_update(unsigned indice_f, int * pnourriture_rapportee,
                            int centre_x, int centre_y)
 {
-    OUVRIERE * a_tester = tete_ouvriere, * precedent = NULL;
+    CHAINE * chaine = fourmi_chaine_existante(indice_f);
+    OUVRIERE * a_tester = chaine ? chaine->tete_ouvriere : NULL;
     int compteur_o = 0;
     
+    if(affectation_lot)
+        fourmi_affectation_lot(indice_f);
+    
+    //seules les ouvrières de la fourmilière sont parcourues, dans l'ordre
+    //de la liste
     while(a_tester)
     {
-        if(a_tester->indice_f == indice_f)
+        a_tester->age++;
+        if(a_tester->age >= BUG_LIFE) //Si trop vieille, elle meurt de vieillesse
         {
-            a_tester->age++;
-            if(a_tester->age >= BUG_LIFE) //Si trop vieille, elle meurt de vieillesse
-            {
-                fourmi_ouvriere_dead(a_tester, precedent, &compteur_o);
-                a_tester = precedent;
-                break;
-            }           
-            
-            fourmi_ouvriere_update_pos(a_tester);
-            
-            if(!(a_tester->bool_nourriture)) //Chemin de l'aller
-            {
-				fourmi_ouvriere_bon_choix_aller(a_tester, indice_f, centre_x, 
-												centre_y);
-				
-				if(paix)
+            fourmi_ouvriere_dead(a_tester, &compteur_o);
+            a_tester = a_tester->suivant_fourmiliere;
+            continue;
+        }           
+        
+        fourmi_ouvriere_update_pos(a_tester);
+        
+        if(!(a_tester->bool_nourriture)) //Chemin de l'aller
+        {
+			fourmi_ouvriere_bon_choix_aller(a_tester, indice_f, centre_x, 
+											centre_y);
+			
+			if(paix)
+			{
+				if(nourriture_manger(a_tester->posx, a_tester->posy))
 				{
-					if(nourriture_manger(a_tester->posx, a_tester->posy))
-					{
-						a_tester->bool_nourriture= true; //Chemin du retour
-						fourmi_ouvriere_bon_choix_retour(a_tester, centre_x, 
-														 centre_y);
-					}
+					a_tester->bool_nourriture= true; //Chemin du retour
+					a_tester->but_en_cache = false;
+					fourmi_ouvriere_bon_choix_retour(a_tester, centre_x, 
+													 centre_y);
 				}
-				else //etat de guerre
-					a_tester->bool_nourriture = fourmiliere_manger(a_tester->posx, 
-																   a_tester->posy, 
-																   indice_f); 
-            }
-            else // si nourriture en possession, on la rapporte pour le retour
-                fourmi_ouvriere_bon_choix_retour(a_tester, centre_x, centre_y);
-            
-            fourmi_ouvriere_collision(a_tester);
-            
-            if(a_tester->bool_nourriture &&
-               (utilitaire_calcul_norme(a_tester->posx, centre_x,
-                                        a_tester->posy, centre_y) < RAYON_FOURMI))
-            {
-                a_tester->bool_nourriture = false;
-                (*pnourriture_rapportee)++;
-            }
-            // si l'ouvriere est revenue au centre de la fourmiliere
-            // elle dépose la nourriture
-            
-            if(a_tester->bool_contact)
-            {
-                fourmi_ouvriere_dead(a_tester, precedent, &compteur_o);
-                a_tester = precedent;
-                break;
-            }
+			}
+			else //etat de guerre
+				a_tester->bool_nourriture = fourmiliere_manger(a_tester->posx, 
+															   a_tester->posy, 
+															   indice_f); 
         }
-        precedent = a_tester;
-        a_tester = a_tester->suivant;
+        else // si nourriture en possession, on la rapporte pour le retour
+            fourmi_ouvriere_bon_choix_retour(a_tester, centre_x, centre_y);
+        
+        //les suivantes voient son nouveau but et sa nouvelle position
+        fourmi_ouvriere_indexer(a_tester);
+        fourmi_ouvriere_collision(a_tester);
+        
+        if(a_tester->bool_nourriture &&
+           (utilitaire_calcul_norme(a_tester->posx, centre_x,
+                                    a_tester->posy, centre_y) < RAYON_FOURMI))
+        {
+            a_tester->bool_nourriture = false;
+            (*pnourriture_rapportee)++;
+        }
+        // si l'ouvriere est revenue au centre de la fourmiliere
+        // elle dépose la nourriture
+        
+        if(a_tester->bool_contact)
+            fourmi_ouvriere_dead(a_tester, &compteur_o);
+        a_tester = a_tester->suivant_fourmiliere;
     }
     
+    if(compteur_o)
+        fourmi_ouvriere_compacter(indice_f);
+    
     return compteur_o;
 }
 
-void fourmi_ouvriere_dead(OUVRIERE * a_tester, OUVRIERE * precedent,
-                          int * pcompteur_o)
+void fourmi_ouvriere_dead(OUVRIERE * a_tester, int * pcompteur_o)
 {
-    if(a_tester->bool_nourriture)
-        nourriture_update_ouvriere_dead(a_tester->posx, a_tester->posy);
-				
-    if(a_tester == tete_ouvriere)
-        tete_ouvriere = tete_ouvriere->suivant;
-    else
-        precedent->suivant = a_tester->suivant;
-    
-    if(a_tester)
-		free(a_tester);
-    a_tester = NULL;
+    a_tester->mort = true;
     (*pcompteur_o)++;
 }
 
+void fourmi_ouvriere_compacter(unsigned indice_f)
+{
+    CHAINE * chaine = fourmi_chaine_existante(indice_f);
+    OUVRIERE ** pcourant = NULL, * morte = NULL, * precedente = NULL;
+    int nb_depots = 0;
+    
+    if(!chaine)
+        return;
+    
+    //les mortes sont cherchées parmi les seules ouvrières de la fourmilière
+    //et retirées de la liste en temps constant
+    pcourant = &chaine->tete_ouvriere;
+    while(*pcourant)
+    {
+        if(!(*pcourant)->mort)
+        {
+            precedente = *pcourant;
+            pcourant = &(*pcourant)->suivant_fourmiliere;
+            continue;
+        }
+        
+        morte = *pcourant;
+        *pcourant = morte->suivant_fourmiliere;
+        if(chaine->queue_ouvriere == morte)
+            chaine->queue_ouvriere = precedente;
+        
+        if(morte->precedent)
+            morte->precedent->suivant = morte->suivant;
+        else
+            tete_ouvriere = morte->suivant;
+        if(morte->suivant)
+            morte->suivant->precedent = morte->precedent;
+        
+        if(trajectoire)
+            trajectoire_retirer(trajectoire, &morte->trace);
+        fourmi_ouvriere_desindexer(morte);
+        
+        if(morte->bool_nourriture &&
+           memoire_reserver((void **) &tab_depot_x, &taille_depot_x, 
+                            nb_depots + 1, sizeof(double)) &&
+           memoire_reserver((void **) &tab_depot_y, &taille_depot_y, 
+                            nb_depots + 1, sizeof(double)))
+        {
+            tab_depot_x[nb_depots] = morte->posx;
+            tab_depot_y[nb_depots] = morte->posy;
+            nb_depots++;
+        }
+        
+        memoire_pool_rendre(pool_ouvriere, morte);
+    }
+    
+    if(nb_depots)
+        nourriture_update_ouvriere_dead(tab_depot_x, tab_depot_y, nb_depots);
+}
+
 void fourmi_ouvriere_collision(OUVRIERE * ouvriere)
 {
     OUVRIERE * ocomparee = ouvriere->suivant;
     GARDE * gcomparee = tete_garde;
     
+    COMPTER(COMPTEUR_OUVRIERE_COLLISION);
     while(ocomparee)
     {
+        COMPTER(COMPTEUR_COLLISION_TESTEE);
         if(ouvriere->indice_f != ocomparee->indice_f &&
            utilitaire_contact(ouvriere->posx, ocomparee->posx,
                               ouvriere->posy, ocomparee->posy, RAYON_FOURMI, 
@@ -440,6 +710,7 @@ void fourmi_ouvriere_collision(OUVRIERE * ouvriere)
     
     while(gcomparee)
     {
+        COMPTER(COMPTEUR_COLLISION_TESTEE);
         if(ouvriere->indice_f != gcomparee->indice_f &&
            utilitaire_contact(ouvriere->posx, gcomparee->x,
                               ouvriere->posy, gcomparee->y, RAYON_FOURMI, 
@@ -453,62 +724,95 @@ void fourmi_ouvriere_collision(OUVRIERE * ouvriere)
     }
 }
 
+OUVRIERE * fourmi_get_tete_ouvriere(void)
+{
+    return tete_ouvriere;
+}
+
 int fourmi_garde_update(unsigned indice_f, double centre_x,
                         double centre_y, double rayon_fourmiliere)
 {
-    GARDE * a_tester = tete_garde, * precedent = NULL;
+    CHAINE * chaine = fourmi_chaine_existante(indice_f);
+    GARDE * a_tester = chaine ? chaine->tete_garde : NULL;
     int compteur_g = 0;
     while(a_tester)
     {
-        if(a_tester->indice_f == indice_f)
+        a_tester->age++;
+        if(a_tester->age >= BUG_LIFE)//Si trop vieille, elle meurt de vieillesse
         {
-            a_tester->age++;
-            if(a_tester->age >= BUG_LIFE)//Si trop vieille, elle meurt de vieillesse
-            {
-                fourmi_garde_dead(a_tester, precedent, &compteur_g);
-                a_tester = precedent;
-                break;
-            }
-            
-            fourmi_garde_update_but(indice_f, centre_x, centre_y,
-                                    rayon_fourmiliere, a_tester);
-            fourmi_garde_update_pos(a_tester);
-            
-            fourmi_garde_collision(a_tester);
-            
-            if(a_tester->bool_contact)
-            {
-                fourmi_garde_dead(a_tester, precedent, &compteur_g);
-                a_tester = precedent;
-                break;
-            }
+            fourmi_garde_dead(a_tester, &compteur_g);
+            a_tester = a_tester->suivant_fourmiliere;
+            continue;
         }
         
-        precedent = a_tester;
-        a_tester = a_tester->suivant;
+        fourmi_garde_update_but(indice_f, centre_x, centre_y,
+                                rayon_fourmiliere, a_tester);
+        fourmi_garde_update_pos(a_tester);
+        
+        fourmi_garde_collision(a_tester);
+        
+        if(a_tester->bool_contact)
+            fourmi_garde_dead(a_tester, &compteur_g);
+        
+        a_tester = a_tester->suivant_fourmiliere;
     }
     
+    if(compteur_g)
+        fourmi_garde_compacter(indice_f);
+    
     return compteur_g;
 }
 
-void fourmi_garde_dead(GARDE * a_tester, GARDE * precedent, int * pcompteur_g)
+void fourmi_garde_dead(GARDE * a_tester, int * pcompteur_g)
 {
-    if(a_tester == tete_garde)
-        tete_garde = tete_garde->suivant;
-    else
-        precedent->suivant = a_tester->suivant;
-    
-    free(a_tester);
-    a_tester = NULL;
+    a_tester->mort = true;
     (*pcompteur_g)++;
 }
 
+void fourmi_garde_compacter(unsigned indice_f)
+{
+    CHAINE * chaine = fourmi_chaine_existante(indice_f);
+    GARDE ** pcourant = NULL, * morte = NULL, * precedente = NULL;
+    
+    if(!chaine)
+        return;
+    
+    pcourant = &chaine->tete_garde;
+    while(*pcourant)
+    {
+        if(!(*pcourant)->mort)
+        {
+            precedente = *pcourant;
+            pcourant = &(*pcourant)->suivant_fourmiliere;
+            continue;
+        }
+        
+        morte = *pcourant;
+        *pcourant = morte->suivant_fourmiliere;
+        if(chaine->queue_garde == morte)
+            chaine->queue_garde = precedente;
+        
+        if(morte->precedent)
+            morte->precedent->suivant = morte->suivant;
+        else
+            tete_garde = morte->suivant;
+        if(morte->suivant)
+            morte->suivant->precedent = morte->precedent;
+        
+        if(trajectoire)
+            trajectoire_retirer(trajectoire, &morte->trace);
+        
+        memoire_pool_rendre(pool_garde, morte);
+    }
+}
+
 void fourmi_garde_collision(GARDE * garde)
 {
     OUVRIERE * ocomparee = tete_ouvriere;
     
     while(ocomparee)
     {
+        COMPTER(COMPTEUR_COLLISION_TESTEE);
         if(garde->indice_f != ocomparee->indice_f &&
            utilitaire_contact(garde->x, ocomparee->posx,
                               garde->y, ocomparee->posy, RAYON_FOURMI, 
@@ -524,18 +828,38 @@ void fourmi_garde_collision(GARDE * garde)
 
 void fourmi_ouvriere_naissance(double centre_x, double centre_y, unsigned indice_f)
 {
+    CHAINE * chaine = NULL;
+    
     last_o++;
     tete_ouvriere->indice_o = last_o;
     tete_ouvriere->indice_f = indice_f;
     tete_ouvriere->age = 0;
     tete_ouvriere->posx = centre_x;
     tete_ouvriere->posy = centre_y;
+    tete_ouvriere->butx = centre_x;
+    tete_ouvriere->buty = centre_y;
     tete_ouvriere->bool_nourriture = false;
     tete_ouvriere->bool_contact = false;
+    tete_ouvriere->but_en_cache = false;
+    tete_ouvriere->but_affecte = false;
+    tete_ouvriere->mort = false;
+    tete_ouvriere->indexee = false;
+    fourmi_ouvriere_indexer(tete_ouvriere);
+    
+    //la nouvelle ouvrière est aussi en tête de sa fourmilière
+    if((chaine = fourmi_chaine(indice_f)))
+    {
+        tete_ouvriere->suivant_fourmiliere = chaine->tete_ouvriere;
+        chaine->tete_ouvriere = tete_ouvriere;
+        if(!chaine->queue_ouvriere)
+            chaine->queue_ouvriere = tete_ouvriere;
+    }
 }
 
 void fourmi_garde_naissance(double x, double y, unsigned indice_f)
 {
+    CHAINE * chaine = NULL;
+    
     last_g++;
     tete_garde->indice_g = last_g;
     tete_garde->indice_f = indice_f;
@@ -543,6 +867,16 @@ void fourmi_garde_naissance(double x, double y, unsigned indice_f)
     tete_garde->x = x;
     tete_garde->y = y;
     tete_garde->bool_contact = false;
+    tete_garde->mort = false;
+    
+    //la nouvelle garde est aussi en tête de sa fourmilière
+    if((chaine = fourmi_chaine(indice_f)))
+    {
+        tete_garde->suivant_fourmiliere = chaine->tete_garde;
+        chaine->tete_garde = tete_garde;
+        if(!chaine->queue_garde)
+            chaine->queue_garde = tete_garde;
+    }
 }
 
 bool fourmi_nourriture_superposition(double nourriture_x, double nourriture_y)
@@ -565,24 +899,18 @@ bool fourmi_nourriture_superposition(double nourriture_x, double nourriture_y)
 void fourmi_ouvriere_bon_choix_aller(OUVRIERE * ouvriere, unsigned indice_f,
                                      double centre_x, double centre_y)
 {
-    double nourriture_x, nourriture_y, fourmiliere_a_attaquer_x;
-    double fourmiliere_a_attaquer_y;
+    double fourmiliere_a_attaquer_x, fourmiliere_a_attaquer_y;
     
     //Si fourmi en état de paix et se trouve dans une fourmilière étrangère, 
     //elle ne veut pas l'attaquer 
     if(paix && fourmiliere_fourmi_inside(ouvriere->posx, ouvriere->posy, indice_f))
     {
+        ouvriere->but_en_cache = false;
         ouvriere->butx = centre_x;
         ouvriere->buty = centre_y;
     }
-    else if(nourriture_la_plus_proche(ouvriere->posx, ouvriere->posy,
-                                      &nourriture_x, &nourriture_y,
-                                      ouvriere->indice_f, ouvriere->indice_o))
-    {
+    else if(fourmi_ouvriere_choix_nourriture(ouvriere))
         paix = true;
-        ouvriere->butx = nourriture_x;
-        ouvriere->buty = nourriture_y;
-    }
     else if(fourmiliere_la_plus_proche(ouvriere->posx, ouvriere->posy, indice_f, 
 									   &fourmiliere_a_attaquer_x, 
 									   &fourmiliere_a_attaquer_y))
@@ -598,14 +926,208 @@ void fourmi_ouvriere_bon_choix_aller(OUVRIERE * ouvriere, unsigned indice_f,
 	}
 }
 
+bool fourmi_ouvriere_choix_nourriture(OUVRIERE * ouvriere)
+{
+    double nourriture_x, nourriture_y;
+    
+    if(affectation_lot)
+        return ouvriere->but_affecte;
+    
+    //la nourriture choisie à la mise à jour précédente borne la recherche :
+    //si une nourriture convient encore à cette distance ou moins, la plus
+    //proche s'y trouve, sinon toutes les nourritures sont parcourues
+    if(ouvriere->but_en_cache &&
+       nourriture_la_plus_proche_bornee(ouvriere->posx, ouvriere->posy,
+                                        utilitaire_calcul_norme(ouvriere->posx,
+                                                                ouvriere->butx,
+                                                                ouvriere->posy,
+                                                                ouvriere->buty),
+                                        &nourriture_x, &nourriture_y,
+                                        ouvriere->indice_f, ouvriere->indice_o))
+    {
+        ouvriere->butx = nourriture_x;
+        ouvriere->buty = nourriture_y;
+        return 1;
+    }
+    
+    if(nourriture_la_plus_proche(ouvriere->posx, ouvriere->posy,
+                                 &nourriture_x, &nourriture_y,
+                                 ouvriere->indice_f, ouvriere->indice_o))
+    {
+        ouvriere->butx = nourriture_x;
+        ouvriere->buty = nourriture_y;
+        ouvriere->but_en_cache = cache_but;
+        return 1;
+    }
+    
+    ouvriere->but_en_cache = false;
+    return 0;
+}
+
+void fourmi_set_affectation_lot(bool actif)
+{
+    OUVRIERE * courant = tete_ouvriere;
+    
+    affectation_lot = actif;
+    lot_a_jour = false;
+    
+    while(courant)
+    {
+        courant->but_affecte = false;
+        courant = courant->suivant;
+    }
+}
+
+void fourmi_debut_update(void)
+{
+    fourmi_chainer();
+    lot_a_jour = false;
+}
+
+void fourmi_affectation_lot(unsigned indice_f)
+{
+    OUVRIERE * courant = NULL;
+    CHAINE * chaine = NULL;
+    int nb_voulus = NB_CANDIDATS, nb_candidats, nb_a_elargir = 0, i, j;
+    bool elargir;
+    
+    if(!lot_a_jour)
+        fourmi_preparer_lot();
+    if(!lot_a_jour || !(chaine = fourmi_chaine_existante(indice_f)))
+        return;
+    
+    //chaque ouvrière libre propose ses NB_CANDIDATS nourritures les plus 
+    //proches, pas encore mangées, qui respectent les conditions de la donnée
+    nb_candidats = 0;
+    for(courant = chaine->tete_ouvriere ; courant ; 
+        courant = courant->suivant_fourmiliere)
+    {
+        courant->but_affecte = false;
+        if(courant->bool_nourriture ||
+           fourmiliere_fourmi_inside(courant->posx, courant->posy, indice_f))
+            continue;
+        
+        if(!fourmi_proposer(courant, indice_f, nb_voulus, &nb_candidats,
+                            &elargir) ||
+           (elargir && !memoire_reserver((void **) &tab_a_elargir, 
+                                         &taille_a_elargir, nb_a_elargir + 1,
+                                         sizeof(OUVRIERE *))))
+            return;
+        if(elargir)
+            tab_a_elargir[nb_a_elargir++] = courant;
+    }
+    
+    while(true)
+    {
+        fourmi_apparier(indice_f, nb_candidats);
+        
+        //une ouvrière sans nourriture dont toutes les propositions ont été
+        //prises ou refusées propose les suivantes : elle ne part en guerre
+        //que s'il ne reste aucune nourriture qui lui convienne
+        nb_voulus *= 2;
+        nb_candidats = 0;
+        for(i=0, j=0 ; i<nb_a_elargir ; i++)
+        {
+            if(tab_a_elargir[i]->but_affecte)
+                continue;
+            if(!fourmi_proposer(tab_a_elargir[i], indice_f, nb_voulus,
+                                &nb_candidats, &elargir))
+                return;
+            if(elargir)
+                tab_a_elargir[j++] = tab_a_elargir[i];
+        }
+        nb_a_elargir = j;
+        if(!nb_candidats)
+            return;
+    }
+}
+
+void fourmi_construire_arbre_ouvriere(void)
+{
+    OUVRIERE * courant = tete_ouvriere;
+    int nb = 0;
+    
+    if(!arbre_ouvriere && !(arbre_ouvriere = arbre_kd_creer()))
+        return;
+    
+    while(courant)
+    {
+        if(!memoire_reserver((void **) &tab_points_ouvriere, 
+                             &taille_points_ouvriere, nb + 1, sizeof(POINT_KD)))
+            break;
+        
+        tab_points_ouvriere[nb].x = courant->posx;
+        tab_points_ouvriere[nb].y = courant->posy;
+        tab_points_ouvriere[nb].indice = courant->indice_f;
+        nb++;
+        courant = courant->suivant;
+    }
+    
+    arbre_kd_construire(arbre_ouvriere, tab_points_ouvriere, nb);
+}
+
+int fourmi_compare_candidats(const void * a, const void * b)
+{
+    const CANDIDAT * c1 = (const CANDIDAT *) a, * c2 = (const CANDIDAT *) b;
+    
+    if(c1->distance != c2->distance)
+        return c1->distance < c2->distance ? -1 : 1;
+    //le rang d'une nourriture suit sa position
+    if(c1->nourriture != c2->nourriture)
+        return c1->nourriture < c2->nourriture ? -1 : 1;
+    if(c1->ouvriere->indice_o != c2->ouvriere->indice_o)
+        return c1->ouvriere->indice_o < c2->ouvriere->indice_o ? -1 : 1;
+    return (c1->ouvriere->trace.identifiant > c2->ouvriere->trace.identifiant) -
+           (c1->ouvriere->trace.identifiant < c2->ouvriere->trace.identifiant);
+}
+
+void fourmi_set_cache_but(bool actif)
+{
+    OUVRIERE * courant = NULL;
+    
+    cache_but = actif;
+    if(grille_but)
+        grille_vider(grille_but);
+    if(grille_position)
+        grille_vider(grille_position);
+    nb_indexees = 0;
+    
+    for(courant = tete_ouvriere ; courant ; courant = courant->suivant)
+    {
+        courant->but_en_cache = false;
+        courant->indexee = false;
+        fourmi_ouvriere_indexer(courant);
+    }
+}
+
 bool fourmi_nourriture_deja_prise(unsigned indice_f, unsigned indice_o,
                                   double nourriture_x, double nourriture_y)
 {
     OUVRIERE * a_tester = tete_ouvriere;
+    void ** elements = NULL;
+    int nb, k;
+    
+    COMPTER(COMPTEUR_NOURRITURE_DEJA_PRISE);
+    //seules les ouvrières dont le but est dans la cellule de la nourriture
+    //peuvent l'avoir prise
+    if(cache_but && grille_but)
+    {
+        nb = grille_cellule(grille_but, nourriture_x, nourriture_y, &elements);
+        for(k=0 ; k<nb ; k++)
+        {
+            a_tester = (OUVRIERE *) elements[k];
+            if(a_tester->indice_f == indice_f && a_tester->indice_o != indice_o
+               && !a_tester->mort && a_tester->butx == nourriture_x 
+               && a_tester->buty == nourriture_y)
+                return 1;
+        }
+        return 0;
+    }
     
     while(a_tester)
     {
         if(a_tester->indice_f == indice_f && a_tester->indice_o != indice_o
+           && !a_tester->mort
            && a_tester->butx == nourriture_x && a_tester->buty == nourriture_y)
             return 1;
         
@@ -618,6 +1140,37 @@ bool fourmi_etrangere_plus_proche(unsigned indice_f, double nourriture_x,
                                   double nourriture_y, double distance)
 {
     OUVRIERE * a_tester = tete_ouvriere;
+    void ** elements = NULL;
+    int nb, i, j, k, i_min, i_max, j_min, j_max;
+    
+    COMPTER(COMPTEUR_ETRANGERE_PLUS_PROCHE);
+    //les cellules du carré de demi-côté distance, tant qu'elles sont moins
+    //nombreuses que les ouvrières
+    if(cache_but && grille_position)
+    {
+        grille_zone(grille_position, nourriture_x, nourriture_y,
+                    distance + EPSIL_ZERO, &i_min, &i_max, &j_min, &j_max);
+        if((i_max - i_min + 1)*(j_max - j_min + 1) <= nb_indexees)
+        {
+            for(j=j_min ; j<=j_max ; j++)
+                for(i=i_min ; i<=i_max ; i++)
+                {
+                    nb = grille_cellule_indices(grille_position, i, j, 
+                                                &elements);
+                    for(k=0 ; k<nb ; k++)
+                    {
+                        a_tester = (OUVRIERE *) elements[k];
+                        if(a_tester->indice_f != indice_f &&
+                           utilitaire_calcul_norme(a_tester->posx, 
+                                                   nourriture_x, 
+                                                   a_tester->posy, 
+                                                   nourriture_y) <= distance)
+                            return 1;
+                    }
+                }
+            return 0;
+        }
+    }
     
     while(a_tester)
     {
@@ -779,3 +1332,430 @@ void fourmi_garde_ecriture(FILE * fsortie, int indice_f)
     
     fprintf(fsortie, "\n");
 }
+
+void fourmi_ouvriere_ecriture_binaire(TAMPON * tampon)
+{
+    OUVRIERE * courant = NULL;
+    uint32_t nb = 0;
+    
+    for(courant = tete_ouvriere ; courant ; courant = courant->suivant)
+        nb++;
+    
+    binaire_ecrire_entier32(tampon, last_o);
+    binaire_ecrire_booleen(tampon, paix);
+    binaire_ecrire_entier32(tampon, nb);
+    
+    for(courant = tete_ouvriere ; courant ; courant = courant->suivant)
+    {
+        binaire_ecrire_entier32(tampon, courant->indice_o);
+        binaire_ecrire_entier32(tampon, courant->indice_f);
+        binaire_ecrire_entier32(tampon, courant->age);
+        binaire_ecrire_double(tampon, courant->posx);
+        binaire_ecrire_double(tampon, courant->posy);
+        binaire_ecrire_double(tampon, courant->butx);
+        binaire_ecrire_double(tampon, courant->buty);
+        binaire_ecrire_entier32(tampon, courant->bool_nourriture);
+        binaire_ecrire_entier32(tampon, courant->bool_contact);
+        binaire_ecrire_booleen(tampon, courant->but_en_cache);
+        binaire_ecrire_booleen(tampon, courant->but_affecte);
+        binaire_ecrire_booleen(tampon, courant->mort);
+    }
+}
+
+void fourmi_garde_ecriture_binaire(TAMPON * tampon)
+{
+    GARDE * courant = NULL;
+    uint32_t nb = 0;
+    
+    for(courant = tete_garde ; courant ; courant = courant->suivant)
+        nb++;
+    
+    binaire_ecrire_entier32(tampon, last_g);
+    binaire_ecrire_entier32(tampon, nb);
+    
+    for(courant = tete_garde ; courant ; courant = courant->suivant)
+    {
+        binaire_ecrire_entier32(tampon, courant->indice_g);
+        binaire_ecrire_entier32(tampon, courant->indice_f);
+        binaire_ecrire_entier32(tampon, courant->age);
+        binaire_ecrire_double(tampon, courant->x);
+        binaire_ecrire_double(tampon, courant->y);
+        binaire_ecrire_double(tampon, courant->butx);
+        binaire_ecrire_double(tampon, courant->buty);
+        binaire_ecrire_entier32(tampon, courant->bool_contact);
+        binaire_ecrire_booleen(tampon, courant->mort);
+    }
+}
+
+bool fourmi_ouvriere_lecture_binaire(LECTURE_BINAIRE * section)
+{
+    LECTURE_BINAIRE enregistrement;
+    uint32_t nb, i;
+    
+    last_o = binaire_lire_entier32(section);
+    paix = binaire_lire_booleen(section);
+    nb = binaire_lire_entier32(section);
+    
+    if(section->erreur || 
+       (size_t) (section->fin - section->pos) != nb*TAILLE_BINAIRE_OUVRIERE)
+        return 0;
+    
+    fourmi_ouvriere_reserver(nb);
+    
+    //reprises de la dernière à la première : l'ajout en tête redonne 
+    //l'ordre de la liste
+    for(i=nb ; i-- > 0 ; )
+    {
+        binaire_enregistrement(section, i, TAILLE_BINAIRE_OUVRIERE, 
+                               &enregistrement);
+        fourmi_ouvriere_ajouter();
+        
+        tete_ouvriere->indice_o = binaire_lire_entier32(&enregistrement);
+        tete_ouvriere->indice_f = binaire_lire_entier32(&enregistrement);
+        tete_ouvriere->age = binaire_lire_entier32(&enregistrement);
+        tete_ouvriere->posx = binaire_lire_double(&enregistrement);
+        tete_ouvriere->posy = binaire_lire_double(&enregistrement);
+        tete_ouvriere->butx = binaire_lire_double(&enregistrement);
+        tete_ouvriere->buty = binaire_lire_double(&enregistrement);
+        tete_ouvriere->bool_nourriture = binaire_lire_entier32(&enregistrement);
+        tete_ouvriere->bool_contact = binaire_lire_entier32(&enregistrement);
+        tete_ouvriere->but_en_cache = binaire_lire_booleen(&enregistrement);
+        tete_ouvriere->but_affecte = binaire_lire_booleen(&enregistrement);
+        tete_ouvriere->mort = binaire_lire_booleen(&enregistrement);
+        tete_ouvriere->indexee = false;
+        fourmi_ouvriere_indexer(tete_ouvriere);
+    }
+    
+    return 1;
+}
+
+bool fourmi_garde_lecture_binaire(LECTURE_BINAIRE * section)
+{
+    LECTURE_BINAIRE enregistrement;
+    uint32_t nb, i;
+    
+    last_g = binaire_lire_entier32(section);
+    nb = binaire_lire_entier32(section);
+    
+    if(section->erreur || 
+       (size_t) (section->fin - section->pos) != nb*TAILLE_BINAIRE_GARDE)
+        return 0;
+    
+    fourmi_garde_reserver(nb);
+    
+    for(i=nb ; i-- > 0 ; )
+    {
+        binaire_enregistrement(section, i, TAILLE_BINAIRE_GARDE, &enregistrement);
+        fourmi_garde_ajouter();
+        
+        tete_garde->indice_g = binaire_lire_entier32(&enregistrement);
+        tete_garde->indice_f = binaire_lire_entier32(&enregistrement);
+        tete_garde->age = binaire_lire_entier32(&enregistrement);
+        tete_garde->x = binaire_lire_double(&enregistrement);
+        tete_garde->y = binaire_lire_double(&enregistrement);
+        tete_garde->butx = binaire_lire_double(&enregistrement);
+        tete_garde->buty = binaire_lire_double(&enregistrement);
+        tete_garde->bool_contact = binaire_lire_entier32(&enregistrement);
+        tete_garde->mort = binaire_lire_booleen(&enregistrement);
+    }
+    
+    return 1;
+}
+
+void fourmi_set_trajectoire(TRAJECTOIRE * nouvelle)
+{
+    trajectoire = nouvelle;
+}
+
+void fourmi_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter)
+{
+    OUVRIERE * ouvriere = NULL;
+    GARDE * garde = NULL;
+    uint64_t entite;
+    
+    //but_en_cache et but_affecte dépendent de la variante du moteur, pas
+    //de l'état simulé
+    for(ouvriere = tete_ouvriere ; ouvriere ; ouvriere = ouvriere->suivant)
+    {
+        entite = empreinte_entier(empreinte_debut(), ouvriere->indice_o);
+        entite = empreinte_entier(entite, ouvriere->indice_f);
+        entite = empreinte_entier(entite, ouvriere->age);
+        entite = empreinte_reel(entite, ouvriere->posx);
+        entite = empreinte_reel(entite, ouvriere->posy);
+        entite = empreinte_reel(entite, ouvriere->butx);
+        entite = empreinte_reel(entite, ouvriere->buty);
+        entite = empreinte_entier(entite, ouvriere->bool_nourriture);
+        entite = empreinte_entier(entite, ouvriere->bool_contact);
+        entite = empreinte_entier(entite, ouvriere->mort);
+        empreinte_ajouter(empreinte, EMPREINTE_OUVRIERE, ouvriere->indice_o,
+                          entite, noter);
+    }
+    
+    for(garde = tete_garde ; garde ; garde = garde->suivant)
+    {
+        entite = empreinte_entier(empreinte_debut(), garde->indice_g);
+        entite = empreinte_entier(entite, garde->indice_f);
+        entite = empreinte_entier(entite, garde->age);
+        entite = empreinte_reel(entite, garde->x);
+        entite = empreinte_reel(entite, garde->y);
+        entite = empreinte_reel(entite, garde->butx);
+        entite = empreinte_reel(entite, garde->buty);
+        entite = empreinte_entier(entite, garde->bool_contact);
+        entite = empreinte_entier(entite, garde->mort);
+        empreinte_ajouter(empreinte, EMPREINTE_GARDE, garde->indice_g,
+                          entite, noter);
+    }
+    
+    entite = empreinte_entier(empreinte_debut(), last_o);
+    entite = empreinte_entier(entite, last_g);
+    empreinte_ajouter(empreinte, EMPREINTE_COMPTEURS,
+                      EMPREINTE_COMPTEURS_FOURMI, entite, noter);
+}
+
+void fourmi_enregistrer_trajectoire(void)
+{
+    OUVRIERE * ouvriere = NULL;
+    GARDE * garde = NULL;
+    
+    if(!trajectoire)
+        return;
+    
+    for(ouvriere = tete_ouvriere ; ouvriere ; ouvriere = ouvriere->suivant)
+        trajectoire_tracer(trajectoire, &ouvriere->trace, TRAJECTOIRE_OUVRIERE,
+                           ouvriere->indice_f, ouvriere->posx, ouvriere->posy);
+    for(garde = tete_garde ; garde ; garde = garde->suivant)
+        trajectoire_tracer(trajectoire, &garde->trace, TRAJECTOIRE_GARDE, 
+                           garde->indice_f, garde->x, garde->y);
+}
+
+void fourmi_ouvriere_placer(double x, double y, unsigned indice_f)
+{
+    fourmi_ouvriere_ajouter();
+    fourmi_ouvriere_naissance(x, y, indice_f);
+}
+
+void fourmi_garde_placer(double x, double y, unsigned indice_f)
+{
+    fourmi_garde_ajouter();
+    fourmi_garde_naissance(x, y, indice_f);
+}
+
+static CHAINE * fourmi_chaine(unsigned indice_f)
+{
+    int i;
+    
+    if((int) indice_f >= nb_chaines)
+    {
+        if(!memoire_reserver((void **) &tab_chaines, &taille_tab_chaines, 
+                             indice_f + 1, sizeof(CHAINE)))
+            return NULL;
+        
+        for(i=nb_chaines ; i<=(int) indice_f ; i++)
+            fourmi_chaine_vider(&tab_chaines[i]);
+        nb_chaines = indice_f + 1;
+    }
+    
+    return &tab_chaines[indice_f];
+}
+
+static CHAINE * fourmi_chaine_existante(unsigned indice_f)
+{
+    return (int) indice_f < nb_chaines ? &tab_chaines[indice_f] : NULL;
+}
+
+static void fourmi_chaine_vider(CHAINE * chaine)
+{
+    chaine->tete_ouvriere = chaine->queue_ouvriere = NULL;
+    chaine->tete_garde = chaine->queue_garde = NULL;
+}
+
+static void fourmi_chainer(void)
+{
+    OUVRIERE * ouvriere = NULL;
+    GARDE * garde = NULL;
+    CHAINE * chaine = NULL;
+    int i;
+    
+    for(i=0 ; i<nb_chaines ; i++)
+        fourmi_chaine_vider(&tab_chaines[i]);
+    
+    for(ouvriere = tete_ouvriere ; ouvriere ; ouvriere = ouvriere->suivant)
+    {
+        if(!(chaine = fourmi_chaine(ouvriere->indice_f)))
+        {
+            printf("Problème de mémoire dans la fonction %s\n", __func__);
+            return;
+        }
+        
+        ouvriere->suivant_fourmiliere = NULL;
+        if(chaine->queue_ouvriere)
+            chaine->queue_ouvriere->suivant_fourmiliere = ouvriere;
+        else
+            chaine->tete_ouvriere = ouvriere;
+        chaine->queue_ouvriere = ouvriere;
+    }
+    
+    for(garde = tete_garde ; garde ; garde = garde->suivant)
+    {
+        if(!(chaine = fourmi_chaine(garde->indice_f)))
+        {
+            printf("Problème de mémoire dans la fonction %s\n", __func__);
+            return;
+        }
+        
+        garde->suivant_fourmiliere = NULL;
+        if(chaine->queue_garde)
+            chaine->queue_garde->suivant_fourmiliere = garde;
+        else
+            chaine->tete_garde = garde;
+        chaine->queue_garde = garde;
+    }
+}
+
+static void fourmi_preparer_lot(void)
+{
+    int nb_nourriture, i;
+    
+    fourmi_construire_arbre_ouvriere();
+    if(!arbre_ouvriere || !(arbre_nourriture = nourriture_construire_arbre()))
+        return;
+    
+    nb_nourriture = nourriture_get_nb_arbre();
+    if(!memoire_reserver((void **) &tab_nourriture_prise, 
+                         &taille_nourriture_prise, nb_nourriture, 
+                         sizeof(unsigned)))
+        return;
+    for(i=0 ; i<nb_nourriture ; i++)
+        tab_nourriture_prise[i] = 0;
+    
+    lot_a_jour = true;
+}
+
+static bool fourmi_proposer(OUVRIERE * ouvriere, unsigned indice_f,
+                            int nb_voulus, int * pnb_candidats,
+                            bool * pelargir)
+{
+    double nourriture_x, nourriture_y;
+    int n, i, etrangere;
+    
+    if(!memoire_reserver((void **) &tab_indices_lot, &taille_indices_lot,
+                         nb_voulus, sizeof(int)) ||
+       !memoire_reserver((void **) &tab_distances_lot, &taille_distances_lot,
+                         nb_voulus, sizeof(double)))
+        return 0;
+    
+    n = arbre_kd_k_plus_proches(arbre_nourriture, ouvriere->posx, 
+                                ouvriere->posy, nb_voulus, 2*DMAX, 
+                                tab_indices_lot, tab_distances_lot);
+    //moins de réponses que demandé : toutes les nourritures ont été vues
+    *pelargir = n == nb_voulus;
+    
+    for(i=0 ; i<n ; i++)
+    {
+        if(!nourriture_disponible(tab_indices_lot[i]))
+            continue;
+        nourriture_position(tab_indices_lot[i], &nourriture_x, &nourriture_y);
+        
+        //une ouvrière étrangère au moins aussi proche est prioritaire
+        if(arbre_kd_plus_proche(arbre_ouvriere, nourriture_x, nourriture_y,
+                                indice_f, 
+                                nextafter(tab_distances_lot[i], INFINITY),
+                                &etrangere)
+           || fourmiliere_sur_chemin(ouvriere->posx, nourriture_x, 
+                                     ouvriere->posy, nourriture_y, indice_f))
+            continue;
+        
+        if(!memoire_reserver((void **) &tab_candidats, &taille_candidats,
+                             *pnb_candidats + 1, sizeof(CANDIDAT)))
+            return 0;
+        tab_candidats[*pnb_candidats].distance = tab_distances_lot[i];
+        tab_candidats[*pnb_candidats].ouvriere = ouvriere;
+        tab_candidats[*pnb_candidats].nourriture = tab_indices_lot[i];
+        (*pnb_candidats)++;
+    }
+    
+    return 1;
+}
+
+static void fourmi_apparier(unsigned indice_f, int nb_candidats)
+{
+    int i;
+    
+    //appariement glouton : les paires les plus courtes d'abord, dans un 
+    //ordre total qui ne dépend pas de l'ordre des listes
+    if(nb_candidats)
+        utilitaire_trier(tab_candidats, nb_candidats, sizeof(CANDIDAT), 
+                         fourmi_compare_candidats);
+    
+    for(i=0 ; i<nb_candidats ; i++)
+    {
+        CANDIDAT * candidat = &tab_candidats[i];
+        
+        if(candidat->ouvriere->but_affecte || 
+           tab_nourriture_prise[candidat->nourriture] == indice_f + 1)
+            continue;
+        
+        tab_nourriture_prise[candidat->nourriture] = indice_f + 1;
+        candidat->ouvriere->but_affecte = true;
+        nourriture_position(candidat->nourriture, &candidat->ouvriere->butx,
+                            &candidat->ouvriere->buty);
+        fourmi_ouvriere_indexer(candidat->ouvriere);
+    }
+}
+
+static bool fourmi_creer_grilles(void)
+{
+    if(!cache_but)
+        return 0;
+    
+    if(!grille_but && 
+       !(grille_but = grille_creer(TAILLE_CELLULE_OUVRIERE, 
+                                   memoire_arene_scenario())))
+        return 0;
+    if(!grille_position && 
+       !(grille_position = grille_creer(TAILLE_CELLULE_OUVRIERE,
+                                        memoire_arene_scenario())))
+        return 0;
+    return 1;
+}
+
+static void fourmi_ouvriere_indexer(OUVRIERE * ouvriere)
+{
+    if(!fourmi_creer_grilles())
+        return;
+    
+    if(!ouvriere->indexee)
+    {
+        grille_inserer(grille_but, ouvriere, ouvriere->butx, ouvriere->buty, 
+                       0.);
+        grille_inserer(grille_position, ouvriere, ouvriere->posx, 
+                       ouvriere->posy, 0.);
+        ouvriere->indexee = true;
+        nb_indexees++;
+    }
+    else
+    {
+        grille_deplacer(grille_but, ouvriere, ouvriere->index_butx, 
+                        ouvriere->index_buty, ouvriere->butx, ouvriere->buty);
+        grille_deplacer(grille_position, ouvriere, ouvriere->index_posx, 
+                        ouvriere->index_posy, ouvriere->posx, ouvriere->posy);
+    }
+    
+    ouvriere->index_butx = ouvriere->butx;
+    ouvriere->index_buty = ouvriere->buty;
+    ouvriere->index_posx = ouvriere->posx;
+    ouvriere->index_posy = ouvriere->posy;
+}
+
+static void fourmi_ouvriere_desindexer(OUVRIERE * ouvriere)
+{
+    if(!ouvriere->indexee)
+        return;
+    
+    grille_retirer(grille_but, ouvriere, ouvriere->index_butx, 
+                   ouvriere->index_buty, 0.);
+    grille_retirer(grille_position, ouvriere, ouvriere->index_posx, 
+                   ouvriere->index_posy, 0.);
+    ouvriere->indexee = false;
+    nb_indexees--;
+}
@@ -14,6 +14,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "constantes.h"
+#include "lecteur.h"
+#include "binaire.h"
+#include "trajectoire.h"
+#include "empreinte.h"
 
 typedef struct Ouvriere OUVRIERE;
 
@@ -24,12 +28,16 @@ typedef struct Garde GARDE;
 
 //---------------------------------------------------------------------
 // mémorise les ouvrières
-bool fourmi_ouvriere_lecture(char tab[MAX_LINE], int j, int i);
+bool fourmi_ouvriere_lecture(CURSEUR * ligne, int j, int i);
 
 //---------------------------------------------------------------------
 // ajoute une ouvrière à la liste chainée
 void fourmi_ouvriere_ajouter(void);
 
+//---------------------------------------------------------------------
+// prépare la place de nb ouvrières de plus sans nouvelle allocation
+void fourmi_ouvriere_reserver(int nb);
+
 //---------------------------------------------------------------------
 // détecte les erreurs relatives aux ouvrières pour le rendu 1
 bool fourmi_ouvriere_erreur(int nb_caract, int f, int o, unsigned age,
@@ -37,7 +45,7 @@ bool fourmi_ouvriere_erreur(int nb_caract, int f, int o, unsigned age,
 
 //---------------------------------------------------------------------
 // mémorise les gardes
-bool fourmi_garde_lecture(char tab[MAX_LINE], int f, int * pg, int nbG,
+bool fourmi_garde_lecture(CURSEUR * ligne, int f, int * pg, int nbG,
                           double centre_x, double centre_y,
                           double rayon_fourmiliere, bool * pfin_ligne);
 
@@ -45,6 +53,10 @@ bool fourmi_garde_lecture(char tab[MAX_LINE], int f, int * pg, int nbG,
 // ajoute une garde à la liste chainée
 void fourmi_garde_ajouter(void);
 
+//---------------------------------------------------------------------
+// prépare la place de nb gardes de plus sans nouvelle allocation
+void fourmi_garde_reserver(int nb);
+
 //---------------------------------------------------------------------
 // détecte les erreurs relatives aux gardes (rendu 1)
 bool fourmi_garde_erreur(int f, int g, unsigned age, double x, double y,
@@ -82,22 +94,38 @@ int fourmi_ouvriere_update(unsigned indice_f, int * pnourriture_rapportee,
                            int centre_x, int centre_y);
 
 //---------------------------------------------------------------------
-// detruit une ouvriere en particulier
-void fourmi_ouvriere_dead(OUVRIERE * a_tester, OUVRIERE * precedent,
-                          int * pcompteur_o);
+// marque une ouvrière comme morte ; elle est retirée de la liste au 
+// compactage qui suit la mise à jour de sa fourmilière
+void fourmi_ouvriere_dead(OUVRIERE * a_tester, int * pcompteur_o);
+
+//---------------------------------------------------------------------
+// retire de la liste les ouvrières de la fourmilière marquées mortes, en
+// ne parcourant que celles de la fourmilière, et dépose la nourriture de
+// celles qui en portaient une
+void fourmi_ouvriere_compacter(unsigned indice_f);
 
 //---------------------------------------------------------------------
 // recherche si l'ouvrière entre en collision avec une autre fourmi
 void fourmi_ouvriere_collision(OUVRIERE * ouvriere);
 
+//---------------------------------------------------------------------
+// retourne la première ouvrière de la liste, NULL s'il n'y en a aucune
+OUVRIERE * fourmi_get_tete_ouvriere(void);
+
 //---------------------------------------------------------------------
 // met à jour les differents champs d'une garde
 int fourmi_garde_update(unsigned indice_f, double centre_x,
                         double centre_y, double rayon_fourmiliere);
 
 //---------------------------------------------------------------------
-// detruit une garde en particulier
-void fourmi_garde_dead(GARDE * a_tester, GARDE * precedent, int * pcompteur_g);
+// marque une garde comme morte ; elle est retirée de la liste au 
+// compactage qui suit la mise à jour de sa fourmilière
+void fourmi_garde_dead(GARDE * a_tester, int * pcompteur_g);
+
+//---------------------------------------------------------------------
+// retire de la liste les gardes de la fourmilière marquées mortes, en ne
+// parcourant que celles de la fourmilière
+void fourmi_garde_compacter(unsigned indice_f);
 
 //---------------------------------------------------------------------
 // recherche si la garde entre en collision avec une ouvrière
@@ -120,6 +148,50 @@ bool fourmi_nourriture_superposition(double nourriture_x, double nourriture_y);
 void fourmi_ouvriere_bon_choix_aller(OUVRIERE * ouvriere, unsigned indice_f,
                                      double centre_x, double centre_y);
 
+//---------------------------------------------------------------------
+// donne une nourriture pour but à l'ouvrière : celle affectée par lot si
+// l'affectation par lot est activée, sinon la plus proche non prise
+bool fourmi_ouvriere_choix_nourriture(OUVRIERE * ouvriere);
+
+//---------------------------------------------------------------------
+// active ou désactive l'affectation par lot des nourritures aux ouvrières
+// libres de chaque fourmilière
+void fourmi_set_affectation_lot(bool actif);
+
+//---------------------------------------------------------------------
+// signale le début d'une mise à jour : refait la chaine des fourmis de
+// chaque fourmilière ; les positions des ouvrières et des nourritures
+// seront relues à la prochaine affectation par lot
+void fourmi_debut_update(void);
+
+//---------------------------------------------------------------------
+// affecte en une fois une nourriture distincte aux ouvrières libres de la
+// fourmilière par un appariement glouton sur les NB_CANDIDATS plus 
+// proches nourritures de chacune ; une ouvrière restée sans nourriture
+// propose deux fois plus de nourritures à chaque tour, jusqu'à en avoir
+// une ou les avoir toutes vues. Les positions sont celles du début de
+// la mise à jour : une nourriture apparue depuis n'est proposée qu'à la
+// suivante, une nourriture mangée depuis est écartée
+void fourmi_affectation_lot(unsigned indice_f);
+
+//---------------------------------------------------------------------
+// construit l'arbre des positions de toutes les ouvrières, l'indice de 
+// chaque point étant celui de sa fourmilière
+void fourmi_construire_arbre_ouvriere(void);
+
+//---------------------------------------------------------------------
+// ordonne les affectations possibles par distance, puis par position de
+// la nourriture (x puis y), indice d'ouvrière et enfin ordre de création
+// de l'ouvrière, qui ne départage que deux ouvrières de même indice
+int fourmi_compare_candidats(const void * a, const void * b);
+
+//---------------------------------------------------------------------
+// active (par défaut) ou désactive la réutilisation d'une mise à jour à
+// l'autre de la distance à la nourriture choisie par chaque ouvrière, qui
+// borne sa recherche suivante, et les grilles des buts et des positions
+// des ouvrières qui répondent aux deux tests suivants
+void fourmi_set_cache_but(bool actif);
+
 //---------------------------------------------------------------------
 // teste si une ouvriere de la meme fourmiliere a deja la nourriture en but
 bool fourmi_nourriture_deja_prise(unsigned indice_f, unsigned indice_o,
@@ -171,4 +243,48 @@ void fourmi_ouvriere_ecriture(FILE * fsortie, int indice_f);
 // écrit dans le fichier fsortie les informations relatives aux gardes
 void fourmi_garde_ecriture(FILE * fsortie, int indice_f);
 
+//---------------------------------------------------------------------
+// ajoute au tampon last_o, paix et toutes les ouvrières, champ par champ 
+// et dans l'ordre de la liste
+void fourmi_ouvriere_ecriture_binaire(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// ajoute au tampon last_g et toutes les gardes, champ par champ et dans
+// l'ordre de la liste
+void fourmi_garde_ecriture_binaire(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// restaure les ouvrières écrites par fourmi_ouvriere_ecriture_binaire ;
+// renvoie 0 si la section est invalide
+bool fourmi_ouvriere_lecture_binaire(LECTURE_BINAIRE * section);
+
+//---------------------------------------------------------------------
+// restaure les gardes écrites par fourmi_garde_ecriture_binaire ;
+// renvoie 0 si la section est invalide
+bool fourmi_garde_lecture_binaire(LECTURE_BINAIRE * section);
+
+//---------------------------------------------------------------------
+// donne l'enregistreur des trajectoires, ou NULL pour ne plus en 
+// enregistrer
+void fourmi_set_trajectoire(TRAJECTOIRE * nouvelle);
+
+//---------------------------------------------------------------------
+// ajoute à l'empreinte chaque ouvrière et chaque garde, sans les champs
+// qui ne servent que de cache, puis les derniers indices attribués
+void fourmi_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter);
+
+//---------------------------------------------------------------------
+// enregistre la position de toutes les fourmis à la fin de la mise à jour
+void fourmi_enregistrer_trajectoire(void);
+
+//---------------------------------------------------------------------
+// ajoute une ouvrière de la fourmilière indice_f à la position donnée,
+// pour rejouer un enregistrement
+void fourmi_ouvriere_placer(double x, double y, unsigned indice_f);
+
+//---------------------------------------------------------------------
+// ajoute une garde de la fourmilière indice_f à la position donnée, pour
+// rejouer un enregistrement
+void fourmi_garde_placer(double x, double y, unsigned indice_f);
+
 #endif
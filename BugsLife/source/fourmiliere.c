@@ -13,10 +13,23 @@
 #include "error.h"
 #include "utilitaire.h"
 #include "graphic.h"
+#include "couleur.h"
+#include "grille.h"
+#include "arbre_kd.h"
+#include "memoire.h"
+#include "aleatoire.h"
+#include "compteur.h"
 #include "fourmiliere.h"
 
 #define NB_LINES   11
 #define NB_COLUMNS 4
+#define TAILLE_CELLULE_FOURMILIERE 2.
+// une fourmilière est indexée dans toutes les cellules où une fourmi ou une
+// nourriture peut la toucher
+#define MARGE_GRILLE_FOURMILIERE (RAYON_FOURMI + 2*EPSIL_ZERO)
+// indice_f, x, y, nbO, nbG, nbF, total_food, rayon, rayon_recalcule,
+// rayon_grille, attaquable
+#define TAILLE_BINAIRE_FOURMILIERE (4 + 8 + 8 + 3*4 + 4 + 3*8 + 1)
 
 /*---------------------------------------------------------------------
  Structure de données d'une fourmilière
@@ -29,6 +42,10 @@
 	rayon : rayon de la fourmilière
 	rayon recalculé : rayon en fonction de nbF et de la nourriture
                       total_food que contient la fourmilière
+	rayon_grille : demi-côté du carré avec lequel la fourmilière est
+                   indexée dans la grille (0 si elle n'y est pas)
+	attaquable : booléen qui indique si la fourmilière a de la nourriture
+                 (total_food non nul) et peut être attaquée en guerre
 	suivant : pointeur de type structure Fourmiliere qui pointe sur la
               fourmiliere suivante de la liste chaînée
  ----------------------------------------------------------------------*/
@@ -43,24 +60,42 @@ struct Fourmiliere
     float total_food;
     double rayon;
     double rayon_recalcule;
+    double rayon_grille;
+    bool attaquable;
     FOURMILIERE * suivant;
 };
 
 enum Choix_naissance {NAISSANCE_OUVRIERE, NAISSANCE_GARDE};
 
 static FOURMILIERE * tete_fourmiliere = NULL;
+static POOL * pool_fourmiliere = NULL;
 static int nb_fourmiliere;
 static int choix = NAISSANCE_GARDE;
 
-bool fourmiliere_lecture(char tab[MAX_LINE], int f, int * pnbO, int * pnbG, 
+// accès direct aux fourmilières par leur indice_f (NULL si morte)
+static FOURMILIERE ** tab_fourmiliere = NULL;
+static int nb_indices = 0;
+static int taille_tab_fourmiliere = 0;
+
+static GRILLE * grille_fourmiliere = NULL;
+
+// arbre des centres des fourmilières attaquables, reconstruit seulement
+// quand une fourmilière meurt ou que sa nourriture passe par zéro
+static ARBRE_KD * arbre_attaquable = NULL;
+static POINT_KD * tab_points_attaquables = NULL;
+static int taille_points_attaquables = 0;
+static bool arbre_a_jour = false;
+
+bool fourmiliere_lecture(CURSEUR * ligne, int f, int * pnbO, int * pnbG, 
 						 double * pcentre_x, double * pcentre_y, 
 						 double * prayon_fourmiliere)
 {
     int nb_caract;
     float total_food;
     
-    nb_caract = sscanf(tab, " %lf %lf %d %d %f %lf", pcentre_x, pcentre_y, pnbO, 
-					   pnbG, &total_food, prayon_fourmiliere);
+    nb_caract = lecteur_scanner(ligne, " %lf %lf %d %d %f %lf", pcentre_x, 
+                                pcentre_y, pnbO, pnbG, &total_food, 
+                                prayon_fourmiliere);
     
     fourmiliere_ajouter(f);
     
@@ -74,18 +109,91 @@ bool fourmiliere_lecture(char tab[MAX_LINE], int f, int * pnbO, int * pnbG,
     tete_fourmiliere->rayon_recalcule = (1 + sqrt(tete_fourmiliere->nbF) 
 										 + sqrt(total_food))*RAYON_FOURMI;
     
+    if(nb_caract == 6)
+        fourmiliere_indexer(tete_fourmiliere);
+    fourmiliere_maj_attaquable(tete_fourmiliere);
+    
     return fourmiliere_erreur(nb_caract, f, tete_fourmiliere);
 }
 
 void fourmiliere_ajouter(int f)
 {
     FOURMILIERE * nouveau = NULL;
-    if(!(nouveau = (FOURMILIERE *) malloc (sizeof(FOURMILIERE))))
+    
+    if(!pool_fourmiliere)
+        pool_fourmiliere = memoire_pool_creer(sizeof(FOURMILIERE), 
+                                               memoire_arene_scenario());
+    if(!pool_fourmiliere ||
+       !(nouveau = (FOURMILIERE *) memoire_pool_prendre(pool_fourmiliere)))
         printf("Problème de mémoire dans la fonction %s\n", __func__);
     
     nouveau->indice_f = f;
+    nouveau->rayon_grille = 0;
+    nouveau->attaquable = false;
     nouveau->suivant = tete_fourmiliere;
     tete_fourmiliere = nouveau;
+    
+    if(!fourmiliere_reserver_indices(f + 1))
+        return;
+    
+    tab_fourmiliere[f] = nouveau;
+    if(f >= nb_indices)
+        nb_indices = f + 1;
+}
+
+bool fourmiliere_reserver_indices(int nb)
+{
+    int ancienne_taille = taille_tab_fourmiliere;
+    
+    if(nb <= taille_tab_fourmiliere)
+        return 1;
+    
+    if(!memoire_reserver((void **) &tab_fourmiliere, &taille_tab_fourmiliere,
+                         nb, sizeof(FOURMILIERE *)))
+        return 0;
+    
+    while(ancienne_taille < taille_tab_fourmiliere)
+        tab_fourmiliere[ancienne_taille++] = NULL;
+    return 1;
+}
+
+void fourmiliere_reserver(int nb)
+{
+    if(!pool_fourmiliere)
+        pool_fourmiliere = memoire_pool_creer(sizeof(FOURMILIERE), 
+                                               memoire_arene_scenario());
+    if(pool_fourmiliere)
+        memoire_pool_reserver(pool_fourmiliere, nb);
+}
+
+void fourmiliere_indexer(FOURMILIERE * fourmiliere)
+{
+    if(!grille_fourmiliere)
+        grille_fourmiliere = grille_creer(TAILLE_CELLULE_FOURMILIERE,
+                                          memoire_arene_scenario());
+    
+    fourmiliere->rayon_grille = fourmiliere->rayon + MARGE_GRILLE_FOURMILIERE;
+    grille_inserer(grille_fourmiliere, fourmiliere, fourmiliere->x,
+                   fourmiliere->y, fourmiliere->rayon_grille);
+}
+
+void fourmiliere_desindexer(FOURMILIERE * fourmiliere)
+{
+    if(grille_fourmiliere && fourmiliere->rayon_grille)
+        grille_retirer(grille_fourmiliere, fourmiliere, fourmiliere->x,
+                       fourmiliere->y, fourmiliere->rayon_grille);
+    fourmiliere->rayon_grille = 0;
+}
+
+void fourmiliere_maj_attaquable(FOURMILIERE * fourmiliere)
+{
+    bool attaquable = fourmiliere->total_food != 0;
+    
+    if(attaquable != fourmiliere->attaquable)
+    {
+        fourmiliere->attaquable = attaquable;
+        arbre_a_jour = false;
+    }
 }
 
 bool fourmiliere_erreur(int nb_caract, int f, FOURMILIERE * tete_fourmiliere)
@@ -149,24 +257,24 @@ void fourmiliere_dessine(void)
     while(courant)
     {
         graphic_draw_circle(courant->x, courant->y, courant->rayon, GRAPHIC_EMPTY, 
-							courant->indice_f);
+							couleur_fourmiliere(courant->indice_f));
         courant = courant->suivant;
     }
 }
 
 void fourmiliere_vider(void)
 {
-    FOURMILIERE * a_retirer = NULL;
-    
-    while(tete_fourmiliere)
-    {
-        a_retirer = tete_fourmiliere;
-        tete_fourmiliere = tete_fourmiliere->suivant;
-        free(a_retirer);
-        a_retirer = NULL;
-    }
-    
     tete_fourmiliere = NULL;
+    if(pool_fourmiliere)
+        memoire_pool_vider(pool_fourmiliere);
+    
+    while(nb_indices)
+        tab_fourmiliere[--nb_indices] = NULL;
+    if(grille_fourmiliere)
+        grille_vider(grille_fourmiliere);
+    arbre_a_jour = false;
+    //un scénario relu commence comme au lancement du programme
+    choix = NAISSANCE_GARDE;
 }
 
 void fourmiliere_set_nb(int set)
@@ -182,17 +290,24 @@ int fourmiliere_get_nb()
 void fourmiliere_update(void)
 {
     FOURMILIERE * a_tester = tete_fourmiliere, * precedent = NULL;
+    CHRONO_DEPART(debut);
+    
+    fourmi_debut_update();
+    CHRONOMETRER(PHASE_PREPARATION, debut);
     
     while(a_tester)
     {
         int nourriture_rapportee = 0;
         
         //Naissance de la fourmi 
-        if((double)rand()/RAND_MAX <= a_tester->total_food*BIRTH_RATE)
+        if((double)aleatoire_tirer()/ALEATOIRE_MAX <= a_tester->total_food*BIRTH_RATE)
             fourmiliere_naissance_choix_fourmi(a_tester);
+        CHRONOMETRER(PHASE_NAISSANCE, debut);
         
         //Mise à jour de la quantite de nourriture dans la fourmilière
         a_tester->total_food = a_tester->total_food - a_tester->nbF*FEED_RATE;
+        fourmiliere_maj_attaquable(a_tester);
+        CHRONOMETRER(PHASE_NOURRISSAGE, debut);
         
         //Mise à jour du rayon théorique
         a_tester->rayon_recalcule = (1 + sqrt(a_tester->nbF) + 
@@ -200,28 +315,46 @@ void fourmiliere_update(void)
         
         //Mise à jour du rayon qui va être dessiné seulement si il grandit
         if(a_tester->rayon_recalcule > a_tester->rayon)
-            a_tester->rayon = fourmiliere_nouveau_rayon(a_tester);
+        {
+            double nouveau_rayon = fourmiliere_nouveau_rayon(a_tester);
+            
+            if(nouveau_rayon != a_tester->rayon)
+            {
+                fourmiliere_desindexer(a_tester);
+                a_tester->rayon = nouveau_rayon;
+                fourmiliere_indexer(a_tester);
+            }
+        }
+        CHRONOMETRER(PHASE_RAYON, debut);
         
         //Mise à jour du nombre de fourmis
         a_tester->nbO -= fourmi_ouvriere_update(a_tester->indice_f,
                                                 &nourriture_rapportee, a_tester->x,
                                                 a_tester->y);
+        CHRONOMETRER(PHASE_OUVRIERES, debut);
         
         a_tester->nbG -= fourmi_garde_update(a_tester->indice_f, a_tester->x, 
 											 a_tester->y, a_tester->rayon);
+        CHRONOMETRER(PHASE_GARDES, debut);
         
         a_tester->nbF = a_tester->nbO + a_tester->nbG;
         
        
         a_tester->total_food += nourriture_rapportee;
+        fourmiliere_maj_attaquable(a_tester);
         
-        //Mort fourmilière si plus de fourmis et de nourriture
+        //Mort fourmilière si plus de fourmis et de nourriture ; les 
+        //fourmilières suivantes sont tout de même mises à jour
         if(!a_tester->nbF && a_tester->total_food < VAL_FOOD)
         {
+            FOURMILIERE * suivant = a_tester->suivant;
+            
             fourmiliere_dead(a_tester, precedent);
-            a_tester = precedent;
-            break;
+            CHRONOMETRER(PHASE_MORT_FOURMILIERE, debut);
+            a_tester = suivant;
+            continue;
         }
+        CHRONOMETRER(PHASE_MORT_FOURMILIERE, debut);
         
         precedent = a_tester;
         a_tester = a_tester->suivant;
@@ -250,25 +383,43 @@ void fourmiliere_naissance_choix_fourmi(FOURMILIERE * a_tester)
 
 double fourmiliere_nouveau_rayon(FOURMILIERE * f1)
 {
-    FOURMILIERE * f2 = tete_fourmiliere;
-    double distance, nouveau_rayon = f1->rayon_recalcule;
-    
-    while(f2)
-    {
-		//Si contact entre deux fourmilières différentes
-        if(f2 != f1 && utilitaire_contact(f1->x, f2->x, f1->y, f2->y,
-                                          f1->rayon_recalcule, f2->rayon))
+    FOURMILIERE * f2 = NULL;
+    void ** candidats = NULL;
+    double distance, distance_bord = f1->rayon_recalcule;
+    int i, j, k, nb_candidats, i_min, i_max, j_min, j_max;
+    
+    if(!grille_fourmiliere)
+        return f1->rayon_recalcule;
+    
+    //le point d'une voisine le plus proche du centre est dans son carré
+    //d'indexation : une voisine dont le bord est à moins du rayon théorique
+    //partage une cellule avec le carré de ce rayon
+    grille_zone(grille_fourmiliere, f1->x, f1->y, f1->rayon_recalcule,
+                &i_min, &i_max, &j_min, &j_max);
+    for(j=j_min ; j<=j_max ; j++)
+        for(i=i_min ; i<=i_max ; i++)
         {
-            distance = utilitaire_calcul_norme(f1->x, f2->x, f1->y, f2->y) - f2->rayon;
-            
-            if(distance < nouveau_rayon)
-                nouveau_rayon = distance - EPSIL_ZERO;
+            nb_candidats = grille_cellule_indices(grille_fourmiliere, i, j,
+                                                  &candidats);
+            for(k=0 ; k<nb_candidats ; k++)
+            {
+                f2 = (FOURMILIERE *) candidats[k];
+                if(f2 == f1)
+                    continue;
+                
+                distance = utilitaire_calcul_norme(f1->x, f2->x, f1->y, f2->y)
+                           - f2->rayon;
+                if(distance < distance_bord)
+                    distance_bord = distance;
+            }
         }
-        
-        f2 = f2->suivant;
-    }
     
-    return nouveau_rayon;
+    //Si le rayon théorique atteint le bord de la fourmilière voisine la plus
+    //proche, le rayon s'arrête juste avant ce bord
+    if(distance_bord < f1->rayon_recalcule)
+        return distance_bord - EPSIL_ZERO;
+    
+    return f1->rayon_recalcule;
 }
 
 void fourmiliere_dead(FOURMILIERE * a_tester, FOURMILIERE * precedent)
@@ -278,9 +429,11 @@ void fourmiliere_dead(FOURMILIERE * a_tester, FOURMILIERE * precedent)
     else
         precedent->suivant = a_tester->suivant;
     
-    if(a_tester)
-		free(a_tester);
-    a_tester = NULL;
+    fourmiliere_desindexer(a_tester);
+    tab_fourmiliere[a_tester->indice_f] = NULL;
+    arbre_a_jour = false;
+    
+    memoire_pool_rendre(pool_fourmiliere, a_tester);
     nb_fourmiliere--;
 }
 
@@ -289,6 +442,7 @@ bool fourmiliere_sur_chemin(double posx, double butx, double posy, double buty,
 {
     FOURMILIERE * a_tester = tete_fourmiliere;
     
+    COMPTER(COMPTEUR_SUR_CHEMIN);
     while(a_tester)
     {
         if(a_tester->indice_f != indice_f && 
@@ -305,15 +459,23 @@ bool fourmiliere_sur_chemin(double posx, double butx, double posy, double buty,
 
 bool fourmiliere_nourriture_superposition(double nourriture_x, double nourriture_y)
 {
-    FOURMILIERE * a_tester = tete_fourmiliere;
+    void ** candidats = NULL;
+    int i, nb_candidats;
     
-    while(a_tester)
+    if(!grille_fourmiliere)
+        return 0;
+    
+    //seules les fourmilières indexées dans la cellule de la nourriture
+    //peuvent la toucher
+    nb_candidats = grille_cellule(grille_fourmiliere, nourriture_x, nourriture_y,
+                                  &candidats);
+    for(i=0 ; i<nb_candidats ; i++)
     {
+        FOURMILIERE * a_tester = (FOURMILIERE *) candidats[i];
+        
         if(utilitaire_contact(nourriture_x, a_tester->x, nourriture_y,
                               a_tester->y, a_tester->rayon, RAYON_FOOD))
             return 1;
-        
-        a_tester = a_tester->suivant;
     }
     
     return 0;
@@ -321,16 +483,22 @@ bool fourmiliere_nourriture_superposition(double nourriture_x, double nourriture
 
 bool fourmiliere_fourmi_inside(double ouvriere_x, double ouvriere_y, unsigned indice_f)
 {
-    FOURMILIERE * a_tester = tete_fourmiliere;
+    void ** candidats = NULL;
+    int i, nb_candidats;
     
-    while(a_tester)
+    if(!grille_fourmiliere)
+        return 0;
+    
+    nb_candidats = grille_cellule(grille_fourmiliere, ouvriere_x, ouvriere_y,
+                                  &candidats);
+    for(i=0 ; i<nb_candidats ; i++)
     {
+        FOURMILIERE * a_tester = (FOURMILIERE *) candidats[i];
+        
         if(a_tester->indice_f != indice_f &&
            fourmi_contact_fourmiliere(ouvriere_x, a_tester->x, ouvriere_y, 
                                       a_tester->y, a_tester->rayon))
             return 1;
-        
-        a_tester = a_tester->suivant;
     }
     
     return 0;
@@ -340,50 +508,74 @@ bool fourmiliere_la_plus_proche(double ouvriere_x, double ouvriere_y,
 								unsigned indice_f, double * fourmiliere_a_attaquer_x, 
 								double * fourmiliere_a_attaquer_y)
 {
-    FOURMILIERE * a_tester = tete_fourmiliere;
-    double distance, plus_petite_distance = 2*DMAX;
-    bool fourmiliere_attaquable_trouvee = false;
+    int indice;
+    
+    if(!arbre_a_jour)
+        fourmiliere_construire_arbre();
+    
     /*car une distance ne sera jamais plus grande que 2DMAX (notre intervalle)
-    Ainsi la premiere distance evaluée sera implicitement 
-    considérée comme la plus petite ce qui simplifie le code*/
+    La liste étant rangée par indice décroissant, à distance égale c'est la
+    fourmilière de plus grand indice qui est retenue comme avant*/
+    if(!arbre_kd_plus_proche(arbre_attaquable, ouvriere_x, ouvriere_y, indice_f,
+                             2*DMAX, &indice))
+        return 0;
     
-    while(a_tester)
+    *fourmiliere_a_attaquer_x = tab_fourmiliere[indice]->x;
+    *fourmiliere_a_attaquer_y = tab_fourmiliere[indice]->y;
+    return 1;
+}
+
+void fourmiliere_construire_arbre(void)
+{
+    FOURMILIERE * courant = tete_fourmiliere;
+    int nb = 0;
+    
+    if(!arbre_attaquable)
+        arbre_attaquable = arbre_kd_creer();
+    
+    if(!memoire_reserver((void **) &tab_points_attaquables, 
+                         &taille_points_attaquables, nb_fourmiliere, 
+                         sizeof(POINT_KD)))
+        courant = NULL;
+    
+    while(courant && nb < nb_fourmiliere)
     {
-        distance = utilitaire_calcul_norme(ouvriere_x, a_tester->x, 
-										   ouvriere_y, a_tester->y);
-        
-        if(a_tester->indice_f != indice_f && 
-           a_tester->total_food && distance < plus_petite_distance)
+        if(courant->attaquable)
         {
-            plus_petite_distance = distance;
-            *fourmiliere_a_attaquer_x = a_tester->x;
-            *fourmiliere_a_attaquer_y = a_tester->y;
-            fourmiliere_attaquable_trouvee = true;
+            tab_points_attaquables[nb].x = courant->x;
+            tab_points_attaquables[nb].y = courant->y;
+            tab_points_attaquables[nb].indice = courant->indice_f;
+            nb++;
         }
-        
-        a_tester = a_tester->suivant;
+        courant = courant->suivant;
     }
-
-    if(fourmiliere_attaquable_trouvee)
-        return 1;
-    return 0;
+    
+    arbre_kd_construire(arbre_attaquable, tab_points_attaquables, nb);
+    arbre_a_jour = true;
 }
 
 bool fourmiliere_manger(double pos_ouvriere_x, double pos_ouvriere_y, 
 						unsigned indice_f)
 {
-	FOURMILIERE * a_tester = tete_fourmiliere;
-	
-	while(a_tester)
+    void ** candidats = NULL;
+    int i, nb_candidats;
+    
+    if(!grille_fourmiliere)
+        return 0;
+    
+    nb_candidats = grille_cellule(grille_fourmiliere, pos_ouvriere_x,
+                                  pos_ouvriere_y, &candidats);
+	for(i=0 ; i<nb_candidats ; i++)
     {
+        FOURMILIERE * a_tester = (FOURMILIERE *) candidats[i];
+        
         if(a_tester->indice_f != indice_f &&(utilitaire_calcul_norme(pos_ouvriere_x, 
            a_tester->x, pos_ouvriere_y,a_tester->y) < RAYON_FOURMI)) 
         {
 			a_tester->total_food--;
+			fourmiliere_maj_attaquable(a_tester);
 			return 1;
 		}
-		
-		a_tester = a_tester->suivant;
 	}
 	
 	return 0;
@@ -422,7 +614,153 @@ void fourmiliere_ecriture(FILE * fsortie)
         fprintf(fsortie, "FIN_LISTE \n\n");
 }
 
-void fourmiliere_recup_info(int tab_info[NB_COLUMNS][NB_LINES]) 
+void fourmiliere_ecriture_binaire(TAMPON * tampon)
+{
+    FOURMILIERE * courant = NULL;
+    uint32_t nb = 0;
+    
+    for(courant = tete_fourmiliere ; courant ; courant = courant->suivant)
+        nb++;
+    
+    binaire_ecrire_entier32(tampon, nb_fourmiliere);
+    binaire_ecrire_entier32(tampon, choix);
+    binaire_ecrire_entier32(tampon, nb_indices);
+    binaire_ecrire_entier32(tampon, nb);
+    
+    for(courant = tete_fourmiliere ; courant ; courant = courant->suivant)
+    {
+        binaire_ecrire_entier32(tampon, courant->indice_f);
+        binaire_ecrire_double(tampon, courant->x);
+        binaire_ecrire_double(tampon, courant->y);
+        binaire_ecrire_entier32(tampon, courant->nbO);
+        binaire_ecrire_entier32(tampon, courant->nbG);
+        binaire_ecrire_entier32(tampon, courant->nbF);
+        binaire_ecrire_float(tampon, courant->total_food);
+        binaire_ecrire_double(tampon, courant->rayon);
+        binaire_ecrire_double(tampon, courant->rayon_recalcule);
+        binaire_ecrire_double(tampon, courant->rayon_grille);
+        binaire_ecrire_booleen(tampon, courant->attaquable);
+    }
+}
+
+bool fourmiliere_lecture_binaire(LECTURE_BINAIRE * section, bool reprise)
+{
+    LECTURE_BINAIRE enregistrement;
+    int nb_indices_lus, choix_lu;
+    uint32_t nb, i;
+    
+    nb_fourmiliere = binaire_lire_entier32(section);
+    choix_lu = binaire_lire_entier32(section);
+    nb_indices_lus = binaire_lire_entier32(section);
+    nb = binaire_lire_entier32(section);
+    
+    if(section->erreur || 
+       (choix_lu != NAISSANCE_OUVRIERE && choix_lu != NAISSANCE_GARDE) ||
+       nb_indices_lus < 0 || nb_indices_lus > MAX_FOURMILIERE ||
+       nb > (uint32_t) nb_indices_lus || 
+       (size_t) (section->fin - section->pos) != nb*TAILLE_BINAIRE_FOURMILIERE)
+        return 0;
+    
+    fourmiliere_reserver(nb);
+    if(!fourmiliere_reserver_indices(nb_indices_lus))
+        return 0;
+    if(reprise)
+        choix = choix_lu;
+    
+    //les fourmilières sont reprises de la dernière à la première pour que
+    //l'ajout en tête redonne l'ordre de la liste
+    for(i=nb ; i-- > 0 ; )
+    {
+        FOURMILIERE * fourmiliere = NULL;
+        unsigned indice_f;
+        
+        binaire_enregistrement(section, i, TAILLE_BINAIRE_FOURMILIERE, 
+                               &enregistrement);
+        if((indice_f = binaire_lire_entier32(&enregistrement)) >= 
+           (unsigned) nb_indices_lus || tab_fourmiliere[indice_f])
+            return 0;
+        
+        fourmiliere_ajouter(indice_f);
+        fourmiliere = tete_fourmiliere;
+        
+        fourmiliere->x = binaire_lire_double(&enregistrement);
+        fourmiliere->y = binaire_lire_double(&enregistrement);
+        fourmiliere->nbO = binaire_lire_entier32(&enregistrement);
+        fourmiliere->nbG = binaire_lire_entier32(&enregistrement);
+        fourmiliere->nbF = binaire_lire_entier32(&enregistrement);
+        fourmiliere->total_food = binaire_lire_float(&enregistrement);
+        fourmiliere->rayon = binaire_lire_double(&enregistrement);
+        fourmiliere->rayon_recalcule = binaire_lire_double(&enregistrement);
+        
+        //la grille est reconstruite avec le même rayon qu'à la sauvegarde
+        if(binaire_lire_double(&enregistrement))
+            fourmiliere_indexer(fourmiliere);
+        
+        fourmiliere->attaquable = binaire_lire_booleen(&enregistrement);
+    }
+    
+    nb_indices = nb_indices_lus;
+    arbre_a_jour = false;
+    return 1;
+}
+
+void fourmiliere_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter)
+{
+    FOURMILIERE * courant = NULL;
+    uint64_t entite;
+    
+    //rayon_grille ne sert que de cache aux recherches
+    for(courant = tete_fourmiliere ; courant ; courant = courant->suivant)
+    {
+        entite = empreinte_entier(empreinte_debut(), courant->indice_f);
+        entite = empreinte_reel(entite, courant->x);
+        entite = empreinte_reel(entite, courant->y);
+        entite = empreinte_entier(entite, courant->nbO);
+        entite = empreinte_entier(entite, courant->nbG);
+        entite = empreinte_entier(entite, courant->nbF);
+        entite = empreinte_reel(entite, courant->total_food);
+        entite = empreinte_reel(entite, courant->rayon);
+        entite = empreinte_reel(entite, courant->rayon_recalcule);
+        entite = empreinte_entier(entite, courant->attaquable);
+        empreinte_ajouter(empreinte, EMPREINTE_FOURMILIERE, courant->indice_f,
+                          entite, noter);
+    }
+    
+    entite = empreinte_entier(empreinte_debut(), nb_fourmiliere);
+    entite = empreinte_entier(entite, choix);
+    empreinte_ajouter(empreinte, EMPREINTE_COMPTEURS,
+                      EMPREINTE_COMPTEURS_FOURMILIERE, entite, noter);
+}
+
+void fourmiliere_vider_effectifs(void)
+{
+    FOURMILIERE * courant = tete_fourmiliere;
+    
+    while(courant)
+    {
+        courant->nbO = 0;
+        courant->nbG = 0;
+        courant->nbF = 0;
+        courant = courant->suivant;
+    }
+}
+
+void fourmiliere_compter_fourmi(unsigned indice_f, bool garde)
+{
+    FOURMILIERE * fourmiliere = NULL;
+    
+    if(indice_f >= (unsigned) nb_indices || 
+       !(fourmiliere = tab_fourmiliere[indice_f]))
+        return;
+    
+    if(garde)
+        fourmiliere->nbG++;
+    else
+        fourmiliere->nbO++;
+    fourmiliere->nbF++;
+}
+
+void fourmiliere_recup_info(int tab_info[NB_COLUMNS][NB_LINES], int premiere_ligne) 
 {
     int i, j;
     
@@ -434,16 +772,33 @@ void fourmiliere_recup_info(int tab_info[NB_COLUMNS][NB_LINES])
     
     FOURMILIERE * courant = tete_fourmiliere;
     
+    //Les NB_LINES-1 premières lignes affichent les fourmilières à partir
+    //de premiere_ligne, la dernière le total de toutes les fourmilières
     for(j=0 ; j<NB_LINES-1 ; j++)
-		for(i=0 ; i<NB_COLUMNS ; i++)
-			tab_info[i][j]=0;
+    {
+        courant = NULL;
+        if(premiere_ligne + j < nb_indices)
+            courant = tab_fourmiliere[premiere_ligne + j];
+        
+        for(i=0 ; i<NB_COLUMNS ; i++)
+            tab_info[i][j]=0;
+        
+        if(courant)
+        {
+            tab_info[0][j] = courant->nbF;
+            tab_info[1][j] = courant->nbO;
+            tab_info[2][j] = courant->nbG;
+            tab_info[3][j] = courant->total_food;
+        }
+    }
   
+    courant = tete_fourmiliere;
     while(courant)
     {
-        t_nbF += (tab_info[0][courant->indice_f] = courant->nbF);
-        t_nbO += (tab_info[1][courant->indice_f] = courant->nbO);
-        t_nbG += (tab_info[2][courant->indice_f] = courant->nbG);
-        t_food += (tab_info[3][courant->indice_f] = courant->total_food);
+        t_nbF += courant->nbF;
+        t_nbO += courant->nbO;
+        t_nbG += courant->nbG;
+        t_food += (int) courant->total_food;
             
         courant = courant->suivant;
     }
@@ -453,33 +808,20 @@ void fourmiliere_recup_info(int tab_info[NB_COLUMNS][NB_LINES])
     tab_info[2][NB_LINES -1] = t_nbG;
     tab_info[3][NB_LINES -1] = t_food;
 }
+
+int fourmiliere_get_nb_indices(void)
+{
+    return nb_indices;
+}
 			
-void fourmiliere_ecriture_gnuplot(FILE * fichier, int nb_update) 
+void fourmiliere_enregistrer(ENREGISTREUR * enregistreur) 
 {
-	int i;
-    FOURMILIERE * courant = NULL;
-    bool fourmiliere_trouvee;
-    
-    fprintf(fichier, "%d ", nb_update);
-    
-    for(i=0 ; i<nb_fourmiliere ; i++)
-    {
-		courant = tete_fourmiliere;
-		fourmiliere_trouvee = false;
-		while(courant)
-		{
-			if(courant->indice_f == i)
-			{
-				fprintf(fichier, "%d ", courant->nbF);
-				fourmiliere_trouvee = true;
-				break;
-			}
-			courant = courant->suivant;
-		}
-		
-		if(!fourmiliere_trouvee)
-			fprintf(fichier, "0");
-	}
-    
-    fprintf(fichier, "\n");
+    int i;
+    
+    //les fourmilières disparues restent absentes de la ligne
+    for(i=0 ; i<nb_fourmiliere && i<nb_indices ; i++)
+        if(tab_fourmiliere[i])
+            enregistreur_colonie(enregistreur, i, tab_fourmiliere[i]->nbF,
+                                 tab_fourmiliere[i]->nbO, tab_fourmiliere[i]->nbG,
+                                 tab_fourmiliere[i]->total_food);
 }
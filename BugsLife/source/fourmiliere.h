@@ -13,6 +13,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "constantes.h"
+#include "lecteur.h"
+#include "binaire.h"
+#include "enregistreur.h"
+#include "empreinte.h"
 
 #define NB_LINES   11
 #define NB_COLUMNS 4
@@ -23,7 +27,7 @@ typedef struct Fourmiliere FOURMILIERE;
 
 //---------------------------------------------------------------------
 // mémorise les fourmilières
-bool fourmiliere_lecture(char tab[MAX_LINE], int f, int * pnbO,
+bool fourmiliere_lecture(CURSEUR * ligne, int f, int * pnbO,
                          int * pnbG, double * pcentre_x,
                          double * pcentre_y,
                          double * prayon_fourmiliere);
@@ -32,6 +36,32 @@ bool fourmiliere_lecture(char tab[MAX_LINE], int f, int * pnbO,
 // ajoute une fourmilière à la liste chainée
 void fourmiliere_ajouter(int f);
 
+//---------------------------------------------------------------------
+// prépare la place de nb fourmilières de plus sans nouvelle allocation
+void fourmiliere_reserver(int nb);
+
+//---------------------------------------------------------------------
+// agrandit l'accès direct par indice_f jusqu'à nb indices ; les
+// nouvelles cases sont vides
+bool fourmiliere_reserver_indices(int nb);
+
+//---------------------------------------------------------------------
+// ajoute la fourmilière dans la grille avec son rayon courant
+void fourmiliere_indexer(FOURMILIERE * fourmiliere);
+
+//---------------------------------------------------------------------
+// retire la fourmilière de la grille
+void fourmiliere_desindexer(FOURMILIERE * fourmiliere);
+
+//---------------------------------------------------------------------
+// met à jour l'état attaquable de la fourmilière après une variation de
+// sa nourriture et invalide l'arbre si cet état change
+void fourmiliere_maj_attaquable(FOURMILIERE * fourmiliere);
+
+//---------------------------------------------------------------------
+// reconstruit l'arbre des centres des fourmilières attaquables
+void fourmiliere_construire_arbre(void);
+
 //---------------------------------------------------------------------
 // détecte les erreurs relatives aux fourmilières (rendu 1)
 bool fourmiliere_erreur(int nb_caract, int f, FOURMILIERE * tete_fourmiliere);
@@ -45,7 +75,8 @@ bool fourmiliere_verification_rendu2(void);
 void fourmiliere_dessine(void);
 
 //---------------------------------------------------------------------
-// vide la liste chainée intégralement
+// vide la liste chainée intégralement et remet le choix de la prochaine
+// naissance à celui du lancement du programme
 void fourmiliere_vider(void);
 
 //---------------------------------------------------------------------
@@ -67,7 +98,8 @@ void fourmiliere_naissance_choix_fourmi(FOURMILIERE * a_tester);
 
 //---------------------------------------------------------------------
 // met à jour le rayon qui sera dessiné de sorte à ce que
-// les fourmilieres ne se superposent pas
+// les fourmilieres ne se superposent pas ; seules les voisines indexées
+// dans les cellules à portée du rayon théorique sont examinées
 double fourmiliere_nouveau_rayon(FOURMILIERE * f1);
 
 //---------------------------------------------------------------------
@@ -105,12 +137,44 @@ bool fourmiliere_manger(double pos_ouvriere_x, double pos_ouvriere_y,
 // écrit dans le fichier fsortie les informations relatives aux fourmilières
 void fourmiliere_ecriture(FILE * fsortie);
 
+//---------------------------------------------------------------------
+// ajoute au tampon l'état du module et les fourmilières, champ par champ
+// et dans l'ordre de la liste
+void fourmiliere_ecriture_binaire(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// restaure les fourmilières écrites par fourmiliere_ecriture_binaire, et
+// le choix de la prochaine naissance si reprise ; sinon, comme pour un
+// scénario texte, il reste celui que fourmiliere_vider a remis ; renvoie
+// 0 si la section est invalide
+bool fourmiliere_lecture_binaire(LECTURE_BINAIRE * section, bool reprise);
+
+//---------------------------------------------------------------------
+// ajoute à l'empreinte chaque fourmilière, sans les champs qui ne
+// servent que de cache, puis le nombre de fourmilières et le choix de la
+// prochaine naissance
+void fourmiliere_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter);
+
+//---------------------------------------------------------------------
+// remet à zéro le nombre de fourmis de chaque fourmilière
+void fourmiliere_vider_effectifs(void);
+
+//---------------------------------------------------------------------
+// compte une ouvrière ou une garde de plus dans la fourmilière indice_f
+void fourmiliere_compter_fourmi(unsigned indice_f, bool garde);
+
 //---------------------------------------------------------------------
 // récupère les informations des fourmilières pour remplir le rollout
-void fourmiliere_recup_info(int tab_info[NB_COLUMNS][NB_LINES]);
+// à partir de la fourmilière d'indice premiere_ligne
+void fourmiliere_recup_info(int tab_info[NB_COLUMNS][NB_LINES], int premiere_ligne);
+
+//---------------------------------------------------------------------
+// retourne le nombre d'indices de fourmilières attribués à la lecture
+int fourmiliere_get_nb_indices(void);
 
 //---------------------------------------------------------------------
-// écrit dans le fichier "out.dat" pour l'affichage du graphique avec gnuplot
-void fourmiliere_ecriture_gnuplot(FILE * fichier, int nb_update);
+// remplit la colonne de chaque fourmilière dans la ligne en cours de
+// l'enregistreur
+void fourmiliere_enregistrer(ENREGISTREUR * enregistreur);
 
 #endif
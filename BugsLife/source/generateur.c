@@ -0,0 +1,152 @@
+/*!
+ \file generateur.c
+ \brief Module qui écrit des scénarios synthétiques de taille choisie,
+  rangés en familles, pour le banc d'essai et les microbenchmarks
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "constantes.h"
+#include "aleatoire.h"
+#include "generateur.h"
+
+#define PART_GARDES 10 // une fourmi sur PART_GARDES est une garde
+
+/*---------------------------------------------------------------------
+ Structure de données d'une famille de scénarios
+	nom : nom donné sur la ligne de commande et dans les résultats
+	cote : les fourmilières sont au centre des cases d'une grille de
+	       cote x cote cases couvrant le domaine
+	rayon : rayon des fourmilières
+	total_food : nourriture de chaque fourmilière au départ
+	nourriture_par_fourmi : nourritures posées dans le domaine par fourmi
+	groupee : toutes les fourmis au centre de leur fourmilière, comme F04 ;
+	          sinon les ouvrières sont réparties dans la case
+ ----------------------------------------------------------------------*/
+typedef struct Famille FAMILLE;
+struct Famille
+{
+    const char * nom;
+    int cote;
+    double rayon;
+    double total_food;
+    double nourriture_par_fourmi;
+    bool groupee;
+};
+
+static const FAMILLE tab_famille[NB_FAMILLES] = {
+    {"uniforme", 4, 4., 20., 0.01, false},
+    {"groupee", 3, 5.5, 100., 0., true},
+    {"riche", 4, 4., 200., 0.25, false},
+    {"affamee", 4, 4., 1., 0., false},
+    {"guerre", 10, 1.9, 5., 0.01, false}};
+
+//---------------------------------------------------------------------
+// tire un réel entre min et max
+static double generateur_tirer(double min, double max);
+
+int generateur_famille(const char * nom)
+{
+    int f;
+
+    for(f=0 ; f<NB_FAMILLES ; f++)
+        if(!strcmp(nom, tab_famille[f].nom))
+            return f;
+    return -1;
+}
+
+const char * generateur_nom(enum FamilleScenario famille)
+{
+    return tab_famille[famille].nom;
+}
+
+bool generateur_ecrire(const char * nom_fichier, enum FamilleScenario choix,
+                       long nb_fourmis)
+{
+    const FAMILLE * famille = &tab_famille[choix];
+    FILE * fscenario = NULL;
+    int nb_fourmiliere = famille->cote*famille->cote;
+    double largeur = 2.*DMAX/famille->cote;
+    //les ouvrières restent à plus de deux rayons de celles des cases
+    //voisines, les gardes dans leur fourmilière
+    double marge = largeur/2 - RAYON_FOURMI - 0.1;
+    double rayon_garde = famille->rayon - RAYON_FOURMI - 0.1;
+    long nb_nourriture = (long) (nb_fourmis*famille->nourriture_par_fourmi);
+    long nbO, nbG, k;
+    int f;
+
+    if(!(fscenario = fopen(nom_fichier, "w")))
+    {
+        printf("Impossible d'écrire %s\n", nom_fichier);
+        return 0;
+    }
+
+    aleatoire_semer(GENERATEUR_GRAINE);
+    fprintf(fscenario, "# banc d'essai : %s, %ld fourmis\n\n%d\n",
+            famille->nom, nb_fourmis, nb_fourmiliere);
+
+    for(f=0 ; f<nb_fourmiliere ; f++)
+    {
+        double x = -DMAX + largeur*(f%famille->cote + 0.5);
+        double y = -DMAX + largeur*(f/famille->cote + 0.5);
+        long nbF = nb_fourmis/nb_fourmiliere + (f < nb_fourmis%nb_fourmiliere);
+
+        nbG = nbF/PART_GARDES;
+        nbO = nbF - nbG;
+        fprintf(fscenario, "%f %f %ld %ld %f %f\n", x, y, nbO, nbG,
+                famille->total_food, famille->rayon);
+
+        for(k=0 ; k<nbO ; k++)
+        {
+            double xo = x, yo = y;
+
+            if(!famille->groupee)
+            {
+                xo = generateur_tirer(x - marge, x + marge);
+                yo = generateur_tirer(y - marge, y + marge);
+            }
+            fprintf(fscenario, "%d %f %f %f %f 0\n",
+                    aleatoire_tirer()%(BUG_LIFE/2), xo, yo, xo, yo);
+        }
+        if(nbO)
+            fprintf(fscenario, "FIN_LISTE\n");
+
+        for(k=0 ; k<nbG ; k++)
+        {
+            double xg = x, yg = y;
+
+            if(!famille->groupee && rayon_garde > 0)
+            {
+                double angle = generateur_tirer(0, 2*M_PI);
+                double distance = rayon_garde*sqrt(generateur_tirer(0, 1));
+
+                xg = x + distance*cos(angle);
+                yg = y + distance*sin(angle);
+            }
+            fprintf(fscenario, "%d %f %f\n", aleatoire_tirer()%(BUG_LIFE/2),
+                    xg, yg);
+        }
+        if(nbG)
+            fprintf(fscenario, "FIN_LISTE\n");
+    }
+    fprintf(fscenario, "FIN_LISTE\n\n%ld\n", nb_nourriture);
+
+    for(k=0 ; k<nb_nourriture ; k++)
+        fprintf(fscenario, "%f %f\n", generateur_tirer(-DMAX + 1, DMAX - 1),
+                generateur_tirer(-DMAX + 1, DMAX - 1));
+    if(nb_nourriture)
+        fprintf(fscenario, "FIN_LISTE\n");
+
+    return !fclose(fscenario);
+}
+
+static double generateur_tirer(double min, double max)
+{
+    return min + (max - min)*((double) aleatoire_tirer()/ALEATOIRE_MAX);
+}
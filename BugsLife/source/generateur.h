@@ -0,0 +1,35 @@
+/*!
+ \file generateur.h
+ \brief Module qui écrit des scénarios synthétiques de taille choisie,
+  rangés en familles, pour le banc d'essai et les microbenchmarks
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef GENERATEUR_H
+#define GENERATEUR_H
+
+#include <stdbool.h>
+
+#define GENERATEUR_GRAINE 2017 // graine de la génération et de la simulation
+
+enum FamilleScenario {UNIFORME, GROUPEE, RICHE, AFFAMEE, GUERRE, 
+                      NB_FAMILLES};
+
+//---------------------------------------------------------------------
+// retourne la famille de ce nom, ou -1 si elle n'existe pas
+int generateur_famille(const char * nom);
+
+//---------------------------------------------------------------------
+// retourne le nom de la famille
+const char * generateur_nom(enum FamilleScenario famille);
+
+//---------------------------------------------------------------------
+// écrit dans nom_fichier le scénario de la famille avec nb_fourmis ; la
+// vérification de rendu 2 n'est pas nécessaire, les fourmilières et les
+// fourmis de fourmilières différentes sont séparées par construction
+bool generateur_ecrire(const char * nom_fichier, enum FamilleScenario famille,
+                       long nb_fourmis);
+
+#endif
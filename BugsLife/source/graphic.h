@@ -12,10 +12,7 @@
 #define GRAPHIC_FILLED 1
 #define GRAPHIC_EMPTY 0
 
-typedef struct Couleur COULEUR;
-
-enum CouleurNom {ROUGE, VERT, BLEU, MAGENTA, CYAN, JAUNE, MARRON, ORANGE,
-				 GRIS, ROSE, NOIR, NB_COLOR};
+#include "couleur.h"
 
 //---------------------------------------------------------------------
 // dessine un cercle de couleur col, plein ou non
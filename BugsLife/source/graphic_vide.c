@@ -0,0 +1,18 @@
+/*!
+ \file graphic_vide.c
+ \brief Module qui remplace graphic.c dans la version sans affichage :
+  les fonctions de dessin ne font rien et OpenGL n'est pas lié
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include "graphic.h"
+
+void graphic_draw_circle (float xc, float yc, float r, int filled, int col)
+{
+}
+
+void graphic_set_color3f(float r, float g,float b)
+{
+}
@@ -0,0 +1,327 @@
+/*!
+ \file grille.c
+ \brief Module qui met à disposition une grille régulière d'indexation
+  spatiale sur le domaine [-DMAX, DMAX]
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "constantes.h"
+#include "memoire.h"
+#include "grille.h"
+
+#define CAPACITE_MIN 4 // capacité du plus petit tableau d'une cellule
+#define NB_CLASSES 7 // tableaux de 4 à 256 éléments pris dans des réserves
+
+/*---------------------------------------------------------------------
+ Structure de données d'une cellule de la grille
+	elements : tableau dynamique des éléments présents dans la cellule
+	nb : nombre d'éléments présents
+	capacite : taille allouée du tableau elements
+ ----------------------------------------------------------------------*/
+typedef struct Cellule CELLULE;
+struct Cellule
+{
+    void ** elements;
+    int nb;
+    int capacite;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'une grille
+	taille_cellule : côté d'une cellule
+	nb_cote : nombre de cellules sur un côté du domaine
+	cellules : tableau de nb_cote*nb_cote cellules, ligne par ligne
+	reserves : réserve des tableaux de chaque capacité, de CAPACITE_MIN
+               à CAPACITE_MIN*2^(NB_CLASSES-1) éléments
+ ----------------------------------------------------------------------*/
+struct Grille
+{
+    double taille_cellule;
+    int nb_cote;
+    CELLULE * cellules;
+    POOL * reserves[NB_CLASSES];
+};
+
+static int grille_indice(GRILLE * grille, double coordonnee);
+
+//---------------------------------------------------------------------
+// indice de la réserve des tableaux de cette capacité, -1 pour un tableau
+// trop grand, pris sur le tas
+static int grille_classe(int capacite);
+
+//---------------------------------------------------------------------
+// prend un tableau de capacite éléments dans sa réserve ou sur le tas
+static void ** grille_prendre_tableau(GRILLE * grille, int capacite);
+
+//---------------------------------------------------------------------
+// rend le tableau de capacite éléments à sa réserve ou au tas
+static void grille_rendre_tableau(GRILLE * grille, void ** elements,
+                                  int capacite);
+
+//---------------------------------------------------------------------
+// remplace le tableau de la cellule par un tableau de capacite éléments,
+// où ses éléments sont recopiés ; renvoie 0 en cas de problème de mémoire
+static bool grille_changer_tableau(GRILLE * grille, CELLULE * cellule,
+                                   int capacite);
+
+GRILLE * grille_creer(double taille_cellule, ARENE * arene)
+{
+    GRILLE * grille = NULL;
+    int classe;
+
+    if(!(grille = (GRILLE *) memoire_allouer (sizeof(GRILLE))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+
+    grille->taille_cellule = taille_cellule;
+    grille->nb_cote = (int) ceil(2*DMAX/taille_cellule);
+    //réserves vides, remplies par grille_reserver ou au premier besoin
+    for(classe=0 ; classe<NB_CLASSES ; classe++)
+        if(!(grille->reserves[classe] = 
+             memoire_pool_creer((CAPACITE_MIN << classe)*sizeof(void *), 
+                                arene)))
+            printf("Problème de mémoire dans la fonction %s\n", __func__);
+    if(!(grille->cellules = 
+         (CELLULE *) memoire_allouer (grille->nb_cote*grille->nb_cote*
+                                      sizeof(CELLULE))))
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+    else
+        memset(grille->cellules, 0, 
+               grille->nb_cote*grille->nb_cote*sizeof(CELLULE));
+
+    return grille;
+}
+
+void grille_detruire(GRILLE * grille)
+{
+    int i;
+
+    if(!grille)
+        return;
+
+    for(i=0 ; i<grille->nb_cote*grille->nb_cote ; i++)
+        if(grille_classe(grille->cellules[i].capacite) < 0)
+            free(grille->cellules[i].elements);
+    for(i=0 ; i<NB_CLASSES ; i++)
+        memoire_pool_detruire(grille->reserves[i]);
+
+    free(grille->cellules);
+    free(grille);
+}
+
+void grille_vider(GRILLE * grille)
+{
+    int i;
+
+    for(i=0 ; i<grille->nb_cote*grille->nb_cote ; i++)
+    {
+        CELLULE * cellule = &grille->cellules[i];
+
+        if(grille_classe(cellule->capacite) < 0)
+            free(cellule->elements);
+        cellule->elements = NULL;
+        cellule->nb = 0;
+        cellule->capacite = 0;
+    }
+
+    //tous les tableaux sont rendus ensemble avec leur réserve
+    for(i=0 ; i<NB_CLASSES ; i++)
+        if(grille->reserves[i])
+            memoire_pool_vider(grille->reserves[i]);
+}
+
+void grille_reserver(GRILLE * grille, int nb)
+{
+    int classe, capacite, nb_tableaux;
+
+    //un tableau plus grand que CAPACITE_MIN est rempli à plus d'un quart :
+    //nb éléments occupent au plus nb tableaux de la première classe et
+    //4*nb/capacite des suivantes
+    for(classe=0 ; classe<NB_CLASSES ; classe++)
+    {
+        capacite = CAPACITE_MIN << classe;
+        nb_tableaux = classe ? 4*nb/capacite : nb;
+        if(nb_tableaux > grille->nb_cote*grille->nb_cote)
+            nb_tableaux = grille->nb_cote*grille->nb_cote;
+        if(!nb_tableaux)
+            break;
+
+        if(grille->reserves[classe])
+            memoire_pool_reserver(grille->reserves[classe], nb_tableaux);
+    }
+}
+
+void grille_inserer(GRILLE * grille, void * element, double x, double y,
+                    double rayon)
+{
+    int i, j;
+    int i_min = grille_indice(grille, x - rayon);
+    int i_max = grille_indice(grille, x + rayon);
+    int j_min = grille_indice(grille, y - rayon);
+    int j_max = grille_indice(grille, y + rayon);
+
+    for(j=j_min ; j<=j_max ; j++)
+        for(i=i_min ; i<=i_max ; i++)
+        {
+            CELLULE * cellule = &grille->cellules[j*grille->nb_cote + i];
+
+            if(cellule->nb == cellule->capacite &&
+               !grille_changer_tableau(grille, cellule, 
+                                       cellule->capacite ? 2*cellule->capacite
+                                                         : CAPACITE_MIN))
+                return;
+
+            cellule->elements[cellule->nb++] = element;
+        }
+}
+
+void grille_retirer(GRILLE * grille, void * element, double x, double y,
+                    double rayon)
+{
+    int i, j, k;
+    int i_min = grille_indice(grille, x - rayon);
+    int i_max = grille_indice(grille, x + rayon);
+    int j_min = grille_indice(grille, y - rayon);
+    int j_max = grille_indice(grille, y + rayon);
+
+    for(j=j_min ; j<=j_max ; j++)
+        for(i=i_min ; i<=i_max ; i++)
+        {
+            CELLULE * cellule = &grille->cellules[j*grille->nb_cote + i];
+
+            for(k=0 ; k<cellule->nb ; k++)
+                if(cellule->elements[k] == element)
+                {
+                    //le dernier élément prend la place de celui retiré
+                    cellule->elements[k] = cellule->elements[--cellule->nb];
+                    break;
+                }
+
+            //une cellule vide rend son tableau, une cellule remplie au
+            //quart le change contre un deux fois plus petit : les tableaux
+            //suivent les éléments d'une cellule à l'autre sans passer par
+            //le tas
+            if(!cellule->nb && cellule->capacite)
+            {
+                grille_rendre_tableau(grille, cellule->elements, 
+                                      cellule->capacite);
+                cellule->elements = NULL;
+                cellule->capacite = 0;
+            }
+            else if(cellule->capacite > CAPACITE_MIN &&
+                    cellule->nb <= cellule->capacite/4)
+                grille_changer_tableau(grille, cellule, cellule->capacite/2);
+        }
+}
+
+void grille_deplacer(GRILLE * grille, void * element, double ancien_x,
+                     double ancien_y, double x, double y)
+{
+    if(grille_indice(grille, ancien_x) == grille_indice(grille, x) &&
+       grille_indice(grille, ancien_y) == grille_indice(grille, y))
+        return;
+
+    grille_retirer(grille, element, ancien_x, ancien_y, 0.);
+    grille_inserer(grille, element, x, y, 0.);
+}
+
+int grille_cellule(GRILLE * grille, double x, double y, void *** pelements)
+{
+    CELLULE * cellule = &grille->cellules[grille_indice(grille, y)*grille->nb_cote
+                                          + grille_indice(grille, x)];
+
+    *pelements = cellule->elements;
+    return cellule->nb;
+}
+
+void grille_zone(GRILLE * grille, double x, double y, double rayon,
+                 int * pi_min, int * pi_max, int * pj_min, int * pj_max)
+{
+    *pi_min = grille_indice(grille, x - rayon);
+    *pi_max = grille_indice(grille, x + rayon);
+    *pj_min = grille_indice(grille, y - rayon);
+    *pj_max = grille_indice(grille, y + rayon);
+}
+
+int grille_cellule_indices(GRILLE * grille, int i, int j, void *** pelements)
+{
+    CELLULE * cellule = &grille->cellules[j*grille->nb_cote + i];
+
+    *pelements = cellule->elements;
+    return cellule->nb;
+}
+
+//---------------------------------------------------------------------
+// indice de la cellule qui contient la coordonnée, ramenée dans le domaine
+static int grille_indice(GRILLE * grille, double coordonnee)
+{
+    int indice = (int) floor((coordonnee + DMAX)/grille->taille_cellule);
+
+    if(indice < 0)
+        return 0;
+    if(indice >= grille->nb_cote)
+        return grille->nb_cote - 1;
+    return indice;
+}
+
+static int grille_classe(int capacite)
+{
+    int classe = 0;
+
+    while(classe < NB_CLASSES && (CAPACITE_MIN << classe) < capacite)
+        classe++;
+    return classe < NB_CLASSES ? classe : -1;
+}
+
+static void ** grille_prendre_tableau(GRILLE * grille, int capacite)
+{
+    int classe = grille_classe(capacite);
+    void ** elements = NULL;
+
+    if(classe < 0)
+        elements = (void **) memoire_allouer (capacite*sizeof(void *));
+    else if(grille->reserves[classe])
+        elements = (void **) memoire_pool_prendre(grille->reserves[classe]);
+
+    if(!elements)
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+    return elements;
+}
+
+static void grille_rendre_tableau(GRILLE * grille, void ** elements,
+                                  int capacite)
+{
+    int classe = grille_classe(capacite);
+
+    if(classe < 0)
+        free(elements);
+    else
+        memoire_pool_rendre(grille->reserves[classe], elements);
+}
+
+static bool grille_changer_tableau(GRILLE * grille, CELLULE * cellule,
+                                   int capacite)
+{
+    void ** elements = grille_prendre_tableau(grille, capacite);
+
+    if(!elements)
+        return 0;
+
+    if(cellule->capacite)
+    {
+        memcpy(elements, cellule->elements, cellule->nb*sizeof(void *));
+        grille_rendre_tableau(grille, cellule->elements, cellule->capacite);
+    }
+    cellule->elements = elements;
+    cellule->capacite = capacite;
+    return 1;
+}
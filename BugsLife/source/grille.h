@@ -0,0 +1,71 @@
+/*!
+ \file grille.h
+ \brief Module qui met à disposition une grille régulière d'indexation
+  spatiale sur le domaine [-DMAX, DMAX]
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef GRILLE_H
+#define GRILLE_H
+
+#include "memoire.h"
+
+typedef struct Grille GRILLE;
+
+//---------------------------------------------------------------------
+// crée une grille vide dont les cellules ont pour côté taille_cellule ;
+// les tableaux des cellules sont pris dans l'arène, ou sur le tas si
+// arene vaut NULL, et la grille doit alors être vidée avant l'arène
+GRILLE * grille_creer(double taille_cellule, ARENE * arene);
+
+//---------------------------------------------------------------------
+// libère la grille et toutes ses cellules
+void grille_detruire(GRILLE * grille);
+
+//---------------------------------------------------------------------
+// retire tous les éléments de la grille et rend tous les tableaux des
+// cellules à leurs réserves, dont les blocs pris sur le tas sont gardés
+void grille_vider(GRILLE * grille);
+
+//---------------------------------------------------------------------
+// prépare les tableaux des cellules pour que nb éléments ponctuels de
+// plus soient insérés sans allocation, quelle que soit leur répartition
+// tant qu'aucune cellule n'en reçoit plus de quelques centaines
+void grille_reserver(GRILLE * grille, int nb);
+
+//---------------------------------------------------------------------
+// ajoute l'élément dans toutes les cellules touchées par le carré
+// de centre (x, y) et de demi-côté rayon
+void grille_inserer(GRILLE * grille, void * element, double x, double y,
+                    double rayon);
+
+//---------------------------------------------------------------------
+// retire l'élément des cellules où il a été inséré avec (x, y, rayon)
+void grille_retirer(GRILLE * grille, void * element, double x, double y,
+                    double rayon);
+
+//---------------------------------------------------------------------
+// déplace l'élément inséré au point (ancien_x, ancien_y) au point (x, y),
+// sans rien faire s'il reste dans la même cellule
+void grille_deplacer(GRILLE * grille, void * element, double ancien_x,
+                     double ancien_y, double x, double y);
+
+//---------------------------------------------------------------------
+// donne les éléments de la cellule qui contient le point (x, y)
+// et renvoie leur nombre
+int grille_cellule(GRILLE * grille, double x, double y, void *** pelements);
+
+//---------------------------------------------------------------------
+// donne les indices extrêmes des cellules touchées par le carré de
+// centre (x, y) et de demi-côté rayon
+void grille_zone(GRILLE * grille, double x, double y, double rayon,
+                 int * pi_min, int * pi_max, int * pj_min, int * pj_max);
+
+//---------------------------------------------------------------------
+// donne les éléments de la cellule de colonne i et de ligne j et renvoie
+// leur nombre
+int grille_cellule_indices(GRILLE * grille, int i, int j, void *** pelements);
+
+#endif
@@ -0,0 +1,140 @@
+/*!
+ \file histogramme.c
+ \brief Module qui range des durées dans un histogramme à cases
+  logarithmiques, comme HdrHistogram : chaque case couvre au plus 1/32
+  de sa valeur, de la nanoseconde à plusieurs siècles, et les centiles
+  s'en déduisent sans garder les durées
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "histogramme.h"
+
+#define BITS_PRECISION 5
+#define NB_SOUS_CASES (1 << BITS_PRECISION)
+// les valeurs de moins de 2*NB_SOUS_CASES ont chacune leur case, puis
+// chaque puissance de deux est coupée en NB_SOUS_CASES cases
+#define NB_CASES ((65 - BITS_PRECISION)*NB_SOUS_CASES)
+#define NB_CENTILES_ECRITS 9
+
+/*---------------------------------------------------------------------
+ Structure de données d'un histogramme
+	cases : nombre de durées de chaque case
+	nb : nombre total de durées
+	max : plus longue durée ajoutée
+ ----------------------------------------------------------------------*/
+struct Histogramme
+{
+    uint64_t cases[NB_CASES];
+    uint64_t nb;
+    uint64_t max;
+};
+
+static const double tab_centile_ecrit[NB_CENTILES_ECRITS] = {50, 75, 90, 95,
+    99, 99.9, 99.99, 99.999, 100};
+
+//---------------------------------------------------------------------
+// retourne la case de la durée
+static int histogramme_case(uint64_t duree);
+
+//---------------------------------------------------------------------
+// retourne la plus grande durée de la case
+static uint64_t histogramme_borne(int indice);
+
+HISTOGRAMME * histogramme_creer(void)
+{
+    HISTOGRAMME * histogramme = NULL;
+
+    if(!(histogramme = (HISTOGRAMME *) calloc (1, sizeof(HISTOGRAMME))))
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+    return histogramme;
+}
+
+void histogramme_detruire(HISTOGRAMME * histogramme)
+{
+    free(histogramme);
+}
+
+void histogramme_ajouter(HISTOGRAMME * histogramme, uint64_t duree)
+{
+    histogramme->cases[histogramme_case(duree)]++;
+    histogramme->nb++;
+    if(duree > histogramme->max)
+        histogramme->max = duree;
+}
+
+uint64_t histogramme_nb(const HISTOGRAMME * histogramme)
+{
+    return histogramme->nb;
+}
+
+uint64_t histogramme_centile(const HISTOGRAMME * histogramme, double centile)
+{
+    uint64_t rang, cumul = 0, borne;
+    int i;
+
+    if(!histogramme->nb)
+        return 0;
+    if(centile >= 100)
+        return histogramme->max;
+
+    rang = (uint64_t) ceil(centile/100*histogramme->nb);
+    if(rang < 1)
+        rang = 1;
+
+    for(i=0 ; i<NB_CASES ; i++)
+    {
+        cumul += histogramme->cases[i];
+        if(cumul >= rang)
+        {
+            borne = histogramme_borne(i);
+            return borne < histogramme->max ? borne : histogramme->max;
+        }
+    }
+    return histogramme->max;
+}
+
+void histogramme_ecrire(const HISTOGRAMME * histogramme, FILE * fichier)
+{
+    int c;
+
+    fprintf(fichier, "%10s %12s %12s\n", "centile", "duree(ms)", "nombre");
+    for(c=0 ; c<NB_CENTILES_ECRITS ; c++)
+        fprintf(fichier, "%10.3f %12.3f %12llu\n", tab_centile_ecrit[c],
+                histogramme_centile(histogramme, tab_centile_ecrit[c])*1e-6,
+                (unsigned long long) ceil(tab_centile_ecrit[c]/100*
+                                          histogramme->nb));
+}
+
+static int histogramme_case(uint64_t duree)
+{
+    uint64_t reste = duree;
+    int exposant = -BITS_PRECISION;
+
+    if(duree < 2*NB_SOUS_CASES)
+        return (int) duree;
+
+    //position du bit de poids fort au-delà de la précision gardée
+    while(reste >>= 1)
+        exposant++;
+    return exposant*NB_SOUS_CASES + (int) (duree >> exposant);
+}
+
+static uint64_t histogramme_borne(int indice)
+{
+    int exposant;
+    uint64_t mantisse;
+
+    if(indice < 2*NB_SOUS_CASES)
+        return indice;
+
+    exposant = indice/NB_SOUS_CASES - 1;
+    mantisse = indice%NB_SOUS_CASES + NB_SOUS_CASES;
+    return ((mantisse + 1) << exposant) - 1;
+}
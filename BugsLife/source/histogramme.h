@@ -0,0 +1,48 @@
+/*!
+ \file histogramme.h
+ \brief Module qui range des durées dans un histogramme à cases
+  logarithmiques, comme HdrHistogram : chaque case couvre au plus 1/32
+  de sa valeur, de la nanoseconde à plusieurs siècles, et les centiles
+  s'en déduisent sans garder les durées
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef HISTOGRAMME_H
+#define HISTOGRAMME_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct Histogramme HISTOGRAMME;
+
+//---------------------------------------------------------------------
+// crée un histogramme vide
+HISTOGRAMME * histogramme_creer(void);
+
+//---------------------------------------------------------------------
+// libère l'histogramme
+void histogramme_detruire(HISTOGRAMME * histogramme);
+
+//---------------------------------------------------------------------
+// ajoute une durée, en nanosecondes
+void histogramme_ajouter(HISTOGRAMME * histogramme, uint64_t duree);
+
+//---------------------------------------------------------------------
+// retourne le nombre de durées ajoutées
+uint64_t histogramme_nb(const HISTOGRAMME * histogramme);
+
+//---------------------------------------------------------------------
+// retourne la plus petite durée dont la case contient au moins centile %
+// des durées, à la précision des cases ; la plus longue durée pour 100,
+// 0 si l'histogramme est vide
+uint64_t histogramme_centile(const HISTOGRAMME * histogramme, double centile);
+
+//---------------------------------------------------------------------
+// écrit les centiles usuels, en millisecondes, et le nombre de durées
+// qu'ils couvrent
+void histogramme_ecrire(const HISTOGRAMME * histogramme, FILE * fichier);
+
+#endif
@@ -0,0 +1,848 @@
+/*!
+ \file lecteur.c
+ \brief Module qui projette un fichier de scénario en mémoire et le découpe
+  en lignes et en champs numériques sans copie
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "traceur.h"
+#include "memoire.h"
+#include "binaire.h"
+#include "lecteur.h"
+
+#define TAILLE_JETON 64 // copie locale d'un champ confié à strtod
+#define TAILLE_LECTURE 4096 // lecture d'un fichier qui ne peut être projeté
+#define MAX_SIGNIFICATIFS 19 // chiffres qui tiennent exactement sur 64 bits
+#define MAX_CHIFFRES_ENTIER 9 // chiffres d'un int lu sans débordement
+#define MAX_EXPOSANT_DOUBLE 22 // 10^22 est le plus grand exact en double
+#define MAX_MANTISSE_DOUBLE (UINT64_C(1) << 53)
+#define MAX_EXPOSANT_FLOAT 10 // 10^10 est le plus grand exact en float
+#define MAX_MANTISSE_FLOAT (UINT64_C(1) << 24)
+#define MAX_EXPOSANT 100000 // au delà, le résultat ne change plus
+#define MAX_FILS 8 // fils de conversion lancés au plus
+#define MIN_LIGNES_FIL 4096 // en dessous, un fil coûte plus qu'il ne rapporte
+#define NB_MIN_VALEURS 1024 // taille initiale du tableau de valeurs d'un fil
+
+/*---------------------------------------------------------------------
+ Structure de données d'un fichier ouvert
+	debut : contenu du fichier
+	taille : nombre de caractères du fichier
+	pos : début de la prochaine ligne
+	projete : vrai si debut est une projection du fichier (mmap), faux
+              s'il a été lu dans un tableau alloué
+	tampons : valeurs converties par chaque fil de lecteur_preparer_lignes
+	nb_tampons : nombre de tableaux de valeurs
+ ----------------------------------------------------------------------*/
+struct Lecteur
+{
+    char * debut;
+    size_t taille;
+    const char * pos;
+    bool projete;
+    VALEUR_LUE * tampons[MAX_FILS];
+    int nb_tampons;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un champ converti à l'avance
+	conversion : 'd', 'u', 'f' ou 'l' pour %lf
+	fin : caractère qui suit le champ dans la ligne
+	valeur : valeur lue, dans le membre qui correspond à la conversion
+ ----------------------------------------------------------------------*/
+struct ValeurLue
+{
+    char conversion;
+    const char * fin;
+    union
+    {
+        double d;
+        float f;
+        int i;
+        unsigned u;
+    } valeur;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données de la part des lignes confiée à un fil
+	lignes, preparations : premières lignes de la tranche et leur 
+                           préparation
+	nb : nombre de lignes de la tranche
+	valeurs : valeurs converties, ligne après ligne
+	nb_valeurs : nombre de valeurs converties
+	capacite : taille allouée du tableau valeurs
+	reussi : faux si la mémoire a manqué ; la tranche est alors relue 
+             depuis le texte
+	fil : fil qui traite la tranche
+ ----------------------------------------------------------------------*/
+typedef struct Tranche TRANCHE;
+struct Tranche
+{
+    CURSEUR * lignes;
+    const PREPARATION ** preparations;
+    int nb;
+    VALEUR_LUE * valeurs;
+    int nb_valeurs;
+    int capacite;
+    bool reussi;
+    pthread_t fil;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un nombre décimal décomposé
+	negatif : signe du nombre
+	mantisse : chiffres significatifs lus
+	exposant : puissance de 10 par laquelle multiplier la mantisse
+	exact : faux si des chiffres significatifs ont été perdus
+ ----------------------------------------------------------------------*/
+typedef struct Decimal DECIMAL;
+struct Decimal
+{
+    bool negatif;
+    uint64_t mantisse;
+    int exposant;
+    bool exact;
+};
+
+static const double puissances_double[MAX_EXPOSANT_DOUBLE + 1] = 
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const float puissances_float[MAX_EXPOSANT_FLOAT + 1] = 
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+static bool lecteur_lire_fichier(LECTEUR * lecteur, int descripteur);
+static void lecteur_sauter_espaces(CURSEUR * ligne);
+static const char * lecteur_decomposer(const char * pos, const char * fin,
+                                       DECIMAL * decimal);
+static bool lecteur_lire_double(CURSEUR * ligne, double * pvaleur);
+static bool lecteur_lire_float(CURSEUR * ligne, float * pvaleur);
+static bool lecteur_lire_entier(CURSEUR * ligne, int * pvaleur);
+static bool lecteur_lire_non_signe(CURSEUR * ligne, unsigned * pvaleur);
+static char * lecteur_copier_jeton(const CURSEUR * ligne, 
+                                   char tampon[TAILLE_JETON]);
+static bool lecteur_infini_incomplet(const char * jeton, const char * fin_jeton);
+static bool lecteur_lire_champ(CURSEUR * ligne, char conversion, void * cible);
+static void lecteur_rejouer(CURSEUR * ligne, void * cible);
+static void * lecteur_fil_tranche(void * argument);
+static void * lecteur_preparer_tranche(void * argument);
+static int lecteur_preparer_ligne(TRANCHE * tranche, CURSEUR * ligne, 
+                                  const PREPARATION * preparation);
+
+LECTEUR * lecteur_ouvrir(const char * nom_fichier)
+{
+    LECTEUR * lecteur = NULL;
+    struct stat etat;
+    int descripteur;
+    
+    if((descripteur = open(nom_fichier, O_RDONLY)) < 0)
+        return NULL;
+    
+    if(!(lecteur = (LECTEUR *) memoire_allouer (sizeof(LECTEUR))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        close(descripteur);
+        return NULL;
+    }
+    
+    lecteur->debut = NULL;
+    lecteur->taille = 0;
+    lecteur->projete = false;
+    lecteur->nb_tampons = 0;
+    
+    //un fichier ordinaire non vide est projeté, les autres sont lus
+    if(!fstat(descripteur, &etat) && S_ISREG(etat.st_mode) && etat.st_size > 0)
+    {
+        void * projection = mmap(NULL, etat.st_size, PROT_READ, MAP_PRIVATE,
+                                 descripteur, 0);
+        
+        if(projection != MAP_FAILED)
+        {
+            madvise(projection, etat.st_size, MADV_SEQUENTIAL);
+            lecteur->debut = (char *) projection;
+            lecteur->taille = etat.st_size;
+            lecteur->projete = true;
+        }
+    }
+    
+    if(!lecteur->projete && !lecteur_lire_fichier(lecteur, descripteur))
+    {
+        close(descripteur);
+        lecteur_fermer(lecteur);
+        return NULL;
+    }
+    
+    close(descripteur);
+    lecteur->pos = lecteur->debut;
+    return lecteur;
+}
+
+void lecteur_fermer(LECTEUR * lecteur)
+{
+    int i;
+    
+    if(!lecteur)
+        return;
+    
+    for(i=0 ; i<lecteur->nb_tampons ; i++)
+        free(lecteur->tampons[i]);
+    
+    if(lecteur->projete)
+        munmap(lecteur->debut, lecteur->taille);
+    else
+        free(lecteur->debut);
+    
+    free(lecteur);
+}
+
+uint64_t lecteur_empreinte(const LECTEUR * lecteur)
+{
+    return binaire_fnv(binaire_fnv_debut(), lecteur->debut, lecteur->taille);
+}
+
+LECTURE_BINAIRE lecteur_lecture_binaire(const LECTEUR * lecteur)
+{
+    LECTURE_BINAIRE lecture = {(const unsigned char *) lecteur->debut,
+                               (const unsigned char *) lecteur->debut + 
+                               lecteur->taille, false};
+    
+    return lecture;
+}
+
+bool lecteur_ligne_suivante(LECTEUR * lecteur, CURSEUR * ligne)
+{
+    const char * fin = lecteur->debut + lecteur->taille, * retour = NULL;
+    
+    if(lecteur->pos >= fin)
+        return 0;
+    
+    ligne->pos = lecteur->pos;
+    ligne->valeurs = NULL;
+    ligne->nb_valeurs = 0;
+    if((retour = (const char *) memchr(lecteur->pos, '\n', fin - lecteur->pos)))
+    {
+        ligne->fin = retour;
+        lecteur->pos = retour + 1;
+    }
+    else
+    {
+        ligne->fin = fin;
+        lecteur->pos = fin;
+    }
+    
+    return 1;
+}
+
+bool lecteur_ligne_vide(const CURSEUR * ligne)
+{
+    const char * pos;
+    
+    for(pos = ligne->pos ; pos < ligne->fin ; pos++)
+        if(!isspace((unsigned char) *pos))
+            return 0;
+    
+    return 1;
+}
+
+bool lecteur_ligne_contient(const CURSEUR * ligne, const char * motif)
+{
+    size_t longueur = strlen(motif);
+    const char * pos = ligne->pos;
+    
+    while(ligne->fin - pos >= (long) longueur &&
+          (pos = (const char *) memchr(pos, motif[0], ligne->fin - pos)))
+    {
+        if(ligne->fin - pos >= (long) longueur && 
+           !memcmp(pos, motif, longueur))
+            return 1;
+        pos++;
+    }
+    
+    return 0;
+}
+
+int lecteur_scanner(CURSEUR * ligne, const char * format, ...)
+{
+    va_list arguments;
+    int nb_lus = 0;
+    bool lu = true;
+    
+    va_start(arguments, format);
+    
+    //les espaces du format sont ignorés : chaque conversion saute déjà les
+    //espaces qui la précèdent, comme pour sscanf
+    while(*format && lu)
+    {
+        if(*format++ != '%')
+            continue;
+        
+        switch(*format)
+        {
+            case 'l' :
+                format++;
+                lu = *format == 'f' && 
+                     lecteur_lire_champ(ligne, 'l', va_arg(arguments, double *));
+                break;
+                
+            case 'f' :
+                lu = lecteur_lire_champ(ligne, 'f', va_arg(arguments, float *));
+                break;
+                
+            case 'd' :
+                lu = lecteur_lire_champ(ligne, 'd', va_arg(arguments, int *));
+                break;
+                
+            case 'u' :
+                lu = lecteur_lire_champ(ligne, 'u', va_arg(arguments, unsigned *));
+                break;
+                
+            default :
+                lu = false;
+        }
+        
+        if(lu)
+        {
+            nb_lus++;
+            format++;
+        }
+    }
+    
+    va_end(arguments);
+    return nb_lus;
+}
+
+void lecteur_preparer_lignes(LECTEUR * lecteur, CURSEUR * lignes, 
+                             const PREPARATION ** preparations, int nb)
+{
+    TRANCHE tranches[MAX_FILS];
+    bool lance[MAX_FILS] = {false};
+    long nb_processeurs = sysconf(_SC_NPROCESSORS_ONLN);
+    int nb_tranches = nb/MIN_LIGNES_FIL, t, i, cumul;
+    
+    if(nb_tranches > nb_processeurs)
+        nb_tranches = nb_processeurs;
+    if(nb_tranches > MAX_FILS - lecteur->nb_tampons)
+        nb_tranches = MAX_FILS - lecteur->nb_tampons;
+    
+    //un seul fil ne ferait que déplacer la lecture : le texte est alors
+    //simplement lu par lecteur_scanner
+    if(nb_tranches < 2)
+        return;
+    
+    for(t=0 ; t<nb_tranches ; t++)
+    {
+        int debut = (long) t*nb/nb_tranches;
+        
+        tranches[t].lignes = lignes + debut;
+        tranches[t].preparations = preparations + debut;
+        tranches[t].nb = (long) (t+1)*nb/nb_tranches - debut;
+        tranches[t].valeurs = NULL;
+        tranches[t].nb_valeurs = 0;
+        tranches[t].capacite = 0;
+        tranches[t].reussi = true;
+    }
+    
+    //la première tranche est traitée par le fil appelant, et celles dont
+    //le fil n'a pas pu être lancé aussi
+    for(t=1 ; t<nb_tranches ; t++)
+        lance[t] = !pthread_create(&tranches[t].fil, NULL, 
+                                   lecteur_fil_tranche, &tranches[t]);
+    
+    for(t=0 ; t<nb_tranches ; t++)
+        if(!lance[t])
+            lecteur_preparer_tranche(&tranches[t]);
+    
+    for(t=0 ; t<nb_tranches ; t++)
+    {
+        if(lance[t])
+            pthread_join(tranches[t].fil, NULL);
+        
+        //les valeurs de chaque ligne suivent celles de la ligne précédente
+        for(i=0, cumul=0 ; i<tranches[t].nb ; i++)
+        {
+            CURSEUR * ligne = &tranches[t].lignes[i];
+            
+            if(!tranches[t].reussi)
+                ligne->nb_valeurs = 0;
+            
+            ligne->valeurs = ligne->nb_valeurs ? tranches[t].valeurs + cumul
+                                               : NULL;
+            cumul += ligne->nb_valeurs;
+        }
+        
+        if(tranches[t].valeurs)
+            lecteur->tampons[lecteur->nb_tampons++] = tranches[t].valeurs;
+    }
+}
+
+//---------------------------------------------------------------------
+// lit tout le fichier dans un tableau quand il ne peut pas être projeté
+static bool lecteur_lire_fichier(LECTEUR * lecteur, int descripteur)
+{
+    size_t capacite = 0;
+    ssize_t nb_lus;
+    
+    do
+    {
+        if(lecteur->taille + TAILLE_LECTURE > capacite)
+        {
+            char * tab = NULL;
+            
+            capacite = 2*capacite + TAILLE_LECTURE;
+            if(!(tab = (char *) memoire_reallouer (lecteur->debut, capacite)))
+            {
+                printf("Problème de mémoire dans la fonction %s\n", __func__);
+                return 0;
+            }
+            lecteur->debut = tab;
+        }
+        
+        nb_lus = read(descripteur, lecteur->debut + lecteur->taille, 
+                      TAILLE_LECTURE);
+        if(nb_lus > 0)
+            lecteur->taille += nb_lus;
+    }
+    while(nb_lus > 0);
+    
+    return nb_lus == 0;
+}
+
+//---------------------------------------------------------------------
+// rend le champ converti à l'avance s'il correspond à la conversion 
+// demandée ; sinon abandonne les valeurs restantes et lit le texte
+static bool lecteur_lire_champ(CURSEUR * ligne, char conversion, void * cible)
+{
+    if(ligne->nb_valeurs > 0 && ligne->valeurs->conversion == conversion)
+    {
+        lecteur_rejouer(ligne, cible);
+        return 1;
+    }
+    
+    ligne->valeurs = NULL;
+    ligne->nb_valeurs = 0;
+    lecteur_sauter_espaces(ligne);
+    
+    switch(conversion)
+    {
+        case 'l' :
+            return lecteur_lire_double(ligne, (double *) cible);
+        case 'f' :
+            return lecteur_lire_float(ligne, (float *) cible);
+        case 'd' :
+            return lecteur_lire_entier(ligne, (int *) cible);
+        case 'u' :
+            return lecteur_lire_non_signe(ligne, (unsigned *) cible);
+    }
+    
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// copie la prochaine valeur convertie et place le curseur après son champ
+static void lecteur_rejouer(CURSEUR * ligne, void * cible)
+{
+    const VALEUR_LUE * valeur = ligne->valeurs;
+    
+    switch(valeur->conversion)
+    {
+        case 'l' :
+            *(double *) cible = valeur->valeur.d;
+            break;
+        case 'f' :
+            *(float *) cible = valeur->valeur.f;
+            break;
+        case 'd' :
+            *(int *) cible = valeur->valeur.i;
+            break;
+        case 'u' :
+            *(unsigned *) cible = valeur->valeur.u;
+            break;
+    }
+    
+    ligne->pos = valeur->fin;
+    ligne->valeurs++;
+    ligne->nb_valeurs--;
+}
+
+//---------------------------------------------------------------------
+// point d'entrée d'un fil lancé : le nomme dans la chronologie
+static void * lecteur_fil_tranche(void * argument)
+{
+    traceur_nommer_fil("lecteur");
+    return lecteur_preparer_tranche(argument);
+}
+
+//---------------------------------------------------------------------
+// fil de conversion : prépare les lignes de sa tranche les unes après 
+// les autres ; les lignes ne sont pas partagées entre les fils
+static void * lecteur_preparer_tranche(void * argument)
+{
+    TRANCHE * tranche = (TRANCHE *) argument;
+    double debut = traceur_debut();
+    int i, nb;
+    
+    for(i=0 ; i<tranche->nb && tranche->reussi ; i++)
+    {
+        if(!tranche->preparations[i])
+            continue;
+        
+        if((nb = lecteur_preparer_ligne(tranche, &tranche->lignes[i],
+                                        tranche->preparations[i])) < 0)
+            tranche->reussi = false;
+        else tranche->lignes[i].nb_valeurs = nb;
+    }
+    
+    traceur_intervalle("tranche", debut);
+    return NULL;
+}
+
+//---------------------------------------------------------------------
+// convertit les champs de la ligne à la suite des valeurs de la tranche,
+// jusqu'au premier champ qui ne peut pas être lu ; renvoie leur nombre,
+// ou -1 si la mémoire manque
+static int lecteur_preparer_ligne(TRANCHE * tranche, CURSEUR * ligne, 
+                                  const PREPARATION * preparation)
+{
+    CURSEUR copie = {ligne->pos, ligne->fin, NULL, 0};
+    const char * format = preparation->format;
+    VALEUR_LUE * valeur = NULL;
+    char conversion;
+    int nb = 0;
+    
+    while(true)
+    {
+        if(!*format)
+        {
+            if(!preparation->repeter)
+                break;
+            format = preparation->format;
+        }
+        
+        if(*format++ != '%')
+            continue;
+        
+        conversion = *format++;
+        if(conversion == 'l' && *format++ != 'f')
+            break;
+        
+        if(tranche->nb_valeurs == tranche->capacite)
+        {
+            int capacite = tranche->capacite ? 2*tranche->capacite 
+                                             : NB_MIN_VALEURS;
+            VALEUR_LUE * tab = 
+                (VALEUR_LUE *) memoire_reallouer (tranche->valeurs, 
+                                                  capacite*sizeof(VALEUR_LUE));
+            if(!tab)
+            {
+                printf("Problème de mémoire dans la fonction %s\n", __func__);
+                return -1;
+            }
+            tranche->valeurs = tab;
+            tranche->capacite = capacite;
+        }
+        
+        valeur = &tranche->valeurs[tranche->nb_valeurs];
+        if(!lecteur_lire_champ(&copie, conversion, &valeur->valeur))
+            break;
+        
+        valeur->conversion = conversion;
+        valeur->fin = copie.pos;
+        tranche->nb_valeurs++;
+        nb++;
+    }
+    
+    return nb;
+}
+
+static void lecteur_sauter_espaces(CURSEUR * ligne)
+{
+    while(ligne->pos < ligne->fin && isspace((unsigned char) *ligne->pos))
+        ligne->pos++;
+}
+
+//---------------------------------------------------------------------
+// décompose un nombre décimal simple ([signe]chiffres[.chiffres][e[signe]
+// chiffres]) et renvoie la position qui le suit ; renvoie NULL pour tout
+// autre écriture (hexadécimale, inf, nan...) qui est laissée à strtod
+static const char * lecteur_decomposer(const char * pos, const char * fin,
+                                       DECIMAL * decimal)
+{
+    int nb_chiffres = 0, nb_significatifs = 0;
+    bool partie_decimale = false;
+    
+    decimal->negatif = false;
+    decimal->mantisse = 0;
+    decimal->exposant = 0;
+    decimal->exact = true;
+    
+    if(pos < fin && (*pos == '+' || *pos == '-'))
+        decimal->negatif = *pos++ == '-';
+    
+    if(fin - pos >= 2 && pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X'))
+        return NULL;
+    
+    for(; pos < fin ; pos++)
+    {
+        if(*pos == '.' && !partie_decimale)
+        {
+            partie_decimale = true;
+            continue;
+        }
+        if(!isdigit((unsigned char) *pos))
+            break;
+        
+        nb_chiffres++;
+        if(decimal->mantisse || *pos != '0')
+        {
+            if(nb_significatifs < MAX_SIGNIFICATIFS)
+            {
+                decimal->mantisse = 10*decimal->mantisse + (*pos - '0');
+                nb_significatifs++;
+                if(partie_decimale)
+                    decimal->exposant--;
+            }
+            else
+            {
+                decimal->exact = false;
+                if(!partie_decimale)
+                    decimal->exposant++;
+            }
+        }
+        else if(partie_decimale)
+            decimal->exposant--;
+    }
+    
+    if(!nb_chiffres)
+        return NULL;
+    
+    //comme sscanf (et contrairement à strtod), un exposant sans chiffre 
+    //est consommé et ignoré
+    if(pos < fin && (*pos == 'e' || *pos == 'E'))
+    {
+        const char * exposant = pos + 1;
+        bool exposant_negatif = false;
+        int valeur = 0;
+        
+        if(exposant < fin && (*exposant == '+' || *exposant == '-'))
+            exposant_negatif = *exposant++ == '-';
+        
+        if(exposant < fin && isdigit((unsigned char) *exposant))
+        {
+            for(; exposant < fin && isdigit((unsigned char) *exposant) ; 
+                exposant++)
+                if(valeur < MAX_EXPOSANT)
+                    valeur = 10*valeur + (*exposant - '0');
+            
+            decimal->exposant += exposant_negatif ? -valeur : valeur;
+        }
+        pos = exposant;
+    }
+    
+    return pos;
+}
+
+//---------------------------------------------------------------------
+// lit un double ; un décimal dont la mantisse et la puissance de 10 sont
+// exactes en double est obtenu par une seule opération correctement 
+// arrondie (Clinger), les autres sont confiés à strtod
+static bool lecteur_lire_double(CURSEUR * ligne, double * pvaleur)
+{
+    DECIMAL decimal;
+    const char * suite = lecteur_decomposer(ligne->pos, ligne->fin, &decimal);
+    char tampon[TAILLE_JETON], * jeton = NULL, * fin_jeton = NULL;
+    double valeur;
+    bool lu;
+    
+    if(suite && decimal.exact && decimal.mantisse <= MAX_MANTISSE_DOUBLE &&
+       decimal.exposant >= -MAX_EXPOSANT_DOUBLE && 
+       decimal.exposant <= MAX_EXPOSANT_DOUBLE)
+    {
+        valeur = (double) decimal.mantisse;
+        
+        if(decimal.exposant < 0)
+            valeur /= puissances_double[-decimal.exposant];
+        else
+            valeur *= puissances_double[decimal.exposant];
+        
+        *pvaleur = decimal.negatif ? -valeur : valeur;
+        ligne->pos = suite;
+        return 1;
+    }
+    
+    if(!(jeton = lecteur_copier_jeton(ligne, tampon)))
+        return 0;
+    
+    //un décimal trop précis garde la fin trouvée par la décomposition, 
+    //qui consomme comme sscanf un exposant sans chiffre
+    valeur = strtod(jeton, &fin_jeton);
+    if((lu = fin_jeton != jeton && !lecteur_infini_incomplet(jeton, fin_jeton)))
+        *pvaleur = valeur;
+    ligne->pos = suite ? suite : ligne->pos + (fin_jeton - jeton);
+    if(jeton != tampon)
+        free(jeton);
+    
+    return lu;
+}
+
+//---------------------------------------------------------------------
+// lit un float directement, sans passer par un double, pour obtenir 
+// le même arrondi que sscanf
+static bool lecteur_lire_float(CURSEUR * ligne, float * pvaleur)
+{
+    DECIMAL decimal;
+    const char * suite = lecteur_decomposer(ligne->pos, ligne->fin, &decimal);
+    char tampon[TAILLE_JETON], * jeton = NULL, * fin_jeton = NULL;
+    float valeur;
+    bool lu;
+    
+    if(suite && decimal.exact && decimal.mantisse <= MAX_MANTISSE_FLOAT &&
+       decimal.exposant >= -MAX_EXPOSANT_FLOAT && 
+       decimal.exposant <= MAX_EXPOSANT_FLOAT)
+    {
+        valeur = (float) decimal.mantisse;
+        
+        if(decimal.exposant < 0)
+            valeur /= puissances_float[-decimal.exposant];
+        else
+            valeur *= puissances_float[decimal.exposant];
+        
+        *pvaleur = decimal.negatif ? -valeur : valeur;
+        ligne->pos = suite;
+        return 1;
+    }
+    
+    if(!(jeton = lecteur_copier_jeton(ligne, tampon)))
+        return 0;
+    
+    //un décimal trop précis garde la fin trouvée par la décomposition, 
+    //qui consomme comme sscanf un exposant sans chiffre
+    valeur = strtof(jeton, &fin_jeton);
+    if((lu = fin_jeton != jeton && !lecteur_infini_incomplet(jeton, fin_jeton)))
+        *pvaleur = valeur;
+    ligne->pos = suite ? suite : ligne->pos + (fin_jeton - jeton);
+    if(jeton != tampon)
+        free(jeton);
+    
+    return lu;
+}
+
+static bool lecteur_lire_entier(CURSEUR * ligne, int * pvaleur)
+{
+    const char * pos = ligne->pos;
+    char tampon[TAILLE_JETON], * jeton = NULL, * fin_jeton = NULL;
+    bool negatif = false;
+    long valeur = 0;
+    int nb_chiffres = 0;
+    
+    if(pos < ligne->fin && (*pos == '+' || *pos == '-'))
+        negatif = *pos++ == '-';
+    
+    for(; pos < ligne->fin && isdigit((unsigned char) *pos) && 
+        nb_chiffres <= MAX_CHIFFRES_ENTIER ; pos++, nb_chiffres++)
+        valeur = 10*valeur + (*pos - '0');
+    
+    if(nb_chiffres && nb_chiffres <= MAX_CHIFFRES_ENTIER)
+    {
+        *pvaleur = (int) (negatif ? -valeur : valeur);
+        ligne->pos = pos;
+        return 1;
+    }
+    
+    //trop long pour un int : même conversion que sscanf
+    if(!nb_chiffres || !(jeton = lecteur_copier_jeton(ligne, tampon)))
+        return 0;
+    
+    *pvaleur = (int) strtol(jeton, &fin_jeton, 10);
+    ligne->pos += fin_jeton - jeton;
+    if(jeton != tampon)
+        free(jeton);
+    
+    return 1;
+}
+
+static bool lecteur_lire_non_signe(CURSEUR * ligne, unsigned * pvaleur)
+{
+    const char * pos = ligne->pos;
+    char tampon[TAILLE_JETON], * jeton = NULL, * fin_jeton = NULL;
+    unsigned long valeur = 0;
+    int nb_chiffres = 0;
+    
+    for(; pos < ligne->fin && isdigit((unsigned char) *pos) && 
+        nb_chiffres <= MAX_CHIFFRES_ENTIER ; pos++, nb_chiffres++)
+        valeur = 10*valeur + (*pos - '0');
+    
+    if(nb_chiffres && nb_chiffres <= MAX_CHIFFRES_ENTIER)
+    {
+        *pvaleur = (unsigned) valeur;
+        ligne->pos = pos;
+        return 1;
+    }
+    
+    //signe ou nombre trop long : même conversion que sscanf
+    if(!(jeton = lecteur_copier_jeton(ligne, tampon)))
+        return 0;
+    
+    *pvaleur = (unsigned) strtoul(jeton, &fin_jeton, 10);
+    ligne->pos += fin_jeton - jeton;
+    if(jeton != tampon)
+        free(jeton);
+    
+    return fin_jeton != jeton;
+}
+
+//---------------------------------------------------------------------
+// copie le champ qui commence au curseur, terminé par un zéro, dans 
+// tampon ou dans un tableau alloué s'il est trop long ; renvoie NULL si 
+// le curseur est en fin de ligne
+static char * lecteur_copier_jeton(const CURSEUR * ligne, 
+                                   char tampon[TAILLE_JETON])
+{
+    const char * fin = ligne->pos;
+    char * jeton = tampon;
+    
+    while(fin < ligne->fin && !isspace((unsigned char) *fin))
+        fin++;
+    
+    if(fin == ligne->pos)
+        return NULL;
+    
+    if(fin - ligne->pos >= TAILLE_JETON &&
+       !(jeton = (char *) memoire_allouer (fin - ligne->pos + 1)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+    
+    memcpy(jeton, ligne->pos, fin - ligne->pos);
+    jeton[fin - ligne->pos] = '\0';
+    return jeton;
+}
+
+//---------------------------------------------------------------------
+// teste si strtod s'est arrêté après "inf" devant un "infinity" 
+// incomplet, que sscanf refuse
+static bool lecteur_infini_incomplet(const char * jeton, const char * fin_jeton)
+{
+    if(*jeton == '+' || *jeton == '-')
+        jeton++;
+    
+    return fin_jeton - jeton == 3 && (*jeton == 'i' || *jeton == 'I') &&
+           (*fin_jeton == 'i' || *fin_jeton == 'I');
+}
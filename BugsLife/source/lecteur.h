@@ -0,0 +1,98 @@
+/*!
+ \file lecteur.h
+ \brief Module qui projette un fichier de scénario en mémoire et le découpe
+  en lignes et en champs numériques sans copie
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef LECTEUR_H
+#define LECTEUR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "binaire.h"
+
+typedef struct ValeurLue VALEUR_LUE;
+
+/*---------------------------------------------------------------------
+ Structure de données d'un curseur dans une ligne : type concret
+	pos : prochain caractère à lire
+	fin : caractère qui suit le dernier caractère de la ligne
+	valeurs : champs de la ligne déjà convertis par 
+              lecteur_preparer_lignes, ou NULL
+	nb_valeurs : nombre de champs convertis qui restent à lire
+ ----------------------------------------------------------------------*/
+typedef struct Curseur CURSEUR;
+struct Curseur
+{
+    const char * pos;
+    const char * fin;
+    const VALEUR_LUE * valeurs;
+    int nb_valeurs;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données de la préparation d'une ligne : type concret
+	format : conversions à appliquer à la ligne, comme pour 
+             lecteur_scanner
+	repeter : vrai si le format est appliqué de nouveau jusqu'à la fin 
+              de la ligne
+ ----------------------------------------------------------------------*/
+typedef struct Preparation PREPARATION;
+struct Preparation
+{
+    const char * format;
+    bool repeter;
+};
+
+typedef struct Lecteur LECTEUR;
+
+//---------------------------------------------------------------------
+// ouvre le fichier et le projette en mémoire ; renvoie NULL s'il ne
+// peut pas être ouvert
+LECTEUR * lecteur_ouvrir(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// libère la projection du fichier
+void lecteur_fermer(LECTEUR * lecteur);
+
+//---------------------------------------------------------------------
+// calcule l'empreinte FNV-1a sur 64 bits de tout le contenu du fichier
+uint64_t lecteur_empreinte(const LECTEUR * lecteur);
+
+//---------------------------------------------------------------------
+// prépare la lecture binaire de tout le contenu du fichier, sans copie ;
+// valable jusqu'à lecteur_fermer
+LECTURE_BINAIRE lecteur_lecture_binaire(const LECTEUR * lecteur);
+
+//---------------------------------------------------------------------
+// place dans ligne la ligne suivante du fichier, quelle que soit sa 
+// longueur ; renvoie 0 à la fin du fichier
+bool lecteur_ligne_suivante(LECTEUR * lecteur, CURSEUR * ligne);
+
+//---------------------------------------------------------------------
+// teste si la ligne ne contient que des espaces
+bool lecteur_ligne_vide(const CURSEUR * ligne);
+
+//---------------------------------------------------------------------
+// teste si la ligne contient le motif
+bool lecteur_ligne_contient(const CURSEUR * ligne, const char * motif);
+
+//---------------------------------------------------------------------
+// lit à partir du curseur les champs décrits par format comme le ferait 
+// sscanf, avec les seules conversions %d, %u, %f et %lf ; avance le 
+// curseur et renvoie le nombre de champs lus
+int lecteur_scanner(CURSEUR * ligne, const char * format, ...);
+
+//---------------------------------------------------------------------
+// convertit à l'avance et en parallèle les champs des nb lignes selon 
+// leur préparation (NULL pour une ligne à laisser telle quelle) ; 
+// lecteur_scanner rend ensuite ces valeurs sans relire le texte, et 
+// relit le texte dès que les conversions demandées diffèrent. Les 
+// valeurs restent valables jusqu'à lecteur_fermer
+void lecteur_preparer_lignes(LECTEUR * lecteur, CURSEUR * lignes, 
+                             const PREPARATION ** preparations, int nb);
+
+#endif
@@ -30,10 +30,23 @@ extern "C"
 #define BUTTON1_ID 12
 #define EDITTEXT2_ID 13
 #define BUTTON2_ID 14
+#define CHECKBOX2_ID 15
+#define SPINNER2_ID 16
 #define RADIOGROUP_ID 21
 #define BUTTON3_ID 31
 #define BUTTON4_ID 32
 #define CHECKBOX_ID 33
+#define CHECKBOX3_ID 34
+#define SPINNER_ID 41
+#define SPINNER3_ID 42
+#define SPINNER4_ID 43
+#define PERIODE_SAUVEGARDE 500
+#define FICHIER_ENREGISTREMENT "out.rec"
+#define FICHIER_GNUPLOT "out.dat"
+#define FICHIER_TRAJECTOIRE "out.traj"
+#define VITESSE_RELECTURE 60 //mises à jour rejouées par seconde
+#define BUDGET_UPDATE 50 //ms, une mise à jour plus longue est signalée
+#define NB_CENTILES 4
 
 enum RolloutColonne{FOURMIS_TOTAL, OUVRIERES, GARDES, NOURRITURES};
 
@@ -48,9 +61,6 @@ namespace
     GLfloat x_min, x_max, y_min, y_max;
     GLfloat aspect_ratio;
  
-    /*Fichier pour l'affichage du graphe avec gnuplot*/
-    FILE *fichier_gnuplot = NULL;
-    
     /*Booléens*/
     //initialisation du jeu en stop au depart
     bool play = false;
@@ -65,8 +75,37 @@ namespace
     /*tableau de char qui remplit le rollout*/
     GLUI_StaticText * tab_info_text[NB_COLUMNS][NB_LINES];
     
+    /*nom des fourmilières affichées dans le rollout*/
+    GLUI_StaticText * tab_nom_text[NB_LINES - 1];
+    
+    /*indice de la première fourmilière affichée dans le rollout*/
+    int premiere_ligne = 0;
+    GLUI_Spinner * spinner;
+    
+    /*nombre de mises à jour entre deux points de reprise*/
+    int periode_sauvegarde = PERIODE_SAUVEGARDE;
+    
+    /*mise à jour affichée en mode Replay, et l'instant et la mise à jour
+      d'où la lecture est partie*/
+    int update_relecture = 1;
+    GLUI_Spinner * spinner_relecture;
+    int temps_depart = 0;
+    int update_depart = 1;
+    
+    /*budget d'une mise à jour en millisecondes, et centiles de leur durée
+      affichés*/
+    int budget = BUDGET_UPDATE;
+    const double tab_centile[NB_CENTILES] = {50, 99, 99.9, 100};
+    GLUI_StaticText * tab_latence_text[NB_CENTILES];
+    
+    const char * tab_nom_couleur[] = {"Rouge", "Vert", "Bleu", "Magenta", 
+                                      "Cyan", "Jaune", "Marron", "Orange", 
+                                      "Gris", "Rose"};
+    
     /*pointeurs pour créer les objets de GLUI*/
     GLUI_Checkbox *checkbox;
+    GLUI_Checkbox *checkbox_sauvegarde;
+    GLUI_Checkbox *checkbox_trajectoire;
     GLUI_EditText *edittext1;
     GLUI_EditText *edittext2;
     GLUI_EditText *edittext3;
@@ -129,6 +168,27 @@ void control_cb_step(void);
 // gère le checkbox record
 void control_cb_checkbox_record(void);
 
+//---------------------------------------------------------------------
+// gère le checkbox des points de reprise et leur période
+void control_cb_checkbox_sauvegarde(void);
+
+//---------------------------------------------------------------------
+// gère le checkbox d'enregistrement des trajectoires
+void control_cb_checkbox_trajectoire(void);
+
+//---------------------------------------------------------------------
+// affiche la mise à jour choisie avec le spinner du mode Replay
+void control_cb_relecture(void);
+
+//---------------------------------------------------------------------
+// avance la relecture au rythme de VITESSE_RELECTURE d'après l'horloge,
+// et l'arrête à la dernière mise à jour
+void relecture_avancer(void);
+
+//---------------------------------------------------------------------
+// termine l'enregistrement et écrit le fichier "out.dat" pour gnuplot
+void fin_enregistrement(void);
+
 //---------------------------------------------------------------------
 // met à jour le tableau de rollout
 void update_window(void);
@@ -137,7 +197,25 @@ void update_window(void);
 /****************************** main() *******************************/
 int main(int argc, char *argv[])
 {
-    fichier_gnuplot = fopen ((char*) "out.dat", "w");
+    //la chronologie est écrite en dernier, une fois les fils d'écriture
+    //arrêtés par les fonctions suivantes
+    if(modele_trace_ouvrir())
+        atexit(modele_trace_fermer);
+    
+    //le bouton Exit laisse le dernier point de reprise se terminer et
+    //exporte l'enregistrement en cours
+    atexit(modele_arreter_sauvegarde);
+    atexit(modele_fermer_persistance);
+    atexit(fin_enregistrement);
+    atexit(modele_trajectoire_arreter);
+    //les centiles de la durée des mises à jour sont écrits en quittant
+    atexit(modele_surveillance_arreter);
+    
+    //variantes demandées par l'environnement, pour tous les modes
+    modele_variantes();
+    
+    long nb_updates;
+    char * fin = NULL;
     
     switch(prgmmode = def_mode(argv[1], argv[2], argc))
     {    
@@ -165,6 +243,27 @@ int main(int argc, char *argv[])
                 modele_nettoyer();
             else if (!modele_verification_rendu2())
                 modele_nettoyer();
+            break;
+        case REPLAY :
+            if(!modele_relecture_ouvrir(argv[2]))
+                return EXIT_FAILURE;
+            break;
+        case BATCH :
+            //aucune fenêtre n'est créée : le mode tourne sans affichage
+            nb_updates = strtol(argv[3], &fin, 10);
+            if(*fin || nb_updates < 0)
+            {
+                printf("erreur : usage : '././main.x Batch nom_fichier "
+                       "nb_updates [sauvegarde|- [mesures.csv|mesures.json]]'\n");
+                return EXIT_FAILURE;
+            }
+            //'-' : mesures écrites sans sauvegarde de l'état final
+            if(!modele_batch(argv[2], nb_updates,
+                             argc >= 5 && strcmp(argv[4], "-") ? argv[4] : NULL,
+                             argc == 6 ? argv[5] : NULL))
+                return EXIT_FAILURE;
+            return EXIT_SUCCESS;
+            break;
         case RIEN :
             break;
         case INCORRECT :
@@ -174,6 +273,8 @@ int main(int argc, char *argv[])
             break;
     }
     
+    modele_surveillance_demarrer(budget);
+    
     int i, j; //Initialisation du tableau tab_float à zéro
     for(i=0 ; i< NB_COLUMNS ; i++)
         for(j=0; j< NB_LINES ; j++)
@@ -206,6 +307,8 @@ PRGMMODE def_mode(char* nom_mode, char* nom_fichier, int argc)
 {
     if (argc == 1)
         return RIEN;
+    else if (argc >= 4 && argc <= 6 && !strcmp(nom_mode, (char*) "Batch"))
+        return BATCH;
     else if (argc != 3)//Vérification de la cohérence de l'appel de l'exécutable
     {
         printf("erreur : usage : '././main.x mode_test nom_fichier'\n");
@@ -219,6 +322,8 @@ PRGMMODE def_mode(char* nom_mode, char* nom_fichier, int argc)
         return GRAPHIC;
     else if(!strcmp(nom_mode, (char*) "Final"))
         return FINAL;
+    else if(!strcmp(nom_mode, (char*) "Replay"))
+        return REPLAY;
     else
     {
         printf("erreur : usage : '././main.x mode_test nom_fichier'\n");
@@ -277,9 +382,11 @@ void idle(void)
     {
         if(prgmmode == GRAPHIC)
             printf("modele update\n");
+        else if(prgmmode == REPLAY)
+            relecture_avancer();
         else
         {
-            modele_update(automatic, record_active, fichier_gnuplot);
+            modele_update(automatic, record_active);
             glutPostRedisplay();
         }
     }
@@ -315,6 +422,13 @@ void creation_panels_gauche(char * nom_fichier)
     edittext2->set_text((char*)"save.txt");
     button_save = glui->add_button_to_panel(file_panel, (char*)"Save",
                                             BUTTON2_ID, control_cb);
+    //points de reprise écrits en arrière-plan dans le fichier de sauvegarde
+    checkbox_sauvegarde = glui->add_checkbox_to_panel(file_panel,
+                          (char*)"Checkpoint", NULL, CHECKBOX2_ID, control_cb);
+    GLUI_Spinner * spinner_sauvegarde = 
+        glui->add_spinner_to_panel(file_panel, (char*)"Every", GLUI_SPINNER_INT,
+                                   &periode_sauvegarde, SPINNER2_ID, control_cb);
+    spinner_sauvegarde->set_int_limits(1, 100000, GLUI_LIMIT_CLAMP);
     //panel2
     GLUI_Panel *food_panel = glui->add_panel((char*)"Food creation",
                                              GLUI_PANEL_EMBOSSED);
@@ -334,6 +448,35 @@ void creation_panels_gauche(char * nom_fichier)
                                             BUTTON4_ID, control_cb);
     checkbox= glui->add_checkbox_to_panel(simulation_panel,
               (char*)"Record", NULL, CHECKBOX_ID, control_cb);
+    //positions de chaque fourmi, compressées dans "out.traj"
+    checkbox_trajectoire = glui->add_checkbox_to_panel(simulation_panel,
+                           (char*)"Trajectories", NULL, CHECKBOX3_ID, control_cb);
+    
+    //en mode Replay le modèle n'est jamais mis à jour : rien à enregistrer
+    if(prgmmode == REPLAY)
+    {
+        spinner_relecture = glui->add_spinner_to_panel(simulation_panel,
+                            (char*)"Update", GLUI_SPINNER_INT, &update_relecture,
+                            SPINNER3_ID, control_cb);
+        spinner_relecture->set_int_limits(1, modele_relecture_nb_updates(),
+                                          GLUI_LIMIT_CLAMP);
+        checkbox->disable();
+        checkbox_trajectoire->disable();
+        radio->disable();
+    }
+    
+    //durée des mises à jour : centiles et budget au-delà duquel une mise
+    //à jour est signalée dans le terminal
+    GLUI_Panel *latence_panel = glui->add_panel((char*)"Latency",
+                                                GLUI_PANEL_EMBOSSED);
+    for(int c=0 ; c<NB_CENTILES ; c++)
+        tab_latence_text[c] = glui->add_statictext_to_panel(latence_panel,
+                                                            (char*)"-");
+    GLUI_Spinner * spinner_budget = 
+        glui->add_spinner_to_panel(latence_panel, (char*)"Budget (ms)",
+                                   GLUI_SPINNER_INT, &budget, SPINNER4_ID,
+                                   control_cb);
+    spinner_budget->set_int_limits(1, 10000, GLUI_LIMIT_CLAMP);
     
     //Exit button
     glui->add_button((char*) "Exit", 0, (GLUI_Update_CB)exit);
@@ -345,20 +488,14 @@ void creation_panels_droite(GLUI * glui)
     GLUI_Rollout * array = glui->add_rollout((char*) "Information", true,
                                              GLUI_PANEL_RAISED);    
     
+    int i, j;
+    
     glui->add_statictext_to_panel(array, (char*) "Couleur");
-    glui->add_statictext_to_panel(array, (char*) "Rouge");
-    glui->add_statictext_to_panel(array, (char*) "Vert");
-    glui->add_statictext_to_panel(array, (char*) "Bleu");
-    glui->add_statictext_to_panel(array, (char*) "Magenta");
-    glui->add_statictext_to_panel(array, (char*) "Cyan");
-    glui->add_statictext_to_panel(array, (char*) "Jaune");
-    glui->add_statictext_to_panel(array, (char*) "Marron");
-    glui->add_statictext_to_panel(array, (char*) "Orange");
-    glui->add_statictext_to_panel(array, (char*) "Gris");
-    glui->add_statictext_to_panel(array, (char*) "Rose");
+    for(j=0; j<NB_LINES-1; j++)
+        tab_nom_text[j] = glui->add_statictext_to_panel(array, 
+                                                (char*) tab_nom_couleur[j]);
     glui->add_statictext_to_panel(array, (char*) "Total");
-    
-    int i, j;
+
     for(i=0; i<NB_COLUMNS; i++)
     {
         glui->add_column_to_panel(array, true);
@@ -382,6 +519,11 @@ void creation_panels_droite(GLUI * glui)
         for(j=0; j<NB_LINES; j++)
             tab_info_text[i][j] = glui->add_statictext_to_panel(array, (char*)"0");
     }
+    
+    //Défilement du tableau quand il y a plus de fourmilières que de lignes
+    spinner = glui->add_spinner((char*) "Premiere fourmiliere", GLUI_SPINNER_INT,
+                                &premiere_ligne, SPINNER_ID, control_cb);
+    spinner->set_int_limits(0, 0, GLUI_LIMIT_CLAMP);
 }
 
 void control_cb(int control) 
@@ -393,7 +535,17 @@ void control_cb(int control)
             break;
         case (BUTTON1_ID) :
             printf("button open clicked !\n");
-            if(!play)
+            if(!play && prgmmode == REPLAY)
+            {
+                if(!modele_relecture_ouvrir(edittext1->get_text()))
+                    modele_nettoyer();
+                update_relecture = 1;
+                spinner_relecture->set_int_limits(1, 
+                    modele_relecture_nb_updates(), GLUI_LIMIT_CLAMP);
+                spinner_relecture->set_int_val(update_relecture);
+                glutPostRedisplay();
+            }
+            else if(!play)
             {
                 modele_nettoyer();
                 if (!modele_lecture((char *)edittext1->get_text(), prgmmode))
@@ -422,6 +574,22 @@ void control_cb(int control)
         case (CHECKBOX_ID) :
             control_cb_checkbox_record();
             break;
+        case (CHECKBOX3_ID) :
+            control_cb_checkbox_trajectoire();
+            break;
+        case (CHECKBOX2_ID) :
+        case (SPINNER2_ID) :
+            control_cb_checkbox_sauvegarde();
+            break;
+        case (SPINNER_ID) :
+            update_window();
+            break;
+        case (SPINNER3_ID) :
+            control_cb_relecture();
+            break;
+        case (SPINNER4_ID) :
+            modele_set_budget(budget);
+            break;
         default : 
             printf("\n Unknown command\n");
             break;
@@ -453,13 +621,16 @@ void control_cb_start(void)
         {
             record = false;
             checkbox->set_int_val(0); //désactive la checkbox
-            fclose(fichier_gnuplot);
+            fin_enregistrement();
         }	
     }
     else
     {
         button_start_stop->set_name((char*) "Stop");
         play = true;
+        //la relecture part de la mise à jour affichée
+        temps_depart = glutGet(GLUT_ELAPSED_TIME);
+        update_depart = update_relecture;
     }
 }
 
@@ -473,7 +644,14 @@ void control_cb_step(void)
     if(glutGetWindow() != main_window) 
         glutSetWindow(main_window);
     
-    modele_update(automatic, record_active, fichier_gnuplot);
+    if(prgmmode == REPLAY)
+    {
+        if(update_relecture < modele_relecture_nb_updates())
+            spinner_relecture->set_int_val(update_relecture + 1);
+        control_cb_relecture();
+    }
+    else
+        modele_update(automatic, record_active);
     glutPostRedisplay();
     button_start_stop->set_name((char*) "Start");
 }
@@ -487,7 +665,8 @@ void control_cb_checkbox_record(void)
     {
         record = true;
         printf("Record activé!\n"); 
-        modele_update(automatic, record_active, fichier_gnuplot);
+        modele_enregistrement_demarrer(FICHIER_ENREGISTREMENT);
+        modele_update(automatic, record_active);
     }
     else
     {
@@ -496,12 +675,90 @@ void control_cb_checkbox_record(void)
     }
 }
 
+void control_cb_checkbox_sauvegarde(void)
+{
+    if(checkbox_sauvegarde->get_int_val())
+    {
+        if(modele_sauvegarde_periodique(edittext2->get_text(), 
+                                        periode_sauvegarde))
+            printf("Checkpoint toutes les %d mises à jour\n", periode_sauvegarde);
+        else
+            checkbox_sauvegarde->set_int_val(0);
+    }
+    else
+        modele_arreter_sauvegarde();
+}
+
+void control_cb_checkbox_trajectoire(void)
+{
+    if(checkbox_trajectoire->get_int_val())
+    {
+        if(modele_trajectoire_demarrer(FICHIER_TRAJECTOIRE))
+            printf("Trajectoires enregistrées dans %s\n", FICHIER_TRAJECTOIRE);
+        else
+            checkbox_trajectoire->set_int_val(0);
+    }
+    else
+        modele_trajectoire_arreter();
+}
+
+void control_cb_relecture(void)
+{
+    if(!modele_relecture_aller(update_relecture))
+        printf("Mise à jour %d absente des trajectoires\n", update_relecture);
+    temps_depart = glutGet(GLUT_ELAPSED_TIME);
+    update_depart = update_relecture;
+    glutPostRedisplay();
+}
+
+void relecture_avancer(void)
+{
+    int nb_updates = modele_relecture_nb_updates();
+    int cible = update_depart + (int) ((long) (glutGet(GLUT_ELAPSED_TIME) - 
+                                       temps_depart)*VITESSE_RELECTURE/1000);
+    
+    if(cible >= nb_updates)
+    {
+        cible = nb_updates;
+        play = false;
+        button_start_stop->set_name((char*) "Start");
+    }
+    //une image peut sauter plusieurs mises à jour si l'affichage est lent
+    if(cible != update_relecture && modele_relecture_aller(cible))
+    {
+        spinner_relecture->set_int_val(cible);
+        glutPostRedisplay();
+    }
+}
+
+void fin_enregistrement(void)
+{
+    modele_enregistrement_arreter(FICHIER_GNUPLOT);
+}
+
 void update_window(void)
 {
-    char buffer[15];
-    int m, n;
+    char buffer[30];
+    int m, n, c;
+    int nb_lignes = modele_nb_lignes_info();
     
-    modele_recup_info(tab_info);
+    spinner->set_int_limits(0, nb_lignes > NB_LINES-1 ? nb_lignes-(NB_LINES-1) : 0,
+                            GLUI_LIMIT_CLAMP);
+    if(premiere_ligne > nb_lignes - (NB_LINES-1))
+        premiere_ligne = nb_lignes > NB_LINES-1 ? nb_lignes - (NB_LINES-1) : 0;
+    
+    modele_recup_info(tab_info, premiere_ligne);
+    
+    for(n=0; n<NB_LINES-1; n++)
+    {
+        if(premiere_ligne + n < NB_LINES-1)
+            tab_nom_text[n]->set_text((char*) tab_nom_couleur[premiere_ligne + n]);
+        else
+        {
+            sprintf(buffer, "Fourmiliere %d", premiere_ligne + n);
+            tab_nom_text[n]->set_text(buffer);
+        }
+    }
     
     for(m=0; m< NB_COLUMNS; m++)
         for(n=0; n<NB_LINES; n++)
@@ -514,4 +771,14 @@ void update_window(void)
                 tab_info_text[m][n]->set_text(buffer);
             }
         }
+    
+    for(c=0 ; c<NB_CENTILES ; c++)
+    {
+        if(tab_centile[c] < 100)
+            sprintf(buffer, "p%g : %.3f ms", tab_centile[c],
+                    modele_latence_centile(tab_centile[c]));
+        else
+            sprintf(buffer, "max : %.3f ms", modele_latence_centile(100));
+        tab_latence_text[c]->set_text(buffer);
+    }
 }
@@ -0,0 +1,153 @@
+/*!
+ \file materiel.c
+ \brief Module qui lit les compteurs matériels du processeur avec
+  perf_event_open : cycles, instructions, défauts de cache et erreurs de
+  prédiction de branchement du fil de la simulation. Un compteur que le
+  noyau refuse, dans un conteneur par exemple, est simplement absent
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "materiel.h"
+
+//descripteur de chaque compteur, -1 s'il est absent
+static int tab_descripteur[NB_MATERIEL] = {-1, -1, -1, -1, -1};
+
+static const char * tab_nom_materiel[NB_MATERIEL] = {"cycles",
+    "instructions", "defauts_l1", "defauts_llc", "defauts_branchement"};
+
+#ifdef __linux__
+//type et configuration de chaque compteur pour perf_event_open
+static const uint32_t tab_type[NB_MATERIEL] = {PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE};
+
+static const uint64_t tab_configuration[NB_MATERIEL] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+    PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+//---------------------------------------------------------------------
+// ouvre le compteur de l'évènement pour le fil appelant, en mode
+// utilisateur seulement, ce que le réglage par défaut du noyau autorise
+static int materiel_ouvrir_compteur(enum EvenementMateriel evenement);
+#endif
+
+bool materiel_ouvrir(void)
+{
+#ifdef __linux__
+    int e, erreur = 0;
+    bool ouvert = false;
+
+    materiel_fermer();
+    for(e=0 ; e<NB_MATERIEL ; e++)
+    {
+        if((tab_descripteur[e] = materiel_ouvrir_compteur(e)) < 0)
+            erreur = errno;
+        else ouvert = true;
+    }
+
+    if(!ouvert)
+    {
+        printf("Compteurs matériels indisponibles : %s\n", strerror(erreur));
+        return 0;
+    }
+
+    for(e=0 ; e<NB_MATERIEL ; e++)
+        if(tab_descripteur[e] >= 0)
+        {
+            ioctl(tab_descripteur[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(tab_descripteur[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    return 1;
+#else
+    printf("Compteurs matériels indisponibles hors de Linux\n");
+    return 0;
+#endif
+}
+
+void materiel_fermer(void)
+{
+    int e;
+
+    for(e=0 ; e<NB_MATERIEL ; e++)
+        if(tab_descripteur[e] >= 0)
+        {
+            close(tab_descripteur[e]);
+            tab_descripteur[e] = -1;
+        }
+}
+
+bool materiel_actif(void)
+{
+    int e;
+
+    for(e=0 ; e<NB_MATERIEL ; e++)
+        if(tab_descripteur[e] >= 0)
+            return true;
+    return false;
+}
+
+bool materiel_disponible(enum EvenementMateriel evenement)
+{
+    return tab_descripteur[evenement] >= 0;
+}
+
+void materiel_lire(uint64_t tab_valeur[NB_MATERIEL])
+{
+    //valeur, durée d'activation et durée de comptage effectif
+    uint64_t lecture[3];
+    int e;
+
+    for(e=0 ; e<NB_MATERIEL ; e++)
+    {
+        tab_valeur[e] = 0;
+        if(tab_descripteur[e] < 0 ||
+           read(tab_descripteur[e], lecture, sizeof(lecture)) != sizeof(lecture))
+            continue;
+
+        //un compteur partagé avec d'autres n'a compté qu'une partie du
+        //temps : sa valeur est extrapolée
+        if(lecture[2] > 0 && lecture[2] < lecture[1])
+            tab_valeur[e] = (uint64_t) ((double) lecture[0]*lecture[1]/lecture[2]);
+        else
+            tab_valeur[e] = lecture[0];
+    }
+}
+
+const char * materiel_nom(enum EvenementMateriel evenement)
+{
+    return tab_nom_materiel[evenement];
+}
+
+#ifdef __linux__
+static int materiel_ouvrir_compteur(enum EvenementMateriel evenement)
+{
+    struct perf_event_attr attributs;
+
+    memset(&attributs, 0, sizeof(attributs));
+    attributs.size = sizeof(attributs);
+    attributs.type = tab_type[evenement];
+    attributs.config = tab_configuration[evenement];
+    attributs.disabled = 1;
+    attributs.exclude_kernel = 1;
+    attributs.exclude_hv = 1;
+    attributs.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                            PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(SYS_perf_event_open, &attributs, 0, -1, -1, 0);
+}
+#endif
@@ -0,0 +1,48 @@
+/*!
+ \file materiel.h
+ \brief Module qui lit les compteurs matériels du processeur avec
+  perf_event_open : cycles, instructions, défauts de cache et erreurs de
+  prédiction de branchement du fil de la simulation. Un compteur que le
+  noyau refuse, dans un conteneur par exemple, est simplement absent
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef MATERIEL_H
+#define MATERIEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum EvenementMateriel {MATERIEL_CYCLES, MATERIEL_INSTRUCTIONS,
+    MATERIEL_DEFAUTS_L1, MATERIEL_DEFAUTS_LLC, MATERIEL_DEFAUTS_BRANCHEMENT,
+    NB_MATERIEL};
+
+//---------------------------------------------------------------------
+// ouvre et démarre les compteurs du fil appelant ; renvoie 0 si aucun
+// n'est disponible, après avoir écrit pourquoi
+bool materiel_ouvrir(void);
+
+//---------------------------------------------------------------------
+// arrête et ferme tous les compteurs
+void materiel_fermer(void);
+
+//---------------------------------------------------------------------
+// retourne vrai si au moins un compteur est ouvert
+bool materiel_actif(void);
+
+//---------------------------------------------------------------------
+// retourne vrai si le compteur de l'évènement est ouvert
+bool materiel_disponible(enum EvenementMateriel evenement);
+
+//---------------------------------------------------------------------
+// lit la valeur de chaque compteur depuis son ouverture, corrigée si le
+// noyau les a partagés ; 0 pour un compteur absent
+void materiel_lire(uint64_t tab_valeur[NB_MATERIEL]);
+
+//---------------------------------------------------------------------
+// retourne le nom de l'évènement
+const char * materiel_nom(enum EvenementMateriel evenement);
+
+#endif
@@ -0,0 +1,354 @@
+/*!
+ \file memoire.c
+ \brief Module qui met à disposition une arène pour les objets qui vivent
+  le temps d'un scénario, des réserves d'éléments de taille fixe recyclés
+  par liste libre et un compteur des allocations sur le tas
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "memoire.h"
+
+#define ALIGNEMENT 16
+#define ALIGNER(taille) (((taille) + ALIGNEMENT - 1)/ALIGNEMENT*ALIGNEMENT)
+#define NB_MIN_BLOC 64 // nombre minimal d'éléments d'un bloc
+#define TAILLE_MIN_MORCEAU 65536 // taille minimale d'un morceau d'arène
+
+/*---------------------------------------------------------------------
+ Structure de données d'un morceau d'arène, suivi en mémoire par sa zone
+	taille : taille de la zone
+	utilise : partie de la zone déjà découpée
+	suivant : morceau alloué après celui-ci
+ ----------------------------------------------------------------------*/
+typedef struct Morceau MORCEAU;
+struct Morceau
+{
+    size_t taille;
+    size_t utilise;
+    MORCEAU * suivant;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'une arène
+	premier : premier morceau alloué
+	courant : morceau dans lequel les zones sont découpées
+ ----------------------------------------------------------------------*/
+struct Arene
+{
+    MORCEAU * premier;
+    MORCEAU * courant;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un bloc d'éléments contigus, suivi en mémoire
+ par ses nb éléments
+	nb : nombre d'éléments du bloc
+	suivant : bloc alloué après celui-ci
+ ----------------------------------------------------------------------*/
+typedef struct Bloc BLOC;
+struct Bloc
+{
+    int nb;
+    BLOC * suivant;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'une réserve d'éléments
+	taille_element : taille d'un élément, alignée
+	arene : arène qui fournit les blocs (NULL pour le tas)
+	libres : liste des éléments rendus, chaînés par leur premier mot
+	premier , dernier : liste des blocs alloués
+	courant : bloc dont les éléments sont distribués quand libres est vide
+	nb_utilises : nombre d'éléments déjà distribués du bloc courant
+	nb_total : nombre d'éléments de tous les blocs
+	nb_pris : nombre d'éléments actuellement pris
+ ----------------------------------------------------------------------*/
+struct Pool
+{
+    size_t taille_element;
+    ARENE * arene;
+    void * libres;
+    BLOC * premier;
+    BLOC * dernier;
+    BLOC * courant;
+    int nb_utilises;
+    int nb_total;
+    int nb_pris;
+};
+
+// compté depuis le fil de simulation et les fils de lecture
+static atomic_ulong nb_allocations = 0;
+static ARENE * arene_scenario = NULL;
+
+static bool memoire_pool_ajouter_bloc(POOL * pool, int nb);
+
+void * memoire_allouer(size_t taille)
+{
+    atomic_fetch_add_explicit(&nb_allocations, 1, memory_order_relaxed);
+    return malloc(taille);
+}
+
+void * memoire_reallouer(void * zone, size_t taille)
+{
+    atomic_fetch_add_explicit(&nb_allocations, 1, memory_order_relaxed);
+    return realloc(zone, taille);
+}
+
+bool memoire_reserver(void ** ptab, int * ptaille, int nb, 
+                      size_t taille_element)
+{
+    int taille = *ptaille ? *ptaille : NB_MIN_BLOC;
+    void * tab = NULL;
+    
+    if(nb <= *ptaille)
+        return 1;
+    
+    while(taille < nb)
+        taille *= 2;
+    
+    if(!(tab = memoire_reallouer(*ptab, taille*taille_element)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+    *ptab = tab;
+    *ptaille = taille;
+    return 1;
+}
+
+unsigned long memoire_get_nb_allocations(void)
+{
+    return atomic_load_explicit(&nb_allocations, memory_order_relaxed);
+}
+
+ARENE * memoire_arene_creer(void)
+{
+    ARENE * arene = NULL;
+    
+    if(!(arene = (ARENE *) memoire_allouer (sizeof(ARENE))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+    
+    arene->premier = NULL;
+    arene->courant = NULL;
+    return arene;
+}
+
+void memoire_arene_detruire(ARENE * arene)
+{
+    MORCEAU * a_retirer = NULL;
+    
+    if(!arene)
+        return;
+    
+    while(arene->premier)
+    {
+        a_retirer = arene->premier;
+        arene->premier = arene->premier->suivant;
+        free(a_retirer);
+    }
+    
+    free(arene);
+}
+
+ARENE * memoire_arene_scenario(void)
+{
+    if(!arene_scenario)
+        arene_scenario = memoire_arene_creer();
+    return arene_scenario;
+}
+
+void * memoire_arene_allouer(ARENE * arene, size_t taille)
+{
+    MORCEAU * morceau = arene->courant;
+    
+    taille = ALIGNER(taille);
+    
+    //les morceaux gardés d'un scénario précédent sont réutilisés avant 
+    //d'en allouer un nouveau, deux fois plus grand que le dernier
+    while(!morceau || morceau->utilise + taille > morceau->taille)
+    {
+        MORCEAU * suivant = morceau ? morceau->suivant : arene->premier;
+        
+        if(!suivant)
+        {
+            size_t taille_morceau = morceau ? 2*morceau->taille 
+                                            : TAILLE_MIN_MORCEAU;
+            
+            if(taille_morceau < taille)
+                taille_morceau = taille;
+            if(!(suivant = (MORCEAU *) memoire_allouer(ALIGNER(sizeof(MORCEAU))
+                                                       + taille_morceau)))
+            {
+                printf("Problème de mémoire dans la fonction %s\n", __func__);
+                return NULL;
+            }
+            
+            suivant->taille = taille_morceau;
+            suivant->suivant = NULL;
+            if(morceau)
+                morceau->suivant = suivant;
+            else
+                arene->premier = suivant;
+        }
+        
+        suivant->utilise = 0;
+        morceau = arene->courant = suivant;
+    }
+    
+    morceau->utilise += taille;
+    return (char *) morceau + ALIGNER(sizeof(MORCEAU)) + morceau->utilise - taille;
+}
+
+void memoire_arene_vider(ARENE * arene)
+{
+    arene->courant = NULL;
+}
+
+POOL * memoire_pool_creer(size_t taille_element, ARENE * arene)
+{
+    POOL * pool = NULL;
+    
+    if(!(pool = (POOL *) memoire_allouer (sizeof(POOL))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+    
+    //un élément rendu doit pouvoir contenir le lien de la liste libre
+    if(taille_element < sizeof(void *))
+        taille_element = sizeof(void *);
+    
+    pool->taille_element = ALIGNER(taille_element);
+    pool->arene = arene;
+    pool->libres = NULL;
+    pool->premier = NULL;
+    pool->dernier = NULL;
+    pool->courant = NULL;
+    pool->nb_utilises = 0;
+    pool->nb_total = 0;
+    pool->nb_pris = 0;
+    return pool;
+}
+
+void memoire_pool_detruire(POOL * pool)
+{
+    BLOC * a_retirer = NULL;
+    
+    if(!pool)
+        return;
+    
+    while(!pool->arene && pool->premier)
+    {
+        a_retirer = pool->premier;
+        pool->premier = pool->premier->suivant;
+        free(a_retirer);
+    }
+    
+    free(pool);
+}
+
+void memoire_pool_vider(POOL * pool)
+{
+    if(pool->arene)
+    {
+        pool->premier = NULL;
+        pool->dernier = NULL;
+        pool->nb_total = 0;
+    }
+    
+    pool->libres = NULL;
+    pool->courant = NULL;
+    pool->nb_utilises = 0;
+    pool->nb_pris = 0;
+}
+
+bool memoire_pool_reserver(POOL * pool, int nb)
+{
+    int disponibles = pool->nb_total - pool->nb_pris;
+    
+    if(nb <= disponibles)
+        return 1;
+    
+    return memoire_pool_ajouter_bloc(pool, nb - disponibles);
+}
+
+void * memoire_pool_prendre(POOL * pool)
+{
+    void * element = NULL;
+    
+    if(pool->libres)
+    {
+        element = pool->libres;
+        pool->libres = *(void **) element;
+    }
+    else
+    {
+        //passe au bloc suivant quand le bloc courant est épuisé
+        while(!pool->courant || pool->nb_utilises == pool->courant->nb)
+        {
+            BLOC * suivant = pool->courant ? pool->courant->suivant : pool->premier;
+            
+            //la capacité double à chaque fois que la réserve est épuisée
+            if(!suivant)
+            {
+                if(!memoire_pool_ajouter_bloc(pool, pool->nb_total))
+                    return NULL;
+                suivant = pool->dernier;
+            }
+            pool->courant = suivant;
+            pool->nb_utilises = 0;
+        }
+        
+        element = (char *) pool->courant + ALIGNER(sizeof(BLOC)) + 
+                  pool->nb_utilises*pool->taille_element;
+        pool->nb_utilises++;
+    }
+    
+    pool->nb_pris++;
+    return element;
+}
+
+void memoire_pool_rendre(POOL * pool, void * element)
+{
+    *(void **) element = pool->libres;
+    pool->libres = element;
+    pool->nb_pris--;
+}
+
+//---------------------------------------------------------------------
+// ajoute à la fin de la réserve un bloc d'au moins nb éléments, pris dans
+// l'arène de la réserve ou sur le tas
+static bool memoire_pool_ajouter_bloc(POOL * pool, int nb)
+{
+    BLOC * bloc = NULL;
+    size_t taille;
+    
+    if(nb < NB_MIN_BLOC)
+        nb = NB_MIN_BLOC;
+    taille = ALIGNER(sizeof(BLOC)) + nb*pool->taille_element;
+    
+    if(!(bloc = (BLOC *) (pool->arene ? memoire_arene_allouer(pool->arene, taille)
+                                      : memoire_allouer(taille))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+    
+    bloc->nb = nb;
+    bloc->suivant = NULL;
+    if(pool->dernier)
+        pool->dernier->suivant = bloc;
+    else
+        pool->premier = bloc;
+    pool->dernier = bloc;
+    pool->nb_total += nb;
+    return 1;
+}
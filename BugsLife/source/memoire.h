@@ -0,0 +1,89 @@
+/*!
+ \file memoire.h
+ \brief Module qui met à disposition une arène pour les objets qui vivent
+  le temps d'un scénario, des réserves d'éléments de taille fixe recyclés
+  par liste libre et un compteur des allocations sur le tas
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef MEMOIRE_H
+#define MEMOIRE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef struct Arene ARENE;
+
+typedef struct Pool POOL;
+
+//---------------------------------------------------------------------
+// alloue une zone sur le tas et incrémente le compteur d'allocations ;
+// peut être appelée depuis n'importe quel fil
+void * memoire_allouer(size_t taille);
+
+//---------------------------------------------------------------------
+// réalloue une zone sur le tas et incrémente le compteur d'allocations
+void * memoire_reallouer(void * zone, size_t taille);
+
+//---------------------------------------------------------------------
+// agrandit si nécessaire le tableau *ptab pour qu'il contienne au moins
+// nb éléments de taille taille_element ; la taille double à chaque fois
+bool memoire_reserver(void ** ptab, int * ptaille, int nb, 
+                      size_t taille_element);
+
+//---------------------------------------------------------------------
+// retourne le nombre d'allocations faites sur le tas depuis le lancement
+// par la simulation, la lecture et les index ; les fils d'écriture des
+// enregistrements allouent sans passer par ce module
+unsigned long memoire_get_nb_allocations(void);
+
+//---------------------------------------------------------------------
+// crée une arène vide
+ARENE * memoire_arene_creer(void);
+
+//---------------------------------------------------------------------
+// libère l'arène et tous ses morceaux
+void memoire_arene_detruire(ARENE * arene);
+
+//---------------------------------------------------------------------
+// retourne l'arène des objets du scénario, créée au premier appel
+ARENE * memoire_arene_scenario(void);
+
+//---------------------------------------------------------------------
+// découpe une zone alignée dans l'arène, qui grandit si nécessaire
+void * memoire_arene_allouer(ARENE * arene, size_t taille);
+
+//---------------------------------------------------------------------
+// rend toute l'arène réutilisable en temps constant ; les morceaux déjà
+// alloués sont gardés pour le scénario suivant
+void memoire_arene_vider(ARENE * arene);
+
+//---------------------------------------------------------------------
+// crée une réserve vide d'éléments de taille taille_element dont les
+// blocs sont pris dans l'arène, ou sur le tas si arene vaut NULL
+POOL * memoire_pool_creer(size_t taille_element, ARENE * arene);
+
+//---------------------------------------------------------------------
+// libère la réserve et ses blocs pris sur le tas
+void memoire_pool_detruire(POOL * pool);
+
+//---------------------------------------------------------------------
+// rend tous les éléments de la réserve en temps constant ; les blocs
+// pris dans une arène sont abandonnés avec elle
+void memoire_pool_vider(POOL * pool);
+
+//---------------------------------------------------------------------
+// garantit que nb éléments de plus pourront être pris sans allocation
+bool memoire_pool_reserver(POOL * pool, int nb);
+
+//---------------------------------------------------------------------
+// prend un élément dans la réserve, en l'agrandissant si elle est vide
+void * memoire_pool_prendre(POOL * pool);
+
+//---------------------------------------------------------------------
+// rend un élément pris dans la réserve pour qu'il soit réutilisé
+void memoire_pool_rendre(POOL * pool, void * element);
+
+#endif
@@ -0,0 +1,336 @@
+/*!
+ \file micro.c
+ \brief Module principal des microbenchmarks : mesure le coût d'un appel
+  de chaque fonction de recherche sur un scénario synthétique de taille
+  choisie (micro.x, objets ordinaires), et le nombre de ses appels par
+  mise à jour (micro_compte.x, objets compilés avec -DCOMPTEURS)
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "constantes.h"
+#include "aleatoire.h"
+#include "binaire.h"
+#include "empreinte.h"
+#include "compteur.h"
+#include "generateur.h"
+#include "utilitaire.h"
+#include "fourmi.h"
+#include "fourmiliere.h"
+#include "nourriture.h"
+#include "modele.h"
+
+#define NB_UPDATES_COMPTES 10 // mises à jour dont les appels sont comptés
+#define DUREE_MIN 0.2 // secondes de mesure de chaque fonction au moins
+#define NB_POINTS 1024 // arguments tirés, parcourus en boucle
+#define DISTANCE_MAX 4. // distance de fourmi_etrangere_plus_proche
+#define FICHIER_SCENARIO "micro_scenario.txt"
+// appels par mise à jour écrits par micro_compte.x et lus par micro.x
+#define FICHIER_APPELS "micro_appels.txt"
+#define TAILLE_ENTETE 128
+// les compteurs suivants comptent des évènements et non des fonctions
+#define NB_FONCTIONS COMPTEUR_CANDIDAT_REJETE
+
+//arguments tirés une fois pour toutes : le tirage n'est pas mesuré
+static double tab_x[NB_POINTS], tab_y[NB_POINTS], tab_distance[NB_POINTS];
+static unsigned tab_f[NB_POINTS], tab_o[NB_POINTS];
+//reçoit les résultats pour que les appels ne soient pas supprimés
+static volatile double puits = 0;
+
+//---------------------------------------------------------------------
+// compte les appels de chaque fonction sur de vraies mises à jour, les
+// affiche et les écrit dans FICHIER_APPELS précédés de l'entête du
+// scénario
+static bool micro_compter(const char * entete);
+
+//---------------------------------------------------------------------
+// mesure chaque fonction et l'affiche avec ses appels par mise à jour
+// lus dans FICHIER_APPELS, s'ils ont été comptés pour le même scénario
+static void micro_chronometrer(const char * entete, long nb_fourmis);
+
+//---------------------------------------------------------------------
+// lit les appels par mise à jour comptés pour le scénario entete ;
+// renvoie 0 si le fichier est absent ou compte un autre scénario
+static bool micro_lire_appels(const char * entete,
+                              double tab_appels[NB_COMPTEURS]);
+
+//---------------------------------------------------------------------
+// tire les arguments des fonctions mesurées
+static void micro_tirer_arguments(long nb_fourmis);
+
+//---------------------------------------------------------------------
+// appelle noyau jusqu'à ce que la mesure dure DUREE_MIN et retourne la
+// durée d'un appel en nanosecondes
+static double micro_mesurer(void (*noyau)(int i));
+
+//---------------------------------------------------------------------
+// appels mesurés, avec les arguments tirés d'indice i
+static void micro_calcul_norme(int i);
+static void micro_distance_point_droite(int i);
+static void micro_nourriture_la_plus_proche(int i);
+static void micro_nourriture_deja_prise(int i);
+static void micro_etrangere_plus_proche(int i);
+static void micro_sur_chemin(int i);
+static void micro_ouvriere_collision(int i);
+static void micro_nourriture_superposition(int i);
+
+//fonction mesurée pour chaque compteur
+static void (* const tab_noyau[NB_FONCTIONS])(int i) = {
+    micro_calcul_norme, micro_distance_point_droite,
+    micro_nourriture_la_plus_proche, micro_nourriture_deja_prise,
+    micro_etrangere_plus_proche, micro_sur_chemin, micro_ouvriere_collision,
+    micro_nourriture_superposition};
+
+int main(int argc, char *argv[])
+{
+    int famille = argc > 1 ? generateur_famille(argv[1]) : UNIFORME;
+    long nb_fourmis = argc > 2 ? atol(argv[2]) : 1000;
+    char entete[TAILLE_ENTETE];
+    bool reussi = true;
+    int i;
+
+    if(argc > 4 || famille < 0 || nb_fourmis <= 0 ||
+       (argc == 4 && strcmp(argv[3], "lot") && strcmp(argv[3], "cache")))
+    {
+        printf("erreur : usage : '././%s [uniforme|groupee|riche|"
+               "affamee|guerre] [nb_fourmis] [lot|cache]'\n",
+               compteur_actif() ? "micro_compte.x" : "micro.x");
+        return EXIT_FAILURE;
+    }
+
+    if(!generateur_ecrire(FICHIER_SCENARIO, famille, nb_fourmis) ||
+       !modele_lecture((char *) FICHIER_SCENARIO, FINAL))
+    {
+        printf("Scénario %s de %ld fourmis illisible\n",
+               generateur_nom(famille), nb_fourmis);
+        remove(FICHIER_SCENARIO);
+        return EXIT_FAILURE;
+    }
+    remove(FICHIER_SCENARIO);
+
+    //les remplaçants indexés de la recherche linéaire, pour comparer ; le
+    //cache du but, actif par défaut, n'est gardé que sur demande
+    if(argc == 4 && !strcmp(argv[3], "lot"))
+        fourmi_set_affectation_lot(true);
+    fourmi_set_cache_but(argc == 4 && !strcmp(argv[3], "cache"));
+
+    snprintf(entete, TAILLE_ENTETE, "%s, %ld fourmis%s%s",
+             generateur_nom(famille), nb_fourmis, argc == 4 ? ", " : "",
+             argc == 4 ? argv[3] : "");
+    printf("%s\n", entete);
+
+    //les deux programmes font les mêmes mises à jour : les fonctions sont
+    //mesurées sur l'état où leurs appels ont été comptés. Un appel compté
+    //coûte un incrément de plus : les durées viennent des objets
+    //ordinaires
+    aleatoire_semer(GENERATEUR_GRAINE);
+    if(compteur_actif())
+        reussi = micro_compter(entete);
+    else
+    {
+        for(i=0 ; i<NB_UPDATES_COMPTES ; i++)
+            modele_update(true, false);
+        micro_chronometrer(entete, nb_fourmis);
+    }
+
+    modele_nettoyer();
+    return reussi ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool micro_compter(const char * entete)
+{
+    FILE * fappels = NULL;
+    double appels;
+    int c, i;
+
+    compteur_vider();
+    for(i=0 ; i<NB_UPDATES_COMPTES ; i++)
+        modele_update(true, false);
+
+    if(!(fappels = fopen(FICHIER_APPELS, "w")))
+    {
+        printf("Impossible d'écrire %s\n", FICHIER_APPELS);
+        return 0;
+    }
+    fprintf(fappels, "%s\n", entete);
+
+    printf("%-34s %14s\n", "fonction", "appels/update");
+    for(c=0 ; c<NB_COMPTEURS ; c++)
+    {
+        appels = (double) compteur_lire(c)/NB_UPDATES_COMPTES;
+        fprintf(fappels, "%.17g\n", appels);
+        printf("%-34s %14.1f\n", compteur_nom(c), appels);
+    }
+
+    fclose(fappels);
+    return 1;
+}
+
+static void micro_chronometrer(const char * entete, long nb_fourmis)
+{
+    double tab_appels[NB_COMPTEURS];
+    bool appels_lus = micro_lire_appels(entete, tab_appels);
+    TAMPON * etat = binaire_creer();
+    LECTURE_BINAIRE lecture;
+    EMPREINTE empreinte;
+    uint64_t reference;
+    int c;
+
+    micro_tirer_arguments(nb_fourmis);
+
+    //certaines fonctions, comme fourmi_ouvriere_collision, modifient les
+    //fourmis : le monde est repris tel qu'il était avant la suivante
+    if(etat)
+        modele_ecriture_instantane(etat);
+    modele_empreinte(&empreinte, NULL);
+    reference = empreinte_totale(&empreinte);
+
+    if(!appels_lus)
+        printf("appels inconnus : lancer d'abord micro_compte.x avec les "
+               "mêmes arguments\n");
+    printf("%-34s %12s %14s %14s\n", "fonction", "ns/appel", "appels/update",
+           "us/update");
+    for(c=0 ; c<NB_FONCTIONS ; c++)
+    {
+        double duree = micro_mesurer(tab_noyau[c]);
+
+        if(appels_lus)
+            printf("%-34s %12.1f %14.1f %14.1f\n", compteur_nom(c), duree,
+                   tab_appels[c], duree*tab_appels[c]*1e-3);
+        else
+            printf("%-34s %12.1f\n", compteur_nom(c), duree);
+
+        modele_empreinte(&empreinte, NULL);
+        if(etat && empreinte_totale(&empreinte) != reference)
+        {
+            modele_nettoyer();
+            lecture = binaire_lecture(etat);
+            if(!modele_lecture_instantane(&lecture))
+                printf("Impossible de reprendre le monde après %s\n",
+                       compteur_nom(c));
+        }
+    }
+    if(appels_lus)
+        for(c=NB_FONCTIONS ; c<NB_COMPTEURS ; c++)
+            printf("%-34s %12s %14.1f\n", compteur_nom(c), "", tab_appels[c]);
+
+    binaire_detruire(etat);
+}
+
+static bool micro_lire_appels(const char * entete,
+                              double tab_appels[NB_COMPTEURS])
+{
+    FILE * fappels = NULL;
+    char ligne[TAILLE_ENTETE];
+    bool reussi;
+    int c;
+
+    if(!(fappels = fopen(FICHIER_APPELS, "r")))
+        return 0;
+
+    if((reussi = fgets(ligne, TAILLE_ENTETE, fappels) != NULL))
+    {
+        ligne[strcspn(ligne, "\n")] = '\0';
+        reussi = !strcmp(ligne, entete);
+    }
+    for(c=0 ; reussi && c<NB_COMPTEURS ; c++)
+        reussi = fscanf(fappels, "%lf", &tab_appels[c]) == 1;
+
+    fclose(fappels);
+    return reussi;
+}
+
+static void micro_tirer_arguments(long nb_fourmis)
+{
+    int nb_fourmiliere = fourmiliere_get_nb() > 0 ? fourmiliere_get_nb() : 1;
+    int i;
+
+    for(i=0 ; i<NB_POINTS ; i++)
+    {
+        tab_x[i] = (2.*aleatoire_tirer()/ALEATOIRE_MAX - 1)*DMAX;
+        tab_y[i] = (2.*aleatoire_tirer()/ALEATOIRE_MAX - 1)*DMAX;
+        tab_distance[i] = DISTANCE_MAX*aleatoire_tirer()/ALEATOIRE_MAX;
+        tab_f[i] = aleatoire_tirer()%nb_fourmiliere;
+        tab_o[i] = 1 + aleatoire_tirer()%nb_fourmis;
+    }
+}
+
+static double micro_mesurer(void (*noyau)(int i))
+{
+    long nb = 1, i;
+    double debut, duree;
+
+    while(true)
+    {
+        debut = compteur_horloge();
+        for(i=0 ; i<nb ; i++)
+            noyau(i%NB_POINTS);
+        duree = compteur_horloge() - debut;
+
+        if(duree >= DUREE_MIN)
+            return duree*1e9/nb;
+        nb *= 2;
+    }
+}
+
+static void micro_calcul_norme(int i)
+{
+    int j = (i + 1)%NB_POINTS;
+
+    puits += utilitaire_calcul_norme(tab_x[i], tab_x[j], tab_y[i], tab_y[j]);
+}
+
+static void micro_distance_point_droite(int i)
+{
+    int j = (i + 1)%NB_POINTS, k = (i + 2)%NB_POINTS;
+
+    puits += utilitaire_distance_point_droite(tab_x[i], tab_x[j], tab_y[i],
+                                              tab_y[j], tab_x[k], tab_y[k]);
+}
+
+static void micro_nourriture_la_plus_proche(int i)
+{
+    double x, y;
+
+    puits += nourriture_la_plus_proche(tab_x[i], tab_y[i], &x, &y, tab_f[i],
+                                       tab_o[i]);
+}
+
+static void micro_nourriture_deja_prise(int i)
+{
+    puits += fourmi_nourriture_deja_prise(tab_f[i], tab_o[i], tab_x[i],
+                                          tab_y[i]);
+}
+
+static void micro_etrangere_plus_proche(int i)
+{
+    puits += fourmi_etrangere_plus_proche(tab_f[i], tab_x[i], tab_y[i],
+                                          tab_distance[i]);
+}
+
+static void micro_sur_chemin(int i)
+{
+    int j = (i + 1)%NB_POINTS;
+
+    puits += fourmiliere_sur_chemin(tab_x[i], tab_x[j], tab_y[i], tab_y[j],
+                                    tab_f[i]);
+}
+
+static void micro_ouvriere_collision(int i)
+{
+    //la première ouvrière est comparée à toutes les autres fourmis ; les
+    //contacts qu'elle marque ne changent pas les comparaisons suivantes,
+    //et micro_chronometrer reprend le monde ensuite
+    if(fourmi_get_tete_ouvriere())
+        fourmi_ouvriere_collision(fourmi_get_tete_ouvriere());
+}
+
+static void micro_nourriture_superposition(int i)
+{
+    puits += nourriture_superposition(tab_x[i], tab_y[i]);
+}
@@ -11,19 +11,84 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <limits.h>
 #include "constantes.h"
 #include "error.h"
 #include "fourmi.h"
 #include "fourmiliere.h"
 #include "nourriture.h"
+#include "memoire.h"
+#include "lecteur.h"
+#include "binaire.h"
+#include "aleatoire.h"
+#include "persistance.h"
+#include "sauvegarde.h"
+#include "enregistreur.h"
+#include "trajectoire.h"
+#include "compteur.h"
+#include "traceur.h"
+#include "materiel.h"
+#include "histogramme.h"
 #include "modele.h"
 
+#define SEUIL_LECTURE_PARALLELE 20000 // lignes utiles avant de préparer
+
+// instantané binaire : signature, version puis une section par module,
+// chacune repérée par quatre lettres lues en petit-boutiste
+#define SIGNATURE_INSTANTANE "BUGSLIFE"
+#define TAILLE_SIGNATURE 8
+#define VERSION_INSTANTANE 2
+#define EXTENSION_INSTANTANE ".bin"
+#define SECTION_MODELE 0x4C444F4D // "MODL"
+#define SECTION_FOURMILIERE 0x4C4D5246 // "FRML"
+#define SECTION_OUVRIERE 0x5256554F // "OUVR"
+#define SECTION_GARDE 0x44524147 // "GARD"
+#define SECTION_NOURRITURE 0x52554F4E // "NOUR"
+
+// cache d'un scénario texte : même format, l'état de la simulation est
+// remplacé par l'empreinte du texte et celle des sections qui suivent ;
+// il est rangé à côté du texte, sous son nom suivi de l'extension
+#define EXTENSION_CACHE ".cache"
+#define SECTION_CACHE 0x48434143 // "CACH"
+
+// état persistant : l'instantané est validé dans le fichier toutes les
+// PERIODE_PERSISTANCE mises à jour par défaut, et à sa fermeture
+#define EXTENSION_PERSISTANCE ".monde"
+#define PERIODE_PERSISTANCE 10
+
 enum Etat_lecture {ETAT_NB_FOURMILIERE, ETAT_FOURMILIERE, ETAT_OUVRIERE,
     ETAT_GARDE, ETAT_FIN_FOURMILIERE, ETAT_NB_NOURRITURE,
     ETAT_NOURRITURE, ETAT_FIN_NOURRITURE};
 
 static int etat = ETAT_NB_FOURMILIERE;
 static int nb_update = 0; //Nombre de mises à jour
+static unsigned long nb_update_scenario = 0; //depuis la lecture du scénario
+static bool scenario_verifie = false; //repris d'un cache déjà vérifié
+static char * nom_cache = NULL; //cache à écrire après la vérification
+static uint64_t empreinte_scenario = 0;
+static PERSISTANCE * persistance = NULL; //état validé périodiquement
+static TAMPON * tampon_persistance = NULL;
+static int nb_depuis_persistance = 0; //mises à jour pas encore validées
+static int periode_persistance = PERIODE_PERSISTANCE;
+static SAUVEGARDE * sauvegarde = NULL; //points de reprise périodiques
+static int periode_sauvegarde = 0;
+static int nb_depuis_sauvegarde = 0;
+static ENREGISTREUR * enregistreur = NULL; //évolution des fourmilières
+static char * nom_enregistrement = NULL;
+static TRAJECTOIRE * trajectoire = NULL; //positions de chaque entité
+static RELECTURE * relecture = NULL; //trajectoires rejouées
+static HISTOGRAMME * latences = NULL; //durées des mises à jour
+static double budget_update = 0; //durée signalée au-delà, en secondes
+
+static const PREPARATION preparation_ouvriere = {" %u %lf %lf %lf %lf %d", false};
+static const PREPARATION preparation_garde = {"%u %lf %lf", true};
+static const PREPARATION preparation_nourriture = {" %lf %lf", true};
+
+// compiler avec -DDEBUG_MEMOIRE pour signaler les mises à jour qui
+// allouent encore sur le tas une fois les réserves dimensionnées
+#ifdef DEBUG_MEMOIRE
+static unsigned long nb_tick = 0;
+#endif
 
 bool modele_lecture(char * nom_fichier, PRGMMODE nom_mode)
 {
@@ -32,29 +97,65 @@ bool modele_lecture(char * nom_fichier, PRGMMODE nom_mode)
     // des indices sont initialisés a -1 pour ne pas entrer dans les
     // conditions d'erreur lorsque le nombre d'entités est égal à 1
     int nbO, nbG, nb_fourmiliere, nb_nourriture,  f = -1, o, g, n = -1;
+    int i, nb_lignes;
     double centre_x, centre_y, rayon_fourmiliere;
     bool fin_ligne = false;
-    char tab[MAX_LINE];
-    FILE * fichier = NULL;
+    LECTEUR * lecteur = NULL;
+    CURSEUR * lignes = NULL;
     
-    if((fichier = fopen(nom_fichier,"r")))
+    scenario_verifie = false;
+    free(nom_cache);
+    nom_cache = NULL;
+    modele_fermer_persistance();
+    nb_update_scenario = 0;
+    
+    if(binaire_commence_par(nom_fichier, SIGNATURE_INSTANTANE, TAILLE_SIGNATURE))
+        return modele_lecture_binaire(nom_fichier, nom_mode);
+    if(persistance_reconnaitre(nom_fichier))
+        return modele_lecture_persistance(nom_fichier, nom_mode);
+    
+    if((lecteur = lecteur_ouvrir(nom_fichier)))
     {
-        while(fgets(tab, MAX_LINE, fichier))
+        //le texte reste la référence : le cache n'est repris que s'il a
+        //été écrit pour exactement ce contenu
+        empreinte_scenario = lecteur_empreinte(lecteur);
+        if(modele_lecture_cache(nom_fichier, empreinte_scenario))
         {
-            char premier_char[2];
-            if((strstr(tab,"#")) || (sscanf(tab,"%1s", premier_char) != 1))
-                continue;
-            
-            if(!modele_automate_lecture(tab, &nbO, &nbG, &centre_x,
+            lecteur_fermer(lecteur);
+            if(nom_mode == ERROR)
+                error_success();
+            return 1;
+        }
+        nom_cache = modele_nom_cache(nom_fichier);
+        
+        if((nb_lignes = modele_lignes_utiles(lecteur, &lignes)) < 0)
+        {
+            lecteur_fermer(lecteur);
+            return 0;
+        }
+        
+        if(nb_lignes >= SEUIL_LECTURE_PARALLELE)
+            modele_preparer_lignes(lecteur, lignes, nb_lignes);
+        
+        for(i=0 ; i<nb_lignes ; i++)
+        {
+            if(!modele_automate_lecture(&lignes[i], &nbO, &nbG, &centre_x,
                                         &centre_y, &rayon_fourmiliere, &f, &o, &g,
                                         &n, &nb_fourmiliere, &nb_nourriture, 
                                         &fin_ligne))
+            {
+                free(lignes);
+                lecteur_fermer(lecteur);
                 return 0;
+            }
             
             fourmiliere_set_nb(nb_fourmiliere);
             nourriture_set_nb(nb_nourriture);
         }
         
+        free(lignes);
+        lecteur_fermer(lecteur);
+        
         if(etat != ETAT_FIN_NOURRITURE)
         {
             error_fichier_incomplet();
@@ -71,11 +172,165 @@ bool modele_lecture(char * nom_fichier, PRGMMODE nom_mode)
         return 0;
     }
     
-    fclose(fichier);
     return 1;
 }
 
-bool modele_automate_lecture(char * tab, int * pnbO, int * pnbG,
+bool modele_lecture_binaire(const char * nom_fichier, PRGMMODE nom_mode)
+{
+    TAMPON * tampon = NULL;
+    LECTURE_BINAIRE lecture;
+    bool reussi;
+    
+    if(!(tampon = binaire_creer()))
+        return 0;
+    
+    if(!binaire_charger(tampon, nom_fichier))
+    {
+        binaire_detruire(tampon);
+        error_fichier_inexistant();
+        return 0;
+    }
+    
+    lecture = binaire_lecture(tampon);
+    reussi = modele_lecture_instantane(&lecture);
+    
+    binaire_detruire(tampon);
+    
+    if(!reussi)
+    {
+        printf("Instantané invalide : %s\n", nom_fichier);
+        return 0;
+    }
+    
+    etat = ETAT_FIN_NOURRITURE;
+    if(nom_mode == ERROR)
+        error_success();
+    return 1;
+}
+
+bool modele_lecture_persistance(const char * nom_fichier, PRGMMODE nom_mode)
+{
+    LECTURE_BINAIRE lecture;
+    
+    if(!(persistance = persistance_ouvrir(nom_fichier, false)))
+    {
+        error_fichier_inexistant();
+        return 0;
+    }
+    
+    //l'état est relu directement dans la projection, sans copie
+    if(!persistance_dernier_etat(persistance, &lecture) ||
+       !modele_lecture_instantane(&lecture))
+    {
+        printf("État persistant invalide : %s\n", nom_fichier);
+        modele_fermer_persistance();
+        return 0;
+    }
+    
+    etat = ETAT_FIN_NOURRITURE;
+    if(nom_mode == ERROR)
+        error_success();
+    return 1;
+}
+
+bool modele_lecture_instantane(LECTURE_BINAIRE * lecture)
+{
+    LECTURE_BINAIRE section;
+    
+    if(!modele_lecture_entete(lecture) ||
+       !binaire_section(lecture, SECTION_MODELE, &section))
+        return 0;
+    
+    nb_update = binaire_lire_entier32(&section);
+    return aleatoire_lecture_binaire(&section) &&
+           modele_lecture_sections(lecture, true);
+}
+
+bool modele_lecture_cache(const char * nom_fichier, uint64_t empreinte)
+{
+    LECTEUR * lecteur = NULL;
+    LECTURE_BINAIRE lecture, section;
+    char * nom = NULL;
+    bool reussi = false;
+    
+    if(!(nom = modele_nom_cache(nom_fichier)))
+        return 0;
+    
+    //projeté comme le texte : les sections sont lues sans copie
+    if((lecteur = lecteur_ouvrir(nom)))
+    {
+        lecture = lecteur_lecture_binaire(lecteur);
+        if(modele_lecture_entete(&lecture) &&
+           binaire_section(&lecture, SECTION_CACHE, &section) &&
+           binaire_lire_entier64(&section) == empreinte &&
+           binaire_lire_entier64(&section) == binaire_empreinte(&lecture) &&
+           !section.erreur)
+        {
+            //un cache à jour mais abîmé laisse un scénario partiel : il
+            //est effacé et le texte est relu
+            if(!(reussi = modele_lecture_sections(&lecture, false)))
+                modele_nettoyer();
+        }
+    }
+    
+    lecteur_fermer(lecteur);
+    free(nom);
+    
+    if(reussi)
+    {
+        etat = ETAT_FIN_NOURRITURE;
+        scenario_verifie = true;
+    }
+    return reussi;
+}
+
+bool modele_lecture_entete(LECTURE_BINAIRE * lecture)
+{
+    char signature[TAILLE_SIGNATURE];
+    
+    binaire_lire_octets(lecture, signature, TAILLE_SIGNATURE);
+    return !memcmp(signature, SIGNATURE_INSTANTANE, TAILLE_SIGNATURE) &&
+           binaire_lire_entier32(lecture) == VERSION_INSTANTANE;
+}
+
+bool modele_lecture_sections(LECTURE_BINAIRE * lecture, bool reprise)
+{
+    LECTURE_BINAIRE section;
+    
+    //les sections sont lues dans l'ordre où elles ont été écrites ; une
+    //section inconnue d'une version ultérieure est passée
+    return binaire_section(lecture, SECTION_FOURMILIERE, &section) &&
+           fourmiliere_lecture_binaire(&section, reprise) &&
+           binaire_section(lecture, SECTION_OUVRIERE, &section) &&
+           fourmi_ouvriere_lecture_binaire(&section) &&
+           binaire_section(lecture, SECTION_GARDE, &section) &&
+           fourmi_garde_lecture_binaire(&section) &&
+           binaire_section(lecture, SECTION_NOURRITURE, &section) &&
+           nourriture_lecture_binaire(&section);
+}
+
+char * modele_nom_cache(const char * nom_fichier)
+{
+    char * nom = NULL;
+    size_t taille;
+    
+    if(getenv(VARIABLE_SANS_CACHE))
+        return NULL;
+    
+    //le nom du scénario suivi de l'extension : le cache suit le texte
+    //quand il est déplacé ou copié
+    taille = strlen(nom_fichier) + strlen(EXTENSION_CACHE) + 1;
+    if(!(nom = (char *) malloc (taille)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+    
+    snprintf(nom, taille, "%s%s", nom_fichier, EXTENSION_CACHE);
+    return nom;
+}
+
+bool modele_automate_lecture(CURSEUR * ligne, int * pnbO, int * pnbG,
                              double * pcentre_x, double * pcentre_y,
                              double * prayon_fourmiliere, int * pf, int * po,
                              int * pg, int * pn, int * pnb_fourmiliere,
@@ -84,55 +339,57 @@ bool modele_automate_lecture(char * tab, int * pnbO, int * pnbG,
     switch(etat)
     {
         case ETAT_NB_FOURMILIERE :
-            if(!modele_etat_nb_fourmiliere(tab, pnb_fourmiliere))
+            if(!modele_etat_nb_fourmiliere(ligne, pnb_fourmiliere))
                 return 0;
             break;
             
         case ETAT_FOURMILIERE :
-            if(!modele_etat_fourmiliere(tab, pnbO, pnbG, pcentre_x, pcentre_y,
+            if(!modele_etat_fourmiliere(ligne, pnbO, pnbG, pcentre_x, pcentre_y,
                                         prayon_fourmiliere, pf, po, pg, 
                                         *pnb_fourmiliere))
                 return 0;
             break;
             
         case ETAT_OUVRIERE :
-            if(!modele_etat_ouvriere(tab, *pnbO, *pnbG, *pf, po, *pnb_fourmiliere))
+            if(!modele_etat_ouvriere(ligne, *pnbO, *pnbG, *pf, po, *pnb_fourmiliere))
                 return 0;
             break;
             
         case ETAT_GARDE :
-            if(!modele_etat_garde(tab, *pnbG, *pf, pg, pfin_ligne, *pcentre_x,
+            if(!modele_etat_garde(ligne, *pnbG, *pf, pg, pfin_ligne, *pcentre_x,
                                   *pcentre_y, *prayon_fourmiliere, *pnb_fourmiliere))
                 return 0;
             break;
             
         case ETAT_FIN_FOURMILIERE :
-            if(!modele_etat_fin_fourmiliere(tab, *pf, *pnb_fourmiliere))
+            if(!modele_etat_fin_fourmiliere(ligne, *pf, *pnb_fourmiliere))
                 return 0;
             break;
             
         case ETAT_NB_NOURRITURE:
-            modele_etat_nb_nourriture(tab, pnb_nourriture);
+            modele_etat_nb_nourriture(ligne, pnb_nourriture);
             break;
             
         case ETAT_NOURRITURE:
-            if(!modele_etat_nourriture(tab, *pnb_nourriture, pn, pfin_ligne))
+            if(!modele_etat_nourriture(ligne, *pnb_nourriture, pn, pfin_ligne))
                 return 0;
             break;
     }
     return 1;
 }
 
-bool modele_etat_nb_fourmiliere(char * tab, int * pnb_fourmiliere)
+bool modele_etat_nb_fourmiliere(CURSEUR * ligne, int * pnb_fourmiliere)
 {
-    sscanf(tab, "%d", pnb_fourmiliere);
+    lecteur_scanner(ligne, "%d", pnb_fourmiliere);
     
-    if(fourmiliere_get_nb() > MAX_FOURMILIERE)
+    if(*pnb_fourmiliere > MAX_FOURMILIERE)
     {
         error_nb_fourmiliere(*pnb_fourmiliere);
         return 0;
     }
     
+    fourmiliere_reserver(*pnb_fourmiliere);
+    
     if(!*pnb_fourmiliere)
         etat = ETAT_NB_NOURRITURE;
     else etat = ETAT_FOURMILIERE;
@@ -140,17 +397,20 @@ bool modele_etat_nb_fourmiliere(char * tab, int * pnb_fourmiliere)
     return 1;
 }
 
-bool modele_etat_fourmiliere(char * tab, int * pnbO, int * pnbG,
+bool modele_etat_fourmiliere(CURSEUR * ligne, int * pnbO, int * pnbG,
                              double * pcentre_x, double * pcentre_y,
                              double * prayon_fourmiliere, int * pf,
                              int * po, int * pg, int nb_fourmiliere)
 {
     (*pf)++;
     
-    if(!fourmiliere_lecture(tab, *pf, pnbO, pnbG, pcentre_x, pcentre_y,
+    if(!fourmiliere_lecture(ligne, *pf, pnbO, pnbG, pcentre_x, pcentre_y,
                             prayon_fourmiliere))
         return 0;
     
+    fourmi_ouvriere_reserver(*pnbO);
+    fourmi_garde_reserver(*pnbG);
+    
     if(*pnbO)
         etat = ETAT_OUVRIERE;
     if(!*pnbO && *pnbG)
@@ -164,10 +424,10 @@ bool modele_etat_fourmiliere(char * tab, int * pnbO, int * pnbG,
     return 1;
 }
 
-bool modele_etat_ouvriere(char * tab, int nbO, int nbG, int f, int * po,
+bool modele_etat_ouvriere(CURSEUR * ligne, int nbO, int nbG, int f, int * po,
                           int nb_fourmiliere)
 {
-    if(!modele_recherche_fin_liste(tab))
+    if(!modele_recherche_fin_liste(ligne))
     {
         (*po)++;
         
@@ -177,7 +437,7 @@ bool modele_etat_ouvriere(char * tab, int nbO, int nbG, int f, int * po,
             return 0;
         }
         
-        if(!fourmi_ouvriere_lecture(tab, *po, f))
+        if(!fourmi_ouvriere_lecture(ligne, *po, f))
             return 0;
         
         etat = ETAT_OUVRIERE;
@@ -199,12 +459,12 @@ bool modele_etat_ouvriere(char * tab, int nbO, int nbG, int f, int * po,
     return 1;
 }
 
-bool modele_etat_garde(char * tab, int nbG, int f, int * pg,
+bool modele_etat_garde(CURSEUR * ligne, int nbG, int f, int * pg,
                        bool * pfin_ligne, double centre_x,
                        double centre_y, double rayon_fourmiliere,
                        int nb_fourmiliere)
 {
-    if(!modele_recherche_fin_liste(tab))
+    if(!modele_recherche_fin_liste(ligne))
     {
         if(*pg == nbG -1 && !*pfin_ligne)
         {
@@ -212,7 +472,7 @@ bool modele_etat_garde(char * tab, int nbG, int f, int * pg,
             return 0;
         }
         
-        if(!fourmi_garde_lecture(tab, f, pg, nbG, centre_x, centre_y, 
+        if(!fourmi_garde_lecture(ligne, f, pg, nbG, centre_x, centre_y, 
 								 rayon_fourmiliere, pfin_ligne))
             return 0;
         
@@ -232,9 +492,9 @@ bool modele_etat_garde(char * tab, int nbG, int f, int * pg,
     return 1;
 }
 
-bool modele_etat_fin_fourmiliere(char * tab, int f, int nb_fourmiliere)
+bool modele_etat_fin_fourmiliere(CURSEUR * ligne, int f, int nb_fourmiliere)
 {
-    if(modele_recherche_fin_liste(tab))
+    if(modele_recherche_fin_liste(ligne))
     {
         if(f < nb_fourmiliere -1)
         {
@@ -253,9 +513,10 @@ bool modele_etat_fin_fourmiliere(char * tab, int f, int nb_fourmiliere)
     return 1;
 }
 
-void modele_etat_nb_nourriture(char * tab, int * pnb_nourriture)
+void modele_etat_nb_nourriture(CURSEUR * ligne, int * pnb_nourriture)
 {
-    sscanf(tab, "%d", pnb_nourriture);
+    lecteur_scanner(ligne, "%d", pnb_nourriture);
+    nourriture_reserver(*pnb_nourriture);
     
     if(!*pnb_nourriture)
         etat = ETAT_FIN_NOURRITURE;
@@ -263,10 +524,10 @@ void modele_etat_nb_nourriture(char * tab, int * pnb_nourriture)
     
 }
 
-bool modele_etat_nourriture(char * tab, int nb_nourriture, int * pn,
+bool modele_etat_nourriture(CURSEUR * ligne, int nb_nourriture, int * pn,
                             bool * pfin_ligne)
 {
-    if(!modele_recherche_fin_liste(tab))
+    if(!modele_recherche_fin_liste(ligne))
     {
         if(*pn == nb_nourriture -1 && !*pfin_ligne)
         {
@@ -274,7 +535,7 @@ bool modele_etat_nourriture(char * tab, int nb_nourriture, int * pn,
             return 0;
         }
         
-        if(!nourriture_lecture(tab, pn, pfin_ligne))
+        if(!nourriture_lecture(ligne, pn, pfin_ligne))
             return 0;
         
         etat = ETAT_NOURRITURE;
@@ -291,32 +552,371 @@ bool modele_etat_nourriture(char * tab, int nb_nourriture, int * pn,
     return 1;
 }
 
-bool modele_recherche_fin_liste(char * chaine) 
+bool modele_recherche_fin_liste(const CURSEUR * ligne) 
 {
-    if(strstr(chaine, "FIN_LISTE"))
+    if(lecteur_ligne_contient(ligne, "FIN_LISTE"))
         return 1;
     return 0;
 }
 
+int modele_lignes_utiles(LECTEUR * lecteur, CURSEUR ** plignes)
+{
+    int nb = 0, taille = 0;
+    CURSEUR ligne;
+    
+    while(lecteur_ligne_suivante(lecteur, &ligne))
+    {
+        if(lecteur_ligne_contient(&ligne, "#") || lecteur_ligne_vide(&ligne))
+            continue;
+        
+        if(!memoire_reserver((void **) plignes, &taille, nb + 1, sizeof(CURSEUR)))
+        {
+            free(*plignes);
+            *plignes = NULL;
+            return -1;
+        }
+        
+        (*plignes)[nb++] = ligne;
+    }
+    
+    return nb;
+}
+
+void modele_preparer_lignes(LECTEUR * lecteur, CURSEUR * lignes, int nb)
+{
+    // mêmes transitions que l'automate, sans les vérifications : après 
+    // une erreur les lignes ne sont plus lues, et une ligne mal repérée 
+    // est simplement relue depuis le texte par lecteur_scanner
+    int section = ETAT_NB_FOURMILIERE, nb_fourmiliere = 0, nb_nourriture = 0;
+    int nbO = 0, nbG = 0, f = -1, i;
+    double x, y;
+    const PREPARATION ** preparations = NULL;
+    
+    if(!(preparations = (const PREPARATION **) calloc (nb, sizeof(PREPARATION *))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return;
+    }
+    
+    for(i=0 ; i<nb ; i++)
+    {
+        CURSEUR ligne = lignes[i];
+        bool fin_liste = modele_recherche_fin_liste(&ligne);
+        
+        switch(section)
+        {
+            case ETAT_NB_FOURMILIERE :
+                if(lecteur_scanner(&ligne, "%d", &nb_fourmiliere) < 1)
+                    i = nb;
+                else section = nb_fourmiliere ? ETAT_FOURMILIERE 
+                                              : ETAT_NB_NOURRITURE;
+                break;
+                
+            case ETAT_FOURMILIERE :
+                f++;
+                if(lecteur_scanner(&ligne, " %lf %lf %d %d", &x, &y, &nbO, 
+                                   &nbG) < 4)
+                    i = nb;
+                else if(nbO)
+                    section = ETAT_OUVRIERE;
+                else if(nbG)
+                    section = ETAT_GARDE;
+                else if(f == nb_fourmiliere -1)
+                    section = ETAT_FIN_FOURMILIERE;
+                break;
+                
+            case ETAT_OUVRIERE :
+                if(!fin_liste)
+                    preparations[i] = &preparation_ouvriere;
+                else if(nbG)
+                    section = ETAT_GARDE;
+                else section = f < nb_fourmiliere -1 ? ETAT_FOURMILIERE 
+                                                     : ETAT_FIN_FOURMILIERE;
+                break;
+                
+            case ETAT_GARDE :
+                if(!fin_liste)
+                    preparations[i] = &preparation_garde;
+                else section = f < nb_fourmiliere -1 ? ETAT_FOURMILIERE 
+                                                     : ETAT_FIN_FOURMILIERE;
+                break;
+                
+            case ETAT_FIN_FOURMILIERE :
+                section = ETAT_NB_NOURRITURE;
+                break;
+                
+            case ETAT_NB_NOURRITURE :
+                if(lecteur_scanner(&ligne, "%d", &nb_nourriture) < 1)
+                    i = nb;
+                else section = nb_nourriture ? ETAT_NOURRITURE 
+                                             : ETAT_FIN_NOURRITURE;
+                break;
+                
+            case ETAT_NOURRITURE :
+                if(!fin_liste)
+                    preparations[i] = &preparation_nourriture;
+                else section = ETAT_FIN_NOURRITURE;
+                break;
+        }
+    }
+    
+    lecteur_preparer_lignes(lecteur, lignes, preparations, nb);
+    free(preparations);
+}
+
 bool modele_verification_rendu2(void)
 {
-    if(!fourmiliere_verification_rendu2())
-        return 0;
-    return 1;
+    bool reussi;
+    
+    //le cache n'est écrit qu'après la vérification : le scénario qu'il
+    //contient n'a plus à être vérifié
+    if(scenario_verifie)
+    {
+        scenario_verifie = false;
+        return 1;
+    }
+    
+    if((reussi = fourmiliere_verification_rendu2()) && nom_cache)
+        modele_ecriture_cache();
+    
+    free(nom_cache);
+    nom_cache = NULL;
+    return reussi;
 }
 
-void modele_update(bool automatic, bool record_active, FILE * fichier)
+void modele_update(bool automatic, bool record_active)
 {
-    if(fichier && record_active)
+    TAMPON * clef = NULL;
+    double debut = compteur_debut_update(), debut_update = debut;
+#ifdef DEBUG_MEMOIRE
+    unsigned long nb_allocations = memoire_get_nb_allocations();
+#endif
+    
+    nb_update_scenario++;
+    if(enregistreur && record_active)
     {
         nb_update++;
-        fourmiliere_ecriture_gnuplot(fichier, nb_update);
+        enregistreur_ligne(enregistreur, nb_update, fourmiliere_get_nb(),
+                           nourriture_get_nb());
+        fourmiliere_enregistrer(enregistreur);
     }
+    compteur_chronometrer(PHASE_ENREGISTREMENT, &debut);
     
     fourmiliere_update();
+    compteur_chronometrer(PHASE_FOURMILIERE, &debut);
     
     if(automatic)
         nourriture_update_automatic_creation();
+    compteur_chronometrer(PHASE_NOURRITURE, &debut);
+    
+    if(trajectoire)
+    {
+        //chaque bloc commence par l'état des fourmilières
+        if((clef = trajectoire_clef(trajectoire)))
+            fourmiliere_ecriture_binaire(clef);
+        fourmi_enregistrer_trajectoire();
+        nourriture_enregistrer_trajectoire();
+        trajectoire_fin_update(trajectoire);
+    }
+    compteur_chronometrer(PHASE_TRAJECTOIRE, &debut);
+    
+    //sérialiser et copier tout le monde coûte plus qu'une mise à jour :
+    //un arrêt brutal perd au plus les dernières mises à jour de la période
+    if(persistance && ++nb_depuis_persistance >= periode_persistance &&
+       !modele_valider_persistance())
+    {
+        printf("Impossible de valider l'état persistant\n");
+        modele_fermer_persistance();
+    }
+    compteur_chronometrer(PHASE_PERSISTANCE, &debut);
+    
+    if(sauvegarde && ++nb_depuis_sauvegarde >= periode_sauvegarde)
+        modele_point_de_reprise();
+    compteur_chronometrer(PHASE_SAUVEGARDE, &debut);
+    compteur_export_update();
+    traceur_intervalle("mise_a_jour", debut_update);
+    if(latences)
+        modele_surveiller(compteur_horloge() - debut_update);
+    
+#ifdef DEBUG_MEMOIRE
+    nb_tick++;
+    if(memoire_get_nb_allocations() != nb_allocations)
+        printf("Mise à jour %lu : %lu allocation(s) sur le tas\n", nb_tick,
+               memoire_get_nb_allocations() - nb_allocations);
+#endif
+}
+
+bool modele_batch(char * nom_fichier, long nb_updates, char * nom_sauvegarde,
+                  char * nom_mesures)
+{
+    double debut, duree;
+    long i;
+    int p, c;
+    
+    //batch.x n'a que ce point d'entrée
+    modele_variantes();
+    
+    //la vérification compare chaque paire d'entités : un scénario sûr ou
+    //généré, correct par construction, peut s'en passer, comme dans
+    //bench.x
+    if(!modele_lecture(nom_fichier, FINAL) ||
+       (!getenv(VARIABLE_CONFIANCE) && !modele_verification_rendu2()))
+    {
+        modele_nettoyer();
+        return 0;
+    }
+    
+    //aucun budget : la durée de chaque mise à jour va seulement dans
+    //l'histogramme
+    modele_surveillance_demarrer(0);
+    
+    //compteurs matériels seulement sur demande : les relever coûte
+    //quelques appels système par étape
+    if(getenv(VARIABLE_MATERIEL) && materiel_ouvrir())
+        compteur_materiel(true);
+    
+    if(nom_mesures && !compteur_export_ouvrir(nom_mesures))
+    {
+        compteur_materiel(false);
+        materiel_fermer();
+        modele_surveillance_arreter();
+        modele_nettoyer();
+        return 0;
+    }
+    compteur_vider();
+    compteur_chronometre(true);
+    debut = compteur_horloge();
+    
+    //création automatique de nourriture, comme le mode par défaut de
+    //l'interface, et aucun enregistrement
+    for(i=0 ; i<nb_updates ; i++)
+        modele_update(true, false);
+    
+    duree = compteur_horloge() - debut;
+    compteur_chronometre(false);
+    if(!compteur_export_fermer())
+        printf("Impossible d'écrire toutes les mesures dans %s\n", nom_mesures);
+    compteur_materiel(false);
+    
+    printf("%ld mises à jour en %.3f s", nb_updates, duree);
+    if(duree > 0)
+        printf(" : %.1f mises à jour par seconde", nb_updates/duree);
+    printf("\n");
+    //les étapes de fourmiliere_update sont détaillées sous fourmilieres
+    for(p=0 ; p<PREMIERE_SOUS_PHASE && nb_updates > 0 ; p++)
+        modele_ecrire_phase(p, "  ", nb_updates, duree);
+    for(p=PREMIERE_SOUS_PHASE ; p<NB_PHASES && nb_updates > 0 && 
+        compteur_actif() ; p++)
+        modele_ecrire_phase(p, "    ", nb_updates, duree);
+    for(c=0 ; c<NB_COMPTEURS && nb_updates > 0 && compteur_actif() ; c++)
+        printf("  %-32s %12.1f par mise à jour\n", compteur_nom(c),
+               (double) compteur_lire(c)/nb_updates);
+    if(materiel_actif() && nb_updates > 0)
+        modele_ecrire_materiel(nb_updates);
+    materiel_fermer();
+    modele_surveillance_arreter();
+    
+    if(nom_sauvegarde)
+        modele_ecriture(nom_sauvegarde);
+    
+    return 1;
+}
+
+void modele_ecrire_phase(int phase, const char * retrait, long nb_updates,
+                         double duree)
+{
+    printf("%s%-*s %10.3f ms %9.3f us/mise à jour %5.1f %%\n", retrait,
+           (int) (20 - strlen(retrait)), compteur_nom_phase(phase),
+           compteur_duree(phase)*1e3, compteur_duree(phase)*1e6/nb_updates,
+           duree > 0 ? 100*compteur_duree(phase)/duree : 0.);
+}
+
+void modele_ecrire_materiel(long nb_updates)
+{
+    int p, e;
+    
+    printf("  %-17s", "par mise à jour");
+    for(e=0 ; e<NB_MATERIEL ; e++)
+        printf(" %19s", materiel_nom(e));
+    printf(" %6s\n", "IPC");
+    
+    for(p=0 ; p<PREMIERE_SOUS_PHASE ; p++)
+    {
+        printf("  %-17s", compteur_nom_phase(p));
+        for(e=0 ; e<NB_MATERIEL ; e++)
+        {
+            if(materiel_disponible(e))
+                printf(" %19.0f", 
+                       (double) compteur_materiel_lire(p, e)/nb_updates);
+            else
+                printf(" %19s", "-");
+        }
+        
+        //instructions par cycle
+        if(materiel_disponible(MATERIEL_CYCLES) && 
+           materiel_disponible(MATERIEL_INSTRUCTIONS) &&
+           compteur_materiel_lire(p, MATERIEL_CYCLES) > 0)
+            printf(" %6.2f\n", 
+                   (double) compteur_materiel_lire(p, MATERIEL_INSTRUCTIONS)/
+                   compteur_materiel_lire(p, MATERIEL_CYCLES));
+        else
+            printf(" %6s\n", "-");
+    }
+}
+
+bool modele_surveillance_demarrer(double budget_ms)
+{
+    if(!latences && !(latences = histogramme_creer()))
+        return 0;
+    
+    budget_update = budget_ms*1e-3;
+    compteur_surveiller(true);
+    return 1;
+}
+
+void modele_set_budget(double budget_ms)
+{
+    budget_update = budget_ms*1e-3;
+}
+
+double modele_latence_centile(double centile)
+{
+    return latences ? histogramme_centile(latences, centile)*1e-6 : 0;
+}
+
+void modele_surveiller(double duree)
+{
+    int p;
+    
+    histogramme_ajouter(latences, (uint64_t) (duree*1e9));
+    if(budget_update <= 0 || duree <= budget_update)
+        return;
+    
+    //l'histogramme couvre tous les scénarios de la session : le numéro
+    //affiché est celui de la mise à jour dans le scénario courant
+    printf("Mise à jour %lu : %.3f ms, budget de %.3f ms dépassé (",
+           nb_update_scenario, duree*1e3, budget_update*1e3);
+    for(p=0 ; p<PREMIERE_SOUS_PHASE ; p++)
+        printf("%s%s %.3f ms", p ? ", " : "", compteur_nom_phase(p),
+               compteur_duree_update(p)*1e3);
+    printf(")\n");
+}
+
+void modele_surveillance_arreter(void)
+{
+    if(!latences)
+        return;
+    
+    if(histogramme_nb(latences))
+    {
+        printf("Durée des %llu mises à jour :\n",
+               (unsigned long long) histogramme_nb(latences));
+        histogramme_ecrire(latences, stdout);
+    }
+    
+    histogramme_detruire(latences);
+    latences = NULL;
+    compteur_surveiller(false);
 }
 
 void modele_nourriture_manual_creation(double x, double y)
@@ -334,17 +934,41 @@ void modele_dessine(void)
 
 void modele_nettoyer(void)
 {
+    //les mises à jour pas encore validées le sont avant que le monde soit
+    //vidé
+    modele_fermer_persistance();
     fourmiliere_vider(); 
     fourmi_vider();
     nourriture_vider();
+    //toutes les réserves ont été vidées : l'arène peut être réutilisée
+    memoire_arene_vider(memoire_arene_scenario());
     fourmiliere_set_nb(0);
     nourriture_set_nb(0);
     etat = ETAT_NB_FOURMILIERE;
+    scenario_verifie = false;
+    free(nom_cache);
+    nom_cache = NULL;
+    nb_update_scenario = 0;
+    //les fourmis du prochain scénario commencent un nouveau bloc
+    if(trajectoire)
+        trajectoire_couper(trajectoire);
 }
 
 void modele_ecriture(char* nom_fichier)
 {
     FILE * fsortie = NULL;
+    
+    if(modele_extension(nom_fichier, EXTENSION_INSTANTANE))
+    {
+        modele_ecriture_binaire(nom_fichier);
+        return;
+    }
+    if(modele_extension(nom_fichier, EXTENSION_PERSISTANCE))
+    {
+        modele_ecriture_persistance(nom_fichier);
+        return;
+    }
+    
     fsortie = fopen((char*) nom_fichier, "w");
     
     fprintf(fsortie, "# Fichier sauvegarde Bug's Life \n\n");
@@ -357,7 +981,381 @@ void modele_ecriture(char* nom_fichier)
     fclose(fsortie);
 }
 
-void modele_recup_info(int tab_info[NB_COLUMNS][NB_LINES]) 
+bool modele_ecriture_binaire(const char * nom_fichier)
+{
+    TAMPON * tampon = NULL;
+    bool reussi;
+    
+    if(!(tampon = binaire_creer()))
+        return 0;
+    
+    modele_ecriture_instantane(tampon);
+    
+    if(!(reussi = binaire_enregistrer(tampon, nom_fichier)))
+        printf("Impossible d'écrire l'instantané %s\n", nom_fichier);
+    
+    binaire_detruire(tampon);
+    return reussi;
+}
+
+bool modele_ecriture_persistance(const char * nom_fichier)
+{
+    modele_fermer_persistance();
+    
+    if(!(persistance = persistance_ouvrir(nom_fichier, true)) ||
+       !modele_valider_persistance())
+    {
+        printf("Impossible d'écrire l'état persistant %s\n", nom_fichier);
+        modele_fermer_persistance();
+        return 0;
+    }
+    
+    return 1;
+}
+
+bool modele_valider_persistance(void)
+{
+    nb_depuis_persistance = 0;
+    if(!tampon_persistance && !(tampon_persistance = binaire_creer()))
+        return 0;
+    
+    //le tampon garde sa capacité d'une mise à jour à l'autre
+    binaire_vider(tampon_persistance);
+    modele_ecriture_instantane(tampon_persistance);
+    return persistance_valider(persistance, tampon_persistance);
+}
+
+bool modele_enregistrement_demarrer(const char * nom_fichier)
+{
+    if(enregistreur)
+        return 1;
+    
+    if(!(nom_enregistrement = (char *) malloc (strlen(nom_fichier) + 1)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+    strcpy(nom_enregistrement, nom_fichier);
+    
+    if(!(enregistreur = enregistreur_creer(nom_fichier)))
+    {
+        printf("Impossible d'enregistrer dans %s\n", nom_fichier);
+        free(nom_enregistrement);
+        nom_enregistrement = NULL;
+        return 0;
+    }
+    
+    return 1;
+}
+
+bool modele_enregistrement_arreter(const char * nom_gnuplot)
+{
+    bool reussi;
+    
+    if(!enregistreur)
+        return 1;
+    
+    reussi = enregistreur_detruire(enregistreur);
+    enregistreur = NULL;
+    
+    //le texte pour gnuplot n'est produit qu'à la fin, en une fois
+    if(reussi && nom_gnuplot)
+        reussi = enregistreur_exporter_gnuplot(nom_enregistrement, nom_gnuplot);
+    if(!reussi)
+        printf("Impossible d'écrire l'enregistrement %s\n", nom_enregistrement);
+    
+    free(nom_enregistrement);
+    nom_enregistrement = NULL;
+    return reussi;
+}
+
+bool modele_trajectoire_demarrer(const char * nom_fichier)
+{
+    modele_trajectoire_arreter();
+    
+    if(!(trajectoire = trajectoire_creer(nom_fichier)))
+    {
+        printf("Impossible d'enregistrer les trajectoires dans %s\n", 
+               nom_fichier);
+        return 0;
+    }
+    
+    fourmi_set_trajectoire(trajectoire);
+    nourriture_set_trajectoire(trajectoire);
+    return 1;
+}
+
+void modele_trajectoire_arreter(void)
+{
+    if(!trajectoire)
+        return;
+    
+    fourmi_set_trajectoire(NULL);
+    nourriture_set_trajectoire(NULL);
+    if(!trajectoire_detruire(trajectoire))
+        printf("Impossible d'écrire toutes les trajectoires\n");
+    trajectoire = NULL;
+}
+
+bool modele_relecture_ouvrir(const char * nom_fichier)
+{
+    modele_relecture_fermer();
+    
+    if(!(relecture = trajectoire_relecture_ouvrir(nom_fichier)) ||
+       !modele_relecture_aller(1))
+    {
+        printf("Impossible de rejouer les trajectoires de %s\n", nom_fichier);
+        modele_relecture_fermer();
+        return 0;
+    }
+    
+    return 1;
+}
+
+bool modele_trace_ouvrir(void)
+{
+    const char * nom_fichier = getenv(VARIABLE_TRACE);
+    
+    if(!nom_fichier || !*nom_fichier)
+        return 0;
+    
+    if(!traceur_ouvrir(nom_fichier))
+    {
+        printf("Impossible de tracer la chronologie dans %s\n", nom_fichier);
+        return 0;
+    }
+    return 1;
+}
+
+void modele_trace_fermer(void)
+{
+    if(!traceur_fermer())
+        printf("Impossible d'écrire la chronologie dans %s\n",
+               getenv(VARIABLE_TRACE));
+}
+
+void modele_variantes(void)
+{
+    const char * periode = getenv(VARIABLE_PERIODE_PERSISTANCE);
+    char * fin = NULL;
+    long valeur;
+    
+    fourmi_set_affectation_lot(getenv(VARIABLE_LOT) != NULL);
+    fourmi_set_cache_but(getenv(VARIABLE_SANS_CACHE_BUT) == NULL);
+    
+    periode_persistance = PERIODE_PERSISTANCE;
+    if(periode)
+    {
+        valeur = strtol(periode, &fin, 10);
+        if(!*periode || *fin || valeur < 1 || valeur > INT_MAX)
+            printf("Période de l'état persistant invalide : %s\n", periode);
+        else
+            periode_persistance = (int) valeur;
+    }
+}
+
+void modele_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter)
+{
+    empreinte_vider(empreinte);
+    fourmiliere_empreinte(empreinte, noter);
+    fourmi_empreinte(empreinte, noter);
+    nourriture_empreinte(empreinte, noter);
+    aleatoire_empreinte(empreinte, noter);
+}
+
+void modele_relecture_fermer(void)
+{
+    trajectoire_relecture_fermer(relecture);
+    relecture = NULL;
+}
+
+int modele_relecture_nb_updates(void)
+{
+    return relecture ? trajectoire_relecture_nb_updates(relecture) : 0;
+}
+
+bool modele_relecture_aller(int update)
+{
+    LECTURE_BINAIRE clef;
+    
+    if(!relecture || update < 1 || 
+       !trajectoire_relecture_aller(relecture, update))
+        return 0;
+    
+    //le modèle est refait à partir de l'état relu, sans mise à jour : 
+    //les fourmilières du début du bloc, puis chaque fourmi et nourriture
+    modele_nettoyer();
+    clef = trajectoire_relecture_clef(relecture);
+    if(!fourmiliere_lecture_binaire(&clef, false))
+    {
+        modele_nettoyer();
+        return 0;
+    }
+    //les effectifs de l'état des fourmilières datent du début du bloc :
+    //ils sont recomptés d'après les fourmis placées
+    fourmiliere_vider_effectifs();
+    trajectoire_relecture_parcourir(relecture, modele_relecture_placer);
+    
+    return 1;
+}
+
+void modele_relecture_placer(enum GenreTrajectoire genre, unsigned indice_f,
+                             double x, double y)
+{
+    switch(genre)
+    {
+        case TRAJECTOIRE_OUVRIERE :
+            fourmi_ouvriere_placer(x, y, indice_f);
+            fourmiliere_compter_fourmi(indice_f, false);
+            break;
+        case TRAJECTOIRE_GARDE :
+            fourmi_garde_placer(x, y, indice_f);
+            fourmiliere_compter_fourmi(indice_f, true);
+            break;
+        case TRAJECTOIRE_NOURRITURE :
+            nourriture_placer(x, y);
+            break;
+    }
+}
+
+bool modele_sauvegarde_periodique(const char * nom_fichier, int periode)
+{
+    modele_arreter_sauvegarde();
+    
+    if(periode < 1 || !(sauvegarde = sauvegarde_creer(nom_fichier)))
+        return 0;
+    
+    periode_sauvegarde = periode;
+    nb_depuis_sauvegarde = 0;
+    return 1;
+}
+
+void modele_point_de_reprise(void)
+{
+    double debut = traceur_debut();
+    
+    //la simulation ne paie que la création du processus d'écriture, qui
+    //sérialise sa copie du monde ; un seul point de reprise à la fois :
+    //si le précédent s'écrit encore, le suivant est retenté à la
+    //prochaine mise à jour
+    if(!sauvegarde_lancer(sauvegarde, modele_ecriture_instantane))
+        return;
+    
+    nb_depuis_sauvegarde = 0;
+    traceur_intervalle("point_de_reprise", debut);
+}
+
+void modele_arreter_sauvegarde(void)
+{
+    sauvegarde_detruire(sauvegarde);
+    sauvegarde = NULL;
+}
+
+void modele_fermer_persistance(void)
+{
+    if(persistance && nb_depuis_persistance > 0 &&
+       !modele_valider_persistance())
+        printf("Impossible de valider l'état persistant\n");
+    
+    persistance_fermer(persistance);
+    persistance = NULL;
+    nb_depuis_persistance = 0;
+}
+
+void modele_ecriture_instantane(TAMPON * tampon)
+{
+    size_t debut;
+    
+    modele_ecriture_entete(tampon);
+    
+    debut = binaire_debut_section(tampon, SECTION_MODELE);
+    binaire_ecrire_entier32(tampon, nb_update);
+    aleatoire_ecriture_binaire(tampon);
+    binaire_fin_section(tampon, debut);
+    
+    modele_ecriture_sections(tampon);
+}
+
+bool modele_extension(const char * nom_fichier, const char * extension)
+{
+    size_t longueur = strlen(nom_fichier);
+    
+    return longueur >= strlen(extension) &&
+           !strcmp(nom_fichier + longueur - strlen(extension), extension);
+}
+
+void modele_ecriture_entete(TAMPON * tampon)
+{
+    binaire_ecrire_octets(tampon, SIGNATURE_INSTANTANE, TAILLE_SIGNATURE);
+    binaire_ecrire_entier32(tampon, VERSION_INSTANTANE);
+}
+
+void modele_ecriture_sections(TAMPON * tampon)
+{
+    size_t debut;
+    
+    debut = binaire_debut_section(tampon, SECTION_FOURMILIERE);
+    fourmiliere_ecriture_binaire(tampon);
+    binaire_fin_section(tampon, debut);
+    
+    debut = binaire_debut_section(tampon, SECTION_OUVRIERE);
+    fourmi_ouvriere_ecriture_binaire(tampon);
+    binaire_fin_section(tampon, debut);
+    
+    debut = binaire_debut_section(tampon, SECTION_GARDE);
+    fourmi_garde_ecriture_binaire(tampon);
+    binaire_fin_section(tampon, debut);
+    
+    debut = binaire_debut_section(tampon, SECTION_NOURRITURE);
+    nourriture_ecriture_binaire(tampon);
+    binaire_fin_section(tampon, debut);
+}
+
+bool modele_ecriture_cache(void)
+{
+    TAMPON * tampon = NULL, * sections = NULL;
+    LECTURE_BINAIRE contenu;
+    size_t debut;
+    bool reussi = false;
+    
+    //les sections sont écrites à part pour que leur empreinte précède
+    //leur contenu dans le fichier
+    if((tampon = binaire_creer()) && (sections = binaire_creer()))
+    {
+        modele_ecriture_sections(sections);
+        if(binaire_get_erreur(sections))
+        {
+            binaire_detruire(sections);
+            binaire_detruire(tampon);
+            return 0;
+        }
+        contenu = binaire_lecture(sections);
+        
+        modele_ecriture_entete(tampon);
+        debut = binaire_debut_section(tampon, SECTION_CACHE);
+        binaire_ecrire_entier64(tampon, empreinte_scenario);
+        binaire_ecrire_entier64(tampon, binaire_empreinte(&contenu));
+        binaire_fin_section(tampon, debut);
+        binaire_ecrire_octets(tampon, contenu.pos, contenu.fin - contenu.pos);
+        
+        //un autre processus peut lire le même cache : il voit l'ancien ou
+        //le nouveau fichier, jamais un fichier à moitié écrit ; un dossier
+        //absent ou en lecture seule laisse simplement le scénario sans
+        //cache
+        reussi = binaire_enregistrer_durable(tampon, nom_cache);
+    }
+    
+    binaire_detruire(sections);
+    binaire_detruire(tampon);
+    return reussi;
+}
+
+void modele_recup_info(int tab_info[NB_COLUMNS][NB_LINES], int premiere_ligne) 
+{
+    fourmiliere_recup_info(tab_info, premiere_ligne);
+}
+
+int modele_nb_lignes_info(void)
 {
-    fourmiliere_recup_info(tab_info);
+    return fourmiliere_get_nb_indices();
 }
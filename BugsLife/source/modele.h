@@ -12,21 +12,94 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include "lecteur.h"
+#include "binaire.h"
+#include "trajectoire.h"
+#include "empreinte.h"
 
 #define NB_LINES   11
 #define NB_COLUMNS 4
+// variable d'environnement qui donne le fichier de la chronologie
+#define VARIABLE_TRACE "BUGSLIFE_TRACE"
+// variable d'environnement qui demande les compteurs matériels en mode
+// Batch
+#define VARIABLE_MATERIEL "BUGSLIFE_MATERIEL"
+// variable d'environnement qui empêche de lire et d'écrire le cache d'un
+// scénario texte, rangé à côté de lui
+#define VARIABLE_SANS_CACHE "BUGSLIFE_SANS_CACHE"
+// variable d'environnement qui fait passer au mode Batch la vérification
+// de rendu 2, pour un scénario sûr ou généré
+#define VARIABLE_CONFIANCE "BUGSLIFE_CONFIANCE"
+// variable d'environnement qui affecte les nourritures aux ouvrières
+// libres de chaque fourmilière en une fois plutôt qu'une par une
+#define VARIABLE_LOT "BUGSLIFE_LOT"
+// variable d'environnement qui revient à la recherche linéaire du but de
+// chaque ouvrière, sans cache ni grilles
+#define VARIABLE_SANS_CACHE_BUT "BUGSLIFE_SANS_CACHE_BUT"
+// variable d'environnement qui donne le nombre de mises à jour entre deux
+// validations de l'état persistant ; 1 valide chaque mise à jour
+#define VARIABLE_PERIODE_PERSISTANCE "BUGSLIFE_PERIODE_PERSISTANCE"
 
-typedef enum Modes{ERROR, VERIFICATION, GRAPHIC, FINAL, RIEN, INCORRECT} PRGMMODE;
+typedef enum Modes{ERROR, VERIFICATION, GRAPHIC, FINAL, REPLAY, BATCH, 
+                   RIEN, INCORRECT} PRGMMODE;
 
 //---------------------------------------------------------------------
-// ouvre le fichier et élimine les lignes inutiles
+// ouvre le fichier et élimine les lignes inutiles ; un instantané 
+// binaire ou un état persistant est reconnu à sa signature et restauré
+// tel quel, un scénario texte est repris de son cache quand le cache est
+// à jour, sauf si VARIABLE_SANS_CACHE est définie
 bool modele_lecture(char * nom_fichier, PRGMMODE nom_mode);
 
+//---------------------------------------------------------------------
+// restaure tout l'état de la simulation écrit par modele_ecriture_binaire
+bool modele_lecture_binaire(const char * nom_fichier, PRGMMODE nom_mode);
+
+//---------------------------------------------------------------------
+// reprend le dernier état validé d'un état persistant, qui continue
+// ensuite d'être validé périodiquement
+bool modele_lecture_persistance(const char * nom_fichier, PRGMMODE nom_mode);
+
+//---------------------------------------------------------------------
+// restaure l'instantané écrit par modele_ecriture_instantane
+bool modele_lecture_instantane(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// restaure le scénario depuis le cache du fichier texte nom_fichier,
+// d'empreinte donnée, projeté en mémoire par le lecteur ; renvoie 0 si
+// le cache est désactivé, absent ou périmé
+bool modele_lecture_cache(const char * nom_fichier, uint64_t empreinte);
+
+//---------------------------------------------------------------------
+// vérifie la signature et la version d'un fichier binaire
+bool modele_lecture_entete(LECTURE_BINAIRE * lecture);
+
+//---------------------------------------------------------------------
+// restaure les fourmilières, les fourmis et la nourriture ; reprise
+// restaure aussi l'état propre à la simulation en cours
+bool modele_lecture_sections(LECTURE_BINAIRE * lecture, bool reprise);
+
+//---------------------------------------------------------------------
+// renvoie le nom du cache du fichier texte, à côté de lui, à libérer par
+// free ; NULL si VARIABLE_SANS_CACHE est définie
+char * modele_nom_cache(const char * nom_fichier);
+
 //---------------------------------------------------------------------
 // détecte les "FIN_LISTE" dans le fichier
-bool modele_recherche_fin_liste(char * chaine);
+bool modele_recherche_fin_liste(const CURSEUR * ligne);
 
-bool modele_automate_lecture(char * tab, int * pnbO, int * pnbG,
+//---------------------------------------------------------------------
+// range dans *plignes les lignes du fichier qui ne sont ni vides ni
+// des commentaires et renvoie leur nombre, ou -1 si la mémoire manque
+int modele_lignes_utiles(LECTEUR * lecteur, CURSEUR ** plignes);
+
+//---------------------------------------------------------------------
+// repère les sections d'ouvrières, de gardes et de nourritures en
+// suivant les transitions de l'automate et fait convertir leurs champs
+// en parallèle ; la validation reste faite ligne après ligne par 
+// modele_automate_lecture
+void modele_preparer_lignes(LECTEUR * lecteur, CURSEUR * lignes, int nb);
+
+bool modele_automate_lecture(CURSEUR * ligne, int * pnbO, int * pnbG,
                              double * pcentre_x, double * pcentre_y,
                              double * prayon_fourmiliere, int * pf, int * po,
                              int * pg, int * pn, int * pnb_fourmiliere,
@@ -34,47 +107,98 @@ bool modele_automate_lecture(char * tab, int * pnbO, int * pnbG,
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture de nb_fourmiliere
-bool modele_etat_nb_fourmiliere(char * tab, int * pnb_fourmiliere);
+bool modele_etat_nb_fourmiliere(CURSEUR * ligne, int * pnb_fourmiliere);
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture des fourmilieres
-bool modele_etat_fourmiliere(char * tab, int * pnbO, int * pnbG,
+bool modele_etat_fourmiliere(CURSEUR * ligne, int * pnbO, int * pnbG,
                              double * pcentre_x, double * pcentre_y,
                              double * prayon_fourmiliere, int * pf,
                              int * po, int *pg, int nb_fourmiliere);
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture des ouvrières
-bool modele_etat_ouvriere(char * tab, int nbO, int nbG, int f, int * po,
+bool modele_etat_ouvriere(CURSEUR * ligne, int nbO, int nbG, int f, int * po,
                           int nb_fourmiliere);
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture des gardes
-bool modele_etat_garde(char * tab, int nbG, int f, int * pg,
+bool modele_etat_garde(CURSEUR * ligne, int nbG, int f, int * pg,
                        bool * pfin_ligne, double centre_x,
                        double centre_y, double rayon_fourmiliere,
                        int nb_fourmiliere);
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture des
-bool modele_etat_fin_fourmiliere(char * tab, int f, int nb_fourmiliere);
+bool modele_etat_fin_fourmiliere(CURSEUR * ligne, int f, int nb_fourmiliere);
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture de nb_nourriture
-void modele_etat_nb_nourriture(char * tab, int * pnb_nourriture);
+void modele_etat_nb_nourriture(CURSEUR * ligne, int * pnb_nourriture);
 
 //---------------------------------------------------------------------
 // effectue les instructions relative à la lecture des nourritures
-bool modele_etat_nourriture(char * tab, int nb_nourriture, int * pn,
+bool modele_etat_nourriture(CURSEUR * ligne, int nb_nourriture, int * pn,
                             bool * pfin_ligne);
 
 //---------------------------------------------------------------------
-// appelle la fonction fourmiliere_verification_rendu2
+// appelle la fonction fourmiliere_verification_rendu2, sauf pour un
+// scénario repris de son cache ; un scénario texte correct est alors
+// mis en cache, sauf si VARIABLE_SANS_CACHE est définie
 bool modele_verification_rendu2(void);
 
 //---------------------------------------------------------------------
-// met à jour toutes les données de la simulation y compris le fichier "out.dat"
-void modele_update(bool automatic, bool record_active, FILE * fichier);
+// met à jour toutes les données de la simulation ; si record_active, la
+// mise à jour est ajoutée à l'enregistrement en cours
+void modele_update(bool automatic, bool record_active);
+
+//---------------------------------------------------------------------
+// mode Batch : lit le scénario, le met à jour nb_updates fois sans
+// affichage, écrit le nombre de mises à jour par seconde, la durée de
+// chaque étape, les centiles de la durée d'une mise à jour, avec
+// -DCOMPTEURS les appels comptés et, si
+// VARIABLE_MATERIEL est définie, les compteurs matériels ; écrit les
+// mesures de chaque mise à jour dans nom_mesures si donné, puis
+// sauvegarde l'état final si nom_sauvegarde. La vérification de rendu 2
+// est passée si VARIABLE_CONFIANCE est définie ; les variantes sont
+// choisies par modele_variantes
+bool modele_batch(char * nom_fichier, long nb_updates, char * nom_sauvegarde,
+                  char * nom_mesures);
+
+//---------------------------------------------------------------------
+// écrit la durée totale de l'étape, par mise à jour et en pourcentage
+// de la durée du mode Batch
+void modele_ecrire_phase(int phase, const char * retrait, long nb_updates,
+                         double duree);
+
+//---------------------------------------------------------------------
+// écrit les évènements matériels de chaque étape par mise à jour et les
+// instructions par cycle ; '-' pour un compteur absent
+void modele_ecrire_materiel(long nb_updates);
+
+//---------------------------------------------------------------------
+// range la durée de chaque mise à jour dans un histogramme et signale
+// celles qui dépassent budget_ms, avec la durée de chaque étape ; un
+// budget nul ne signale rien
+bool modele_surveillance_demarrer(double budget_ms);
+
+//---------------------------------------------------------------------
+// change le budget d'une mise à jour, en millisecondes
+void modele_set_budget(double budget_ms);
+
+//---------------------------------------------------------------------
+// retourne le centile des durées des mises à jour surveillées, en
+// millisecondes ; 0 sans surveillance
+double modele_latence_centile(double centile);
+
+//---------------------------------------------------------------------
+// ajoute la durée de la mise à jour qui se termine, en secondes, et la
+// signale avec son numéro dans le scénario si elle dépasse le budget
+void modele_surveiller(double duree);
+
+//---------------------------------------------------------------------
+// écrit les centiles des durées surveillées et arrête la surveillance
+void modele_surveillance_arreter(void);
 
 //---------------------------------------------------------------------
 // appelle la fonction de création de nourriture manuelle
@@ -90,12 +214,142 @@ void modele_dessine(void);
 void modele_nettoyer(void);
 
 //---------------------------------------------------------------------
-// appelle les fonctions d'écriture
+// appelle les fonctions d'écriture ; un nom terminé par ".bin" donne
+// un instantané binaire, un nom terminé par ".monde" un état persistant
 void modele_ecriture(char * nom_fichier);
 
+//---------------------------------------------------------------------
+// écrit un instantané binaire : l'état exact de la simulation, 
+// générateur aléatoire compris, pour la reprendre là où elle s'est arrêtée
+bool modele_ecriture_binaire(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// crée un état persistant avec l'état courant ; il est ensuite validé à
+// la fin d'une mise à jour sur VARIABLE_PERIODE_PERSISTANCE
+bool modele_ecriture_persistance(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// écrit l'état courant dans l'état persistant ouvert et le valide
+bool modele_valider_persistance(void);
+
+//---------------------------------------------------------------------
+// commence à enregistrer l'évolution des fourmilières dans nom_fichier, 
+// sauf si un enregistrement est déjà en cours
+bool modele_enregistrement_demarrer(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// termine l'enregistrement en cours et l'exporte pour gnuplot dans
+// nom_gnuplot s'il n'est pas NULL
+bool modele_enregistrement_arreter(const char * nom_gnuplot);
+
+//---------------------------------------------------------------------
+// commence à enregistrer la position de chaque fourmi à chaque mise à
+// jour dans nom_fichier, en remplaçant l'enregistrement en cours
+bool modele_trajectoire_demarrer(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// termine l'enregistrement des trajectoires et écrit son dernier bloc
+void modele_trajectoire_arreter(void);
+
+//---------------------------------------------------------------------
+// commence la chronologie de l'exécution si VARIABLE_TRACE donne un
+// fichier : étapes des mises à jour, tranches de lecture, écritures en
+// arrière-plan et points de reprise
+bool modele_trace_ouvrir(void);
+
+//---------------------------------------------------------------------
+// écrit la chronologie au format JSON des traces de Chrome ; à appeler
+// une fois les fils d'écriture arrêtés
+void modele_trace_fermer(void);
+
+//---------------------------------------------------------------------
+// choisit les variantes de la simulation d'après l'environnement :
+// affectation en une fois si VARIABLE_LOT est définie, recherche du but
+// sans cache si VARIABLE_SANS_CACHE_BUT est définie, période de l'état
+// persistant donnée par VARIABLE_PERIODE_PERSISTANCE
+void modele_variantes(void);
+
+//---------------------------------------------------------------------
+// calcule l'empreinte du monde : fourmilières, fourmis, nourritures,
+// compteurs et générateur ; noter, si non NULL, reçoit chaque entité
+void modele_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter);
+
+//---------------------------------------------------------------------
+// ouvre un fichier de trajectoires et place le modèle à sa première
+// mise à jour
+bool modele_relecture_ouvrir(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// ferme le fichier de trajectoires rejoué
+void modele_relecture_fermer(void);
+
+//---------------------------------------------------------------------
+// retourne le nombre de mises à jour du fichier de trajectoires rejoué
+int modele_relecture_nb_updates(void);
+
+//---------------------------------------------------------------------
+// remplace le modèle par l'état enregistré à la mise à jour update, sans
+// appeler modele_update
+bool modele_relecture_aller(int update);
+
+//---------------------------------------------------------------------
+// ajoute au modèle une entité de l'état relu
+void modele_relecture_placer(enum GenreTrajectoire genre, unsigned indice_f,
+                             double x, double y);
+
+//---------------------------------------------------------------------
+// écrit un instantané dans nom_fichier toutes les periode mises à jour ;
+// la sérialisation et l'écriture se font dans un autre processus, la
+// simulation ne fait que le créer
+bool modele_sauvegarde_periodique(const char * nom_fichier, int periode);
+
+//---------------------------------------------------------------------
+// crée le processus qui écrit l'état courant, sauf si le point de
+// reprise précédent n'est pas encore écrit
+void modele_point_de_reprise(void);
+
+//---------------------------------------------------------------------
+// attend le dernier point de reprise et arrête les sauvegardes
+// périodiques
+void modele_arreter_sauvegarde(void);
+
+//---------------------------------------------------------------------
+// valide les mises à jour qui ne l'ont pas encore été puis cesse de
+// valider l'état persistant ouvert ; son dernier état validé reste dans
+// le fichier
+void modele_fermer_persistance(void);
+
+//---------------------------------------------------------------------
+// écrit l'état complet de la simulation : en-tête, compteur de mises à
+// jour et générateur aléatoire, puis les sections des modules
+void modele_ecriture_instantane(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// teste si le nom de fichier se termine par l'extension
+bool modele_extension(const char * nom_fichier, const char * extension);
+
+//---------------------------------------------------------------------
+// écrit la signature et la version d'un fichier binaire
+void modele_ecriture_entete(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// écrit une section par module : fourmilières, ouvrières, gardes et 
+// nourriture
+void modele_ecriture_sections(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// écrit le cache du scénario texte qui vient d'être vérifié par un
+// renommage atomique ; un échec n'empêche pas la simulation
+bool modele_ecriture_cache(void);
+
 //---------------------------------------------------------------------
 // récupère les informations nécessaires, pour remplir le
-// tableau de rollout
-void modele_recup_info(int tab_info[NB_COLUMNS][NB_LINES]);
+// tableau de rollout à partir de la fourmilière premiere_ligne
+void modele_recup_info(int tab_info[NB_COLUMNS][NB_LINES], int premiere_ligne);
+
+//---------------------------------------------------------------------
+// retourne le nombre de fourmilières qui peuvent être affichées
+// dans le tableau de rollout
+int modele_nb_lignes_info(void);
 
 #endif
@@ -13,12 +13,25 @@
 #include "error.h"
 #include "utilitaire.h"
 #include "graphic.h"
+#include "arbre_kd.h"
+#include "memoire.h"
+#include "aleatoire.h"
+#include "compteur.h"
+#include "grille.h"
 #include "nourriture.h"
 
+#define TAILLE_BINAIRE_NOURRITURE (4 + 2*8) // indice_n, x, y
+#define TAILLE_CELLULE_NOURRITURE 2.
+
 /*---------------------------------------------------------------------
  Structure de données d'une nourriture
 	indice_n : indice de la nourriture
 	x , y : coordonnées de la nourriture
+	trace : identifiant et position enregistrée
+	ordre : numéro d'ajout ; une nourriture ajoutée plus tard est placée
+			plus tôt dans la liste chainée
+	rang_arbre : rang dans le dernier arbre construit, -1 si elle n'y est
+				 pas
 	suivant : pointeur de type structure Nourriture qui pointe la
 			  nourriture suivante de la liste chainée
  ----------------------------------------------------------------------*/
@@ -27,17 +40,42 @@ struct Nourriture
     unsigned indice_n;
     double x;
     double y;
+    TRACE trace;
+    unsigned long ordre;
+    int rang_arbre;
     NOURRITURE * suivant;
 };
 
 static NOURRITURE * tete_nourriture = NULL;
 static int nb_nourriture;
+static POOL * pool_nourriture = NULL;
+static TRAJECTOIRE * trajectoire = NULL; // trajectoires (désactivées)
+static unsigned long nb_ajouts = 0;
+
+// nourritures indexées par leur position, pour la recherche bornée
+static GRILLE * grille_nourriture = NULL;
+
+// positions des nourritures rangées par position, indexées par l'arbre,
+// et nourriture de chaque rang (NULL une fois mangée)
+static ARBRE_KD * arbre_nourriture = NULL;
+static POINT_KD * tab_points = NULL;
+static int taille_tab_points = 0;
+static NOURRITURE ** tab_arbre = NULL;
+static int taille_tab_arbre = 0;
+
+//---------------------------------------------------------------------
+// ajoute la nourriture, dont la position est connue, à la grille
+static void nourriture_indexer(NOURRITURE * nourriture);
 
-bool nourriture_lecture(char tab[MAX_LINE], int * pn, bool * pfin_ligne)
+//---------------------------------------------------------------------
+// ordonne les nourritures par x, puis y, puis de la plus récente à la
+// plus ancienne
+static int nourriture_compare_position(const void * a, const void * b);
+
+bool nourriture_lecture(CURSEUR * ligne, int * pn, bool * pfin_ligne)
 {
     int n;
     double x, y;
-    char * deb = tab, * fin = NULL;
     *pfin_ligne = false;
     
     if(*pn == -1)
@@ -45,7 +83,7 @@ bool nourriture_lecture(char tab[MAX_LINE], int * pn, bool * pfin_ligne)
     
     for(n=*pn; n<nb_nourriture; n++)
     {
-        if(sscanf(deb, " %lf %lf", &x, &y) < 2)
+        if(lecteur_scanner(ligne, " %lf %lf", &x, &y) < 2)
         {
             *pfin_ligne = true;
             *pn = n;
@@ -57,13 +95,7 @@ bool nourriture_lecture(char tab[MAX_LINE], int * pn, bool * pfin_ligne)
         tete_nourriture->indice_n = n;
         tete_nourriture->x = x;
         tete_nourriture->y = y;
-        
-        int m;
-        for(m = 0; m < 2; m++)
-        {
-            strtod(deb, &fin);
-            deb = fin;
-        }
+        nourriture_indexer(tete_nourriture);
         
         if(!nourriture_erreur(n, x, y))
             return 0;
@@ -76,13 +108,37 @@ bool nourriture_lecture(char tab[MAX_LINE], int * pn, bool * pfin_ligne)
 void nourriture_ajouter(void)
 {
     NOURRITURE * nouveau = NULL;
-    if(!(nouveau = (NOURRITURE *) malloc (sizeof(NOURRITURE))))
+    
+    if(!pool_nourriture)
+        pool_nourriture = memoire_pool_creer(sizeof(NOURRITURE), 
+                                             memoire_arene_scenario());
+    if(!pool_nourriture ||
+       !(nouveau = (NOURRITURE *) memoire_pool_prendre(pool_nourriture)))
         printf("Probleme de mémoire dans la fonction %s\n", __func__);
     
+    trajectoire_trace_initialiser(&nouveau->trace);
+    nouveau->ordre = nb_ajouts++;
+    nouveau->rang_arbre = -1;
     nouveau->suivant = tete_nourriture;
     tete_nourriture = nouveau;
 }
 
+void nourriture_reserver(int nb)
+{
+    if(!pool_nourriture)
+        pool_nourriture = memoire_pool_creer(sizeof(NOURRITURE), 
+                                             memoire_arene_scenario());
+    if(pool_nourriture)
+        memoire_pool_reserver(pool_nourriture, nb);
+    
+    //et leurs cellules dans la grille
+    if(!grille_nourriture)
+        grille_nourriture = grille_creer(TAILLE_CELLULE_NOURRITURE,
+                                         memoire_arene_scenario());
+    if(grille_nourriture)
+        grille_reserver(grille_nourriture, nb);
+}
+
 bool nourriture_erreur(int n, double x, double y)
 {
     if(x <= -DMAX || y <= -DMAX || x >= DMAX || y >= DMAX)
@@ -106,15 +162,14 @@ void nourriture_dessine(void)
 
 void nourriture_vider(void)
 {
-    NOURRITURE * a_retirer = NULL;
-    while(tete_nourriture)
-    {
-        a_retirer = tete_nourriture;
-        tete_nourriture = tete_nourriture->suivant;
-        free(a_retirer);
-        a_retirer = NULL;
-    }
     tete_nourriture = NULL;
+    nb_ajouts = 0;
+    if(pool_nourriture)
+        memoire_pool_vider(pool_nourriture);
+    if(grille_nourriture)
+        grille_vider(grille_nourriture);
+    if(arbre_nourriture)
+        arbre_kd_construire(arbre_nourriture, tab_points, 0);
 }
 
 void nourriture_set_nb(int set)
@@ -122,6 +177,11 @@ void nourriture_set_nb(int set)
     nb_nourriture = set;
 }
 
+int nourriture_get_nb(void)
+{
+    return nb_nourriture;
+}
+
 void nourriture_update_manual_creation(double x, double y)
 {
     if(nourriture_superposition(x, y))
@@ -132,13 +192,14 @@ void nourriture_update_manual_creation(double x, double y)
         tete_nourriture->indice_n = nb_nourriture;
         tete_nourriture->x = x;
         tete_nourriture->y = y;
+        nourriture_indexer(tete_nourriture);
         nb_nourriture++;
     }
 }
 
 void nourriture_update_automatic_creation(void)
 {
-    if((double)rand()/RAND_MAX <= FOOD_RATE)
+    if((double)aleatoire_tirer()/ALEATOIRE_MAX <= FOOD_RATE)
     {
         nourriture_ajouter();
         tete_nourriture->indice_n = nb_nourriture;
@@ -146,15 +207,18 @@ void nourriture_update_automatic_creation(void)
         
         do
         {
-            tete_nourriture->x = ((double)rand()/RAND_MAX)*(2*DMAX) - DMAX;
-            tete_nourriture->y = ((double)rand()/RAND_MAX)*(2*DMAX) - DMAX;
+            tete_nourriture->x = ((double)aleatoire_tirer()/ALEATOIRE_MAX)*(2*DMAX) - DMAX;
+            tete_nourriture->y = ((double)aleatoire_tirer()/ALEATOIRE_MAX)*(2*DMAX) - DMAX;
         }
         while(nourriture_superposition(tete_nourriture->x, tete_nourriture->y));
+        
+        nourriture_indexer(tete_nourriture);
     }
 }
 
 bool nourriture_superposition(double x, double y)
 {
+    COMPTER(COMPTEUR_NOURRITURE_SUPERPOSITION);
     if(nourriture_entre_nourriture_superposition(x, y))
         return 1;
     
@@ -200,8 +264,14 @@ bool nourriture_manger(double pos_ouvriere_x, double pos_ouvriere_y)
             else
                 precedent->suivant = a_tester->suivant;
             
-            if(a_tester)
-				free(a_tester);
+            grille_retirer(grille_nourriture, a_tester, a_tester->x, 
+                           a_tester->y, 0);
+            if(a_tester->rang_arbre >= 0)
+                tab_arbre[a_tester->rang_arbre] = NULL;
+            if(trajectoire)
+                trajectoire_retirer(trajectoire, &a_tester->trace);
+            
+            memoire_pool_rendre(pool_nourriture, a_tester);
             a_tester = NULL;
             nb_nourriture--;
             return 1;
@@ -214,13 +284,20 @@ bool nourriture_manger(double pos_ouvriere_x, double pos_ouvriere_y)
     return 0;
 }
 
-void nourriture_update_ouvriere_dead(double posx_o, double posy_o)
+void nourriture_update_ouvriere_dead(const double * tab_x, const double * tab_y,
+                                     int nb)
 {
-    nourriture_ajouter();
-    tete_nourriture->indice_n = nb_nourriture;
-    tete_nourriture->x = posx_o;
-    tete_nourriture->y = posy_o;
-    nb_nourriture++;
+    int i;
+    
+    for(i=0 ; i<nb ; i++)
+    {
+        nourriture_ajouter();
+        tete_nourriture->indice_n = nb_nourriture;
+        tete_nourriture->x = tab_x[i];
+        tete_nourriture->y = tab_y[i];
+        nourriture_indexer(tete_nourriture);
+        nb_nourriture++;
+    }
 }
 
 bool nourriture_la_plus_proche(double ouvriere_x, double ouvriere_y,
@@ -235,6 +312,7 @@ bool nourriture_la_plus_proche(double ouvriere_x, double ouvriere_y,
     
     bool nourriture_mangeable_trouvee = false;
     
+    COMPTER(COMPTEUR_NOURRITURE_LA_PLUS_PROCHE);
     while(a_tester)
     {
         distance = utilitaire_calcul_norme(ouvriere_x, a_tester->x, ouvriere_y, 
@@ -254,6 +332,8 @@ bool nourriture_la_plus_proche(double ouvriere_x, double ouvriere_y,
                 *pnourriture_y = a_tester->y;
                 nourriture_mangeable_trouvee = true;
             }
+            else
+                COMPTER(COMPTEUR_CANDIDAT_REJETE);
         }
         
         a_tester = a_tester->suivant;
@@ -264,6 +344,66 @@ bool nourriture_la_plus_proche(double ouvriere_x, double ouvriere_y,
     return 0;
 }
 
+bool nourriture_la_plus_proche_bornee(double ouvriere_x, double ouvriere_y,
+                                      double distance_max,
+                                      double * pnourriture_x, 
+                                      double * pnourriture_y,
+                                      unsigned indice_f, unsigned indice_o)
+{
+    NOURRITURE * a_tester = NULL, * choisie = NULL;
+    void ** candidats = NULL;
+    double distance_min = 2*DMAX, distance;
+    int i, j, k, nb_candidats, i_min, i_max, j_min, j_max;
+    
+    if(!grille_nourriture)
+        return 0;
+    
+    COMPTER(COMPTEUR_NOURRITURE_LA_PLUS_PROCHE);
+    //le carré de demi-côté distance_max contient toutes les nourritures
+    //à cette distance ; à distance égale, la plus récente gagne comme la
+    //première de la liste dans nourriture_la_plus_proche
+    grille_zone(grille_nourriture, ouvriere_x, ouvriere_y, 
+                distance_max + EPSIL_ZERO, &i_min, &i_max, &j_min, &j_max);
+    for(j=j_min ; j<=j_max ; j++)
+        for(i=i_min ; i<=i_max ; i++)
+        {
+            nb_candidats = grille_cellule_indices(grille_nourriture, i, j,
+                                                  &candidats);
+            for(k=0 ; k<nb_candidats ; k++)
+            {
+                a_tester = (NOURRITURE *) candidats[k];
+                distance = utilitaire_calcul_norme(ouvriere_x, a_tester->x, 
+                                                   ouvriere_y, a_tester->y);
+                
+                if(distance > distance_max || distance > distance_min ||
+                   (distance == distance_min && 
+                    (!choisie || a_tester->ordre < choisie->ordre)))
+                    continue;
+                
+                if(!fourmi_nourriture_deja_prise(indice_f, indice_o, 
+                                                 a_tester->x, a_tester->y)
+                   && !fourmi_etrangere_plus_proche(indice_f, a_tester->x, 
+                                                    a_tester->y, distance)
+                   && !fourmiliere_sur_chemin(ouvriere_x, a_tester->x, 
+                                              ouvriere_y, a_tester->y, 
+                                              indice_f))
+                {
+                    distance_min = distance;
+                    choisie = a_tester;
+                }
+                else
+                    COMPTER(COMPTEUR_CANDIDAT_REJETE);
+            }
+        }
+    
+    if(!choisie)
+        return 0;
+    
+    *pnourriture_x = choisie->x;
+    *pnourriture_y = choisie->y;
+    return 1;
+}
+
 void nourriture_ecriture(FILE * fsortie)
 {
     unsigned compteur = 0; // Pour afficher 3 nourritures par ligne
@@ -292,3 +432,176 @@ void nourriture_ecriture(FILE * fsortie)
     if(nb_nourriture)
         fprintf(fsortie, "FIN_LISTE \n");
 }
+
+void nourriture_ecriture_binaire(TAMPON * tampon)
+{
+    NOURRITURE * courant = NULL;
+    uint32_t nb = 0;
+    
+    for(courant = tete_nourriture ; courant ; courant = courant->suivant)
+        nb++;
+    
+    binaire_ecrire_entier32(tampon, nb_nourriture);
+    binaire_ecrire_entier32(tampon, nb);
+    
+    for(courant = tete_nourriture ; courant ; courant = courant->suivant)
+    {
+        binaire_ecrire_entier32(tampon, courant->indice_n);
+        binaire_ecrire_double(tampon, courant->x);
+        binaire_ecrire_double(tampon, courant->y);
+    }
+}
+
+bool nourriture_lecture_binaire(LECTURE_BINAIRE * section)
+{
+    LECTURE_BINAIRE enregistrement;
+    uint32_t nb, i;
+    
+    nb_nourriture = binaire_lire_entier32(section);
+    nb = binaire_lire_entier32(section);
+    
+    if(section->erreur || 
+       (size_t) (section->fin - section->pos) != nb*TAILLE_BINAIRE_NOURRITURE)
+        return 0;
+    
+    nourriture_reserver(nb);
+    
+    //reprises de la dernière à la première : l'ajout en tête redonne 
+    //l'ordre de la liste
+    for(i=nb ; i-- > 0 ; )
+    {
+        binaire_enregistrement(section, i, TAILLE_BINAIRE_NOURRITURE, 
+                               &enregistrement);
+        nourriture_ajouter();
+        
+        tete_nourriture->indice_n = binaire_lire_entier32(&enregistrement);
+        tete_nourriture->x = binaire_lire_double(&enregistrement);
+        tete_nourriture->y = binaire_lire_double(&enregistrement);
+        nourriture_indexer(tete_nourriture);
+    }
+    
+    return 1;
+}
+
+ARBRE_KD * nourriture_construire_arbre(void)
+{
+    NOURRITURE * courant = tete_nourriture;
+    int nb = 0, i;
+    
+    if(!arbre_nourriture && !(arbre_nourriture = arbre_kd_creer()))
+        return NULL;
+    
+    while(courant)
+    {
+        if(!memoire_reserver((void **) &tab_arbre, &taille_tab_arbre, nb + 1,
+                             sizeof(NOURRITURE *)) ||
+           !memoire_reserver((void **) &tab_points, &taille_tab_points, nb + 1,
+                             sizeof(POINT_KD)))
+            break;
+        
+        tab_arbre[nb] = courant;
+        nb++;
+        courant = courant->suivant;
+    }
+    
+    //le rang ne dépend que des positions, pas de l'ordre de la liste
+    if(nb)
+        utilitaire_trier(tab_arbre, nb, sizeof(NOURRITURE *), 
+                         nourriture_compare_position);
+    for(i=0 ; i<nb ; i++)
+    {
+        tab_arbre[i]->rang_arbre = i;
+        tab_points[i].x = tab_arbre[i]->x;
+        tab_points[i].y = tab_arbre[i]->y;
+        tab_points[i].indice = i;
+    }
+    
+    arbre_kd_construire(arbre_nourriture, tab_points, nb);
+    return arbre_nourriture;
+}
+
+int nourriture_get_nb_arbre(void)
+{
+    return arbre_nourriture ? arbre_kd_get_nb(arbre_nourriture) : 0;
+}
+
+void nourriture_position(int indice, double * px, double * py)
+{
+    *px = tab_points[indice].x;
+    *py = tab_points[indice].y;
+}
+
+bool nourriture_disponible(int indice)
+{
+    return tab_arbre[indice] != NULL;
+}
+
+void nourriture_set_trajectoire(TRAJECTOIRE * nouvelle)
+{
+    trajectoire = nouvelle;
+}
+
+void nourriture_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter)
+{
+    NOURRITURE * courant = NULL;
+    uint64_t entite;
+    
+    for(courant = tete_nourriture ; courant ; courant = courant->suivant)
+    {
+        entite = empreinte_entier(empreinte_debut(), courant->indice_n);
+        entite = empreinte_reel(entite, courant->x);
+        entite = empreinte_reel(entite, courant->y);
+        empreinte_ajouter(empreinte, EMPREINTE_NOURRITURE, courant->indice_n,
+                          entite, noter);
+    }
+    
+    entite = empreinte_entier(empreinte_debut(), nb_nourriture);
+    empreinte_ajouter(empreinte, EMPREINTE_COMPTEURS,
+                      EMPREINTE_COMPTEURS_NOURRITURE, entite, noter);
+}
+
+void nourriture_enregistrer_trajectoire(void)
+{
+    NOURRITURE * courant = NULL;
+    
+    if(!trajectoire)
+        return;
+    
+    //une nourriture ne bouge pas : seule son apparition est écrite
+    for(courant = tete_nourriture ; courant ; courant = courant->suivant)
+        trajectoire_tracer(trajectoire, &courant->trace, TRAJECTOIRE_NOURRITURE,
+                           0, courant->x, courant->y);
+}
+
+void nourriture_placer(double x, double y)
+{
+    nourriture_ajouter();
+    tete_nourriture->indice_n = nb_nourriture;
+    tete_nourriture->x = x;
+    tete_nourriture->y = y;
+    nourriture_indexer(tete_nourriture);
+    nb_nourriture++;
+}
+
+static void nourriture_indexer(NOURRITURE * nourriture)
+{
+    if(!grille_nourriture)
+        grille_nourriture = grille_creer(TAILLE_CELLULE_NOURRITURE,
+                                         memoire_arene_scenario());
+    
+    if(grille_nourriture)
+        grille_inserer(grille_nourriture, nourriture, nourriture->x, 
+                       nourriture->y, 0);
+}
+
+static int nourriture_compare_position(const void * a, const void * b)
+{
+    const NOURRITURE * n1 = *(NOURRITURE * const *) a;
+    const NOURRITURE * n2 = *(NOURRITURE * const *) b;
+    
+    if(n1->x != n2->x)
+        return n1->x < n2->x ? -1 : 1;
+    if(n1->y != n2->y)
+        return n1->y < n2->y ? -1 : 1;
+    return (n1->ordre < n2->ordre) - (n1->ordre > n2->ordre);
+}
@@ -12,6 +12,11 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include "constantes.h"
+#include "arbre_kd.h"
+#include "lecteur.h"
+#include "binaire.h"
+#include "trajectoire.h"
+#include "empreinte.h"
 
 typedef struct Nourriture NOURRITURE;
 
@@ -20,12 +25,16 @@ typedef struct Nourriture NOURRITURE;
 
 //---------------------------------------------------------------------
 // mémorise la nourriture
-bool nourriture_lecture(char tab[MAX_LINE], int * pn, bool * pfin_ligne);
+bool nourriture_lecture(CURSEUR * ligne, int * pn, bool * pfin_ligne);
 
 //---------------------------------------------------------------------
 // ajoute une nourriture à la liste chainée
 void nourriture_ajouter();
 
+//---------------------------------------------------------------------
+// prépare la place de nb nourritures de plus sans nouvelle allocation
+void nourriture_reserver(int nb);
+
 //---------------------------------------------------------------------
 // détecte les erreurs relatives à la nourriture (rendu 1)
 bool nourriture_erreur(int n, double x, double y);
@@ -42,6 +51,10 @@ void nourriture_vider(void);
 // initialise la valeur du nombre de nourritures
 void nourriture_set_nb(int set);
 
+//---------------------------------------------------------------------
+// retourne le nombre de nourritures présentes
+int nourriture_get_nb(void);
+
 //---------------------------------------------------------------------
 // crée une nourriture la où la souris clique en mode manual
 void nourriture_update_manual_creation(double x, double y);
@@ -70,9 +83,10 @@ bool nourriture_manger(double pos_ouvriere_x, double pos_ouvriere_y);
 bool nourriture_contact_fourmi(double x1, double x2, double y1, double y2);
 
 //---------------------------------------------------------------------
-// place la nourriture là ou l'ouvriere meurt lorsqu'une ouvrière en possession
-// de nourriture meurt
-void nourriture_update_ouvriere_dead(double posx_o, double posy_o);
+// place une nourriture là où chacune des nb ouvrières mortes en possession
+// de nourriture est morte
+void nourriture_update_ouvriere_dead(const double * tab_x, const double * tab_y,
+                                     int nb);
 
 //---------------------------------------------------------------------
 // trouve la nourriture la plus proche de l'ouvrière
@@ -82,9 +96,65 @@ void nourriture_update_ouvriere_dead(double posx_o, double posy_o);
 bool nourriture_la_plus_proche(double ouviere_x, double ouvriere_y,
                                double *  pnourriture_x, double * pnourriture_y,
                                unsigned indice_f, unsigned indice_o);
+
+//---------------------------------------------------------------------
+// même choix que nourriture_la_plus_proche parmi les nourritures à au plus
+// distance_max de l'ouvrière ; renvoie 0 si aucune ne convient
+bool nourriture_la_plus_proche_bornee(double ouvriere_x, double ouvriere_y,
+                                      double distance_max,
+                                      double * pnourriture_x, 
+                                      double * pnourriture_y,
+                                      unsigned indice_f, unsigned indice_o);
                                
+//---------------------------------------------------------------------
+// reconstruit l'arbre des positions des nourritures actuelles ; l'indice
+// de chaque point est le rang de la nourriture rangée par x, puis y, puis
+// de la plus récente à la plus ancienne
+ARBRE_KD * nourriture_construire_arbre(void);
+
+//---------------------------------------------------------------------
+// retourne le nombre de nourritures indexées par le dernier arbre construit
+int nourriture_get_nb_arbre(void);
+
+//---------------------------------------------------------------------
+// donne la position de la nourriture de rang indice dans le dernier arbre
+void nourriture_position(int indice, double * px, double * py);
+
+//---------------------------------------------------------------------
+// teste si la nourriture de rang indice dans le dernier arbre n'a pas
+// été mangée depuis sa construction
+bool nourriture_disponible(int indice);
+
 //---------------------------------------------------------------------
 // écrit dans le fichier fsortie les informations relatives aux nourritures
 void nourriture_ecriture(FILE * fsortie);
 
+//---------------------------------------------------------------------
+// ajoute au tampon nb_nourriture et toutes les nourritures, dans l'ordre
+// de la liste
+void nourriture_ecriture_binaire(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// restaure les nourritures écrites par nourriture_ecriture_binaire ;
+// renvoie 0 si la section est invalide
+bool nourriture_lecture_binaire(LECTURE_BINAIRE * section);
+
+//---------------------------------------------------------------------
+// donne l'enregistreur des trajectoires, ou NULL pour ne plus en 
+// enregistrer
+void nourriture_set_trajectoire(TRAJECTOIRE * nouvelle);
+
+//---------------------------------------------------------------------
+// ajoute à l'empreinte chaque nourriture, puis leur nombre
+void nourriture_empreinte(EMPREINTE * empreinte, NOTER_ENTITE noter);
+
+//---------------------------------------------------------------------
+// enregistre les nourritures apparues depuis le début du bloc en cours
+void nourriture_enregistrer_trajectoire(void);
+
+//---------------------------------------------------------------------
+// ajoute une nourriture à la position donnée, pour rejouer un 
+// enregistrement
+void nourriture_placer(double x, double y);
+
 #endif
@@ -0,0 +1,414 @@
+/*!
+ \file persistance.c
+ \brief Module qui garde l'état de la simulation dans un fichier projeté
+  en mémoire, validé périodiquement, pour reprendre après un
+  arrêt au dernier état validé
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "binaire.h"
+#include "persistance.h"
+
+#define SIGNATURE_PERSISTANCE "BUGSMOND"
+#define TAILLE_SIGNATURE 8
+#define VERSION_PERSISTANCE 1
+#define NB_EMPLACEMENTS 2
+#define MARQUEUR_VALIDE 0x44494C56 // "VLID"
+
+/*---------------------------------------------------------------------
+ Structure de données d'un emplacement d'état, tel qu'il est rangé dans
+ l'en-tête du fichier
+	decalage : position du contenu dans le fichier
+	capacite : place réservée au contenu
+	taille : taille du contenu validé
+	empreinte : empreinte FNV-1a du contenu, qui détecte une copie
+	            interrompue
+	generation : numéro de la validation, le plus grand est le dernier
+	marqueur : MARQUEUR_VALIDE une fois le contenu entièrement copié
+ ----------------------------------------------------------------------*/
+typedef struct Emplacement EMPLACEMENT;
+struct Emplacement
+{
+    uint64_t decalage;
+    uint64_t capacite;
+    uint64_t taille;
+    uint64_t empreinte;
+    uint64_t generation;
+    uint32_t marqueur;
+    uint32_t reserve;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données de l'en-tête du fichier, au début de la projection
+	signature , version : reconnaissent le fichier
+	emplacements : les deux derniers états, écrits à tour de rôle
+ ----------------------------------------------------------------------*/
+typedef struct EntetePersistance ENTETE;
+struct EntetePersistance
+{
+    char signature[TAILLE_SIGNATURE];
+    uint32_t version;
+    uint32_t reserve;
+    EMPLACEMENT emplacements[NB_EMPLACEMENTS];
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un état persistant ouvert
+	descripteur : fichier ouvert en lecture et écriture
+	projection : projection partagée de tout le fichier
+	taille : taille du fichier, multiple de la taille d'une page
+	intact : emplacement du dernier état dont l'empreinte a été
+	         vérifiée, -1 s'il n'a pas encore été cherché
+ ----------------------------------------------------------------------*/
+struct Persistance
+{
+    int descripteur;
+    unsigned char * projection;
+    size_t taille;
+    int intact;
+};
+
+static size_t persistance_arrondir_page(size_t taille);
+static bool persistance_emplacement_valide(const PERSISTANCE * persistance,
+                                           int i);
+static int persistance_dernier(const PERSISTANCE * persistance);
+static int persistance_dernier_intact(PERSISTANCE * persistance);
+static bool persistance_agrandir(PERSISTANCE * persistance, int cible,
+                                 int garde, size_t taille);
+static bool persistance_place_libre(const PERSISTANCE * persistance,
+                                    int cible, int garde, size_t taille);
+static bool persistance_projeter(PERSISTANCE * persistance, size_t taille);
+static void persistance_synchroniser(const PERSISTANCE * persistance,
+                                     uint64_t decalage, uint64_t taille);
+
+bool persistance_reconnaitre(const char * nom_fichier)
+{
+    return binaire_commence_par(nom_fichier, SIGNATURE_PERSISTANCE,
+                                TAILLE_SIGNATURE);
+}
+
+PERSISTANCE * persistance_ouvrir(const char * nom_fichier, bool creer)
+{
+    PERSISTANCE * persistance = NULL;
+    ENTETE * entete = NULL;
+    struct stat etat;
+    void * projection;
+
+    if(!(persistance = (PERSISTANCE *) malloc (sizeof(PERSISTANCE))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+
+    persistance->descripteur = open(nom_fichier,
+                                    creer ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR,
+                                    0644);
+    if(persistance->descripteur < 0)
+    {
+        free(persistance);
+        return NULL;
+    }
+
+    if(creer)
+    {
+        persistance->taille = persistance_arrondir_page(sizeof(ENTETE));
+        if(ftruncate(persistance->descripteur, persistance->taille))
+            persistance->taille = 0;
+    }
+    else if(!fstat(persistance->descripteur, &etat) &&
+            (size_t) etat.st_size >= sizeof(ENTETE))
+        persistance->taille = etat.st_size;
+    else
+        persistance->taille = 0;
+
+    projection = persistance->taille ?
+                 mmap(NULL, persistance->taille, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, persistance->descripteur, 0) : MAP_FAILED;
+    if(projection == MAP_FAILED)
+    {
+        close(persistance->descripteur);
+        free(persistance);
+        return NULL;
+    }
+
+    persistance->projection = (unsigned char *) projection;
+    persistance->intact = -1;
+    entete = (ENTETE *) persistance->projection;
+
+    if(creer)
+    {
+        memset(entete, 0, sizeof(ENTETE));
+        memcpy(entete->signature, SIGNATURE_PERSISTANCE, TAILLE_SIGNATURE);
+        entete->version = VERSION_PERSISTANCE;
+    }
+    else if(memcmp(entete->signature, SIGNATURE_PERSISTANCE, TAILLE_SIGNATURE) ||
+            entete->version != VERSION_PERSISTANCE)
+    {
+        persistance_fermer(persistance);
+        return NULL;
+    }
+
+    return persistance;
+}
+
+void persistance_fermer(PERSISTANCE * persistance)
+{
+    if(!persistance)
+        return;
+
+    if(persistance->projection)
+        munmap(persistance->projection, persistance->taille);
+    close(persistance->descripteur);
+    free(persistance);
+}
+
+bool persistance_dernier_etat(PERSISTANCE * persistance,
+                              LECTURE_BINAIRE * contenu)
+{
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    EMPLACEMENT * emplacement = NULL;
+    int intact = persistance_dernier_intact(persistance);
+
+    if(intact < 0)
+        return 0;
+
+    emplacement = &entete->emplacements[intact];
+    contenu->pos = persistance->projection + emplacement->decalage;
+    contenu->fin = contenu->pos + emplacement->taille;
+    contenu->erreur = false;
+    return 1;
+}
+
+bool persistance_valider(PERSISTANCE * persistance, const TAMPON * tampon)
+{
+    LECTURE_BINAIRE contenu = binaire_lecture(tampon);
+    size_t taille = contenu.fin - contenu.pos;
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    EMPLACEMENT * emplacement = NULL;
+    uint64_t generation = 0;
+    int dernier, intact, cible;
+
+    if(!persistance->projection || binaire_get_erreur(tampon))
+        return 0;
+
+    //l'état que persistance_dernier_etat reprendrait n'est jamais
+    //touché, même s'il n'est pas de la plus grande génération : la copie
+    //va dans l'autre emplacement, invalidé tant qu'elle n'est pas terminée
+    intact = persistance_dernier_intact(persistance);
+    if((dernier = persistance_dernier(persistance)) >= 0)
+        generation = entete->emplacements[dernier].generation;
+    cible = intact == 0 ? 1 : 0;
+    emplacement = &entete->emplacements[cible];
+    __atomic_store_n(&emplacement->marqueur, 0, __ATOMIC_RELEASE);
+
+    if(!persistance_place_libre(persistance, cible, intact, taille))
+    {
+        if(!persistance_agrandir(persistance, cible, intact, taille))
+            return 0;
+        entete = (ENTETE *) persistance->projection;
+        emplacement = &entete->emplacements[cible];
+    }
+
+    memcpy(persistance->projection + emplacement->decalage, contenu.pos, taille);
+    emplacement->taille = taille;
+    emplacement->empreinte = binaire_empreinte(&contenu);
+    emplacement->generation = generation + 1;
+    __atomic_store_n(&emplacement->marqueur, MARQUEUR_VALIDE, __ATOMIC_RELEASE);
+    persistance->intact = cible;
+
+    //le système écrit les pages modifiées sans que la simulation attende ;
+    //seuls l'emplacement copié et l'en-tête ont changé
+    persistance_synchroniser(persistance, emplacement->decalage, taille);
+    persistance_synchroniser(persistance, 0, sizeof(ENTETE));
+    return 1;
+}
+
+//---------------------------------------------------------------------
+// arrondit la taille au multiple supérieur de la taille d'une page
+static size_t persistance_arrondir_page(size_t taille)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+
+    return (taille + page - 1)/page*page;
+}
+
+//---------------------------------------------------------------------
+// vrai si l'emplacement est validé et tient dans le fichier
+static bool persistance_emplacement_valide(const PERSISTANCE * persistance,
+                                           int i)
+{
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    EMPLACEMENT * emplacement = &entete->emplacements[i];
+
+    return __atomic_load_n(&emplacement->marqueur, __ATOMIC_ACQUIRE) ==
+               MARQUEUR_VALIDE &&
+           emplacement->decalage >= sizeof(ENTETE) &&
+           emplacement->decalage <= persistance->taille &&
+           emplacement->capacite <= persistance->taille - emplacement->decalage &&
+           emplacement->taille <= emplacement->capacite;
+}
+
+//---------------------------------------------------------------------
+// indice de l'emplacement validé de plus grande génération, -1 si aucun
+static int persistance_dernier(const PERSISTANCE * persistance)
+{
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    int i, dernier = -1;
+
+    for(i=0 ; i<NB_EMPLACEMENTS ; i++)
+        if(persistance_emplacement_valide(persistance, i) &&
+           (dernier < 0 || entete->emplacements[i].generation >
+                           entete->emplacements[dernier].generation))
+            dernier = i;
+
+    return dernier;
+}
+
+//---------------------------------------------------------------------
+// indice de l'emplacement que persistance_dernier_etat reprend : le
+// validé de plus grande génération, ou l'autre si son empreinte est
+// fausse ; -1 si aucun n'est intact. Le résultat est gardé, les
+// validations suivantes le tiennent à jour sans relire les états
+static int persistance_dernier_intact(PERSISTANCE * persistance)
+{
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    LECTURE_BINAIRE contenu;
+    int i, premier;
+
+    if(persistance->intact >= 0)
+        return persistance->intact;
+    if((premier = persistance_dernier(persistance)) < 0)
+        return -1;
+
+    //si le dernier état est abîmé, l'autre est le précédent
+    for(i=0 ; i<NB_EMPLACEMENTS ; i++)
+    {
+        int indice = (premier + i)%NB_EMPLACEMENTS;
+        EMPLACEMENT * emplacement = &entete->emplacements[indice];
+
+        if(!persistance_emplacement_valide(persistance, indice))
+            continue;
+
+        contenu.pos = persistance->projection + emplacement->decalage;
+        contenu.fin = contenu.pos + emplacement->taille;
+        contenu.erreur = false;
+        if(binaire_empreinte(&contenu) == emplacement->empreinte)
+            return persistance->intact = indice;
+    }
+
+    return -1;
+}
+
+//---------------------------------------------------------------------
+// place l'emplacement cible, avec le double de la place demandée, au
+// plus près du début du fichier sans toucher l'emplacement garde (-1 si
+// aucun) : la place de l'ancien contenu de la cible est réutilisée et le
+// fichier ne dépasse jamais l'en-tête et les deux emplacements
+static bool persistance_agrandir(PERSISTANCE * persistance, int cible,
+                                 int garde, size_t taille)
+{
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    size_t capacite = persistance_arrondir_page(2*taille);
+    size_t decalage = persistance_arrondir_page(sizeof(ENTETE));
+    size_t fin_garde = 0, nouvelle_taille;
+
+    if(garde >= 0)
+    {
+        //avant l'emplacement gardé s'il y a la place, sinon juste après
+        fin_garde = entete->emplacements[garde].decalage +
+                    entete->emplacements[garde].capacite;
+        if(decalage + capacite > entete->emplacements[garde].decalage)
+            decalage = fin_garde;
+    }
+    nouvelle_taille = decalage + capacite > fin_garde ?
+                      decalage + capacite : fin_garde;
+
+    //la cible est invalidée : seul l'en-tête et l'emplacement gardé
+    //doivent survivre à la nouvelle projection
+    entete->emplacements[cible].decalage = decalage;
+    entete->emplacements[cible].capacite = capacite;
+    entete->emplacements[cible].taille = 0;
+    return persistance_projeter(persistance, nouvelle_taille);
+}
+
+//---------------------------------------------------------------------
+// vrai si la place de l'emplacement cible tient dans le fichier, peut
+// recevoir taille octets et ne recouvre pas l'emplacement garde (-1 si
+// aucun)
+static bool persistance_place_libre(const PERSISTANCE * persistance,
+                                    int cible, int garde, size_t taille)
+{
+    ENTETE * entete = (ENTETE *) persistance->projection;
+    EMPLACEMENT * emplacement = &entete->emplacements[cible];
+    EMPLACEMENT * autre = NULL;
+
+    if(emplacement->decalage < sizeof(ENTETE) ||
+       emplacement->decalage > persistance->taille ||
+       emplacement->capacite > persistance->taille - emplacement->decalage ||
+       emplacement->capacite < taille)
+        return 0;
+    if(garde < 0)
+        return 1;
+
+    autre = &entete->emplacements[garde];
+    return emplacement->decalage + emplacement->capacite <= autre->decalage ||
+           autre->decalage + autre->capacite <= emplacement->decalage;
+}
+
+//---------------------------------------------------------------------
+// donne au fichier la taille demandée et le projette à nouveau
+static bool persistance_projeter(PERSISTANCE * persistance, size_t taille)
+{
+    void * projection;
+
+    size_t demandee = taille;
+
+    //un fichier raccourci sous une projection en cours la rendrait
+    //invalide : elle est levée avant ; si le fichier garde sa taille, il
+    //est projeté à nouveau tel quel
+    munmap(persistance->projection, persistance->taille);
+    persistance->projection = NULL;
+    if(ftruncate(persistance->descripteur, taille))
+        taille = persistance->taille;
+
+    projection = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      persistance->descripteur, 0);
+    if(projection == MAP_FAILED)
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+
+    persistance->projection = (unsigned char *) projection;
+    persistance->taille = taille;
+    //un fichier qui n'a pas pu raccourcir reste utilisable, pas un fichier
+    //qui n'a pas pu grandir
+    return taille >= demandee;
+}
+
+//---------------------------------------------------------------------
+// demande l'écriture des pages qui contiennent les octets de decalage à
+// decalage+taille, sans attendre
+static void persistance_synchroniser(const PERSISTANCE * persistance,
+                                     uint64_t decalage, uint64_t taille)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t debut = decalage/page*page;
+    size_t fin = persistance_arrondir_page(decalage + taille);
+
+    if(fin > persistance->taille)
+        fin = persistance->taille;
+    if(debut < fin)
+        msync(persistance->projection + debut, fin - debut, MS_ASYNC);
+}
@@ -0,0 +1,47 @@
+/*!
+ \file persistance.h
+ \brief Module qui garde l'état de la simulation dans un fichier projeté
+  en mémoire, validé périodiquement, pour reprendre après un
+  arrêt au dernier état validé
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef PERSISTANCE_H
+#define PERSISTANCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "binaire.h"
+
+typedef struct Persistance PERSISTANCE;
+
+//---------------------------------------------------------------------
+// teste si le fichier est un état persistant
+bool persistance_reconnaitre(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// projette en mémoire un état persistant existant, ou en crée un vide
+// si creer ; renvoie NULL si le fichier est inutilisable
+PERSISTANCE * persistance_ouvrir(const char * nom_fichier, bool creer);
+
+//---------------------------------------------------------------------
+// libère la projection ; le dernier état validé reste dans le fichier
+void persistance_fermer(PERSISTANCE * persistance);
+
+//---------------------------------------------------------------------
+// place dans contenu le dernier état validé dont l'empreinte est
+// intacte, lu directement dans la projection ; renvoie 0 s'il n'y en a
+// aucun
+bool persistance_dernier_etat(PERSISTANCE * persistance,
+                              LECTURE_BINAIRE * contenu);
+
+//---------------------------------------------------------------------
+// recopie le contenu du tampon à la place de l'état que
+// persistance_dernier_etat ne reprendrait pas, puis le valide ; une
+// interruption pendant la copie laisse l'état précédent, et le fichier
+// ne garde que la place des deux états
+bool persistance_valider(PERSISTANCE * persistance, const TAMPON * tampon);
+
+#endif
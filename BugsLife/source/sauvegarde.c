@@ -0,0 +1,134 @@
+/*!
+ \file sauvegarde.c
+ \brief Module qui écrit des points de reprise dans un processus à part,
+  copie de la simulation au moment du point de reprise, sans faire
+  attendre la simulation
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "binaire.h"
+#include "sauvegarde.h"
+
+/*---------------------------------------------------------------------
+ Structure de données d'un écrivain de points de reprise
+	nom_fichier : fichier remplacé à chaque point de reprise
+	ecrivain : processus qui écrit le point de reprise en cours, 0 si
+	           aucun
+ ----------------------------------------------------------------------*/
+struct Sauvegarde
+{
+    char * nom_fichier;
+    pid_t ecrivain;
+};
+
+static bool sauvegarde_terminer(SAUVEGARDE * sauvegarde, bool attendre);
+static void sauvegarde_ecrire(const SAUVEGARDE * sauvegarde,
+                              ECRIRE_ETAT ecrire);
+
+SAUVEGARDE * sauvegarde_creer(const char * nom_fichier)
+{
+    SAUVEGARDE * sauvegarde = NULL;
+
+    if(!(sauvegarde = (SAUVEGARDE *) malloc (sizeof(SAUVEGARDE))) ||
+       !(sauvegarde->nom_fichier = (char *) malloc (strlen(nom_fichier) + 1)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        free(sauvegarde);
+        return NULL;
+    }
+
+    strcpy(sauvegarde->nom_fichier, nom_fichier);
+    sauvegarde->ecrivain = 0;
+    return sauvegarde;
+}
+
+void sauvegarde_detruire(SAUVEGARDE * sauvegarde)
+{
+    if(!sauvegarde)
+        return;
+
+    //le point de reprise en cours est terminé d'abord
+    sauvegarde_attendre(sauvegarde);
+    free(sauvegarde->nom_fichier);
+    free(sauvegarde);
+}
+
+bool sauvegarde_lancer(SAUVEGARDE * sauvegarde, ECRIRE_ETAT ecrire)
+{
+    pid_t ecrivain;
+
+    if(!sauvegarde_terminer(sauvegarde, false))
+        return 0;
+
+    //ce qui attend d'être affiché le serait aussi par le processus
+    //d'écriture s'il affiche une erreur
+    fflush(stdout);
+    if((ecrivain = fork()) < 0)
+        return 0;
+    if(ecrivain == 0)
+        sauvegarde_ecrire(sauvegarde, ecrire);
+
+    sauvegarde->ecrivain = ecrivain;
+    return 1;
+}
+
+void sauvegarde_attendre(SAUVEGARDE * sauvegarde)
+{
+    sauvegarde_terminer(sauvegarde, true);
+}
+
+//---------------------------------------------------------------------
+// récupère le processus d'écriture s'il a fini, ou l'attend si attendre,
+// et signale un point de reprise qui n'a pas pu être écrit ; renvoie 1
+// s'il n'y a plus d'écriture en cours
+static bool sauvegarde_terminer(SAUVEGARDE * sauvegarde, bool attendre)
+{
+    pid_t fini;
+    int statut;
+
+    if(!sauvegarde->ecrivain)
+        return 1;
+
+    do
+        fini = waitpid(sauvegarde->ecrivain, &statut, attendre ? 0 : WNOHANG);
+    while(fini < 0 && errno == EINTR);
+
+    if(fini == 0)
+        return 0;
+
+    if(fini < 0 || !WIFEXITED(statut) || WEXITSTATUS(statut) != EXIT_SUCCESS)
+        printf("Impossible d'écrire le point de reprise %s\n",
+               sauvegarde->nom_fichier);
+    sauvegarde->ecrivain = 0;
+    return 1;
+}
+
+//---------------------------------------------------------------------
+// corps du processus d'écriture : seul le fil qui l'a créé y existe, il
+// n'utilise donc ni les autres fils ni leurs verrous, et se termine par
+// _exit pour ne pas appeler les fonctions enregistrées par atexit
+static void sauvegarde_ecrire(const SAUVEGARDE * sauvegarde,
+                              ECRIRE_ETAT ecrire)
+{
+    TAMPON * tampon = NULL;
+    bool reussi = false;
+
+    if((tampon = binaire_creer()))
+    {
+        ecrire(tampon);
+        reussi = binaire_enregistrer_durable(tampon, sauvegarde->nom_fichier);
+    }
+
+    fflush(stdout);
+    _exit(reussi ? EXIT_SUCCESS : EXIT_FAILURE);
+}
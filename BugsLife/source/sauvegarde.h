@@ -0,0 +1,41 @@
+/*!
+ \file sauvegarde.h
+ \brief Module qui écrit des points de reprise dans un processus à part,
+  copie de la simulation au moment du point de reprise, sans faire
+  attendre la simulation
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef SAUVEGARDE_H
+#define SAUVEGARDE_H
+
+#include <stdbool.h>
+#include "binaire.h"
+
+typedef struct Sauvegarde SAUVEGARDE;
+
+// fonction qui écrit l'état à sauvegarder dans le tampon
+typedef void (*ECRIRE_ETAT)(TAMPON * tampon);
+
+//---------------------------------------------------------------------
+// prépare l'écriture des points de reprise dans nom_fichier
+SAUVEGARDE * sauvegarde_creer(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// attend la fin de l'écriture en cours et libère tout
+void sauvegarde_detruire(SAUVEGARDE * sauvegarde);
+
+//---------------------------------------------------------------------
+// crée le processus d'écriture, qui voit la mémoire telle qu'elle est à
+// cet instant : il appelle ecrire puis enregistre le tampon. Renvoie 0
+// si le point de reprise précédent est encore en cours d'écriture ou si
+// le processus n'a pas pu être créé
+bool sauvegarde_lancer(SAUVEGARDE * sauvegarde, ECRIRE_ETAT ecrire);
+
+//---------------------------------------------------------------------
+// attend que le point de reprise en cours soit sur le disque
+void sauvegarde_attendre(SAUVEGARDE * sauvegarde);
+
+#endif
@@ -0,0 +1,285 @@
+/*!
+ \file traceur.c
+ \brief Module qui trace la chronologie d'une exécution : chaque fil
+  range ses intervalles dans ses propres blocs, sans verrou, et le tout
+  est écrit à la fin au format JSON des traces de Chrome, lisible par
+  chrome://tracing et Perfetto
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "compteur.h"
+#include "traceur.h"
+
+#define NB_INTERVALLES_BLOC 4096
+#define NOM_FIL_MAX 32
+
+typedef struct Intervalle INTERVALLE;
+struct Intervalle
+{
+    const char * nom;
+    double debut;
+    double fin;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un bloc d'intervalles d'un fil
+	intervalles : intervalles tracés, dans l'ordre
+	nb : nombre d'intervalles publiés ; seul le fil propriétaire l'augmente
+	suivant : bloc ajouté quand celui-ci est plein
+ ----------------------------------------------------------------------*/
+typedef struct BlocTrace BLOC_TRACE;
+struct BlocTrace
+{
+    INTERVALLE intervalles[NB_INTERVALLES_BLOC];
+    atomic_int nb;
+    BLOC_TRACE * _Atomic suivant;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données de la chronologie d'un fil
+	numero : identifiant du fil dans la trace
+	nom : nom du fil dans la trace
+	premier : premier bloc, lu à l'écriture de la trace
+	dernier : bloc en cours, utilisé seulement par le fil propriétaire
+	suivant : fil enregistré avant celui-ci
+ ----------------------------------------------------------------------*/
+typedef struct FilTrace FIL_TRACE;
+struct FilTrace
+{
+    int numero;
+    char nom[NOM_FIL_MAX];
+    BLOC_TRACE * premier;
+    BLOC_TRACE * dernier;
+    FIL_TRACE * suivant;
+};
+
+static atomic_bool actif = false;
+//chaque chronologie a son numéro : un fil qui a tracé dans la
+//précédente s'enregistre à nouveau
+static atomic_uint session = 0;
+static FIL_TRACE * _Atomic tete_fil = NULL;
+static atomic_int nb_fils = 0;
+static atomic_ulong nb_perdus = 0;
+static char * nom_trace = NULL;
+static double origine = 0;
+
+static _Thread_local FIL_TRACE * fil = NULL;
+static _Thread_local unsigned session_fil = 0;
+
+//---------------------------------------------------------------------
+// retourne la chronologie du fil appelant, créée et enregistrée à son
+// premier intervalle ; NULL si la mémoire manque
+static FIL_TRACE * traceur_fil(void);
+
+//---------------------------------------------------------------------
+// crée un bloc vide
+static BLOC_TRACE * traceur_bloc(void);
+
+//---------------------------------------------------------------------
+// écrit les intervalles et le nom de chaque fil au format de Chrome
+static bool traceur_ecrire(FILE * fichier);
+
+bool traceur_ouvrir(const char * nom_fichier)
+{
+    if(atomic_load(&actif))
+        traceur_fermer();
+
+    if(!(nom_trace = (char *) malloc (strlen(nom_fichier) + 1)))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return 0;
+    }
+    strcpy(nom_trace, nom_fichier);
+
+    atomic_fetch_add(&session, 1);
+    atomic_store(&nb_fils, 0);
+    atomic_store(&nb_perdus, 0);
+    origine = compteur_horloge();
+    atomic_store(&actif, true);
+
+    traceur_nommer_fil("simulation");
+    return 1;
+}
+
+bool traceur_fermer(void)
+{
+    FIL_TRACE * courant = NULL, * suivant = NULL;
+    BLOC_TRACE * bloc = NULL, * bloc_suivant = NULL;
+    FILE * fichier = NULL;
+    bool reussi = false;
+
+    if(!atomic_exchange(&actif, false))
+        return 1;
+
+    if((fichier = fopen(nom_trace, "w")))
+    {
+        reussi = traceur_ecrire(fichier);
+        if(fclose(fichier))
+            reussi = false;
+    }
+    if(atomic_load(&nb_perdus))
+        printf("%lu intervalles perdus faute de mémoire\n",
+               atomic_load(&nb_perdus));
+
+    courant = atomic_exchange(&tete_fil, NULL);
+    while(courant)
+    {
+        suivant = courant->suivant;
+        for(bloc=courant->premier ; bloc ; bloc=bloc_suivant)
+        {
+            bloc_suivant = atomic_load(&bloc->suivant);
+            free(bloc);
+        }
+        free(courant);
+        courant = suivant;
+    }
+
+    free(nom_trace);
+    nom_trace = NULL;
+    return reussi;
+}
+
+bool traceur_actif(void)
+{
+    return atomic_load_explicit(&actif, memory_order_relaxed);
+}
+
+void traceur_nommer_fil(const char * nom)
+{
+    FIL_TRACE * courant = NULL;
+
+    if(!traceur_actif() || !(courant = traceur_fil()))
+        return;
+
+    strncpy(courant->nom, nom, NOM_FIL_MAX - 1);
+    courant->nom[NOM_FIL_MAX - 1] = '\0';
+}
+
+double traceur_debut(void)
+{
+    return traceur_actif() ? compteur_horloge() : 0;
+}
+
+void traceur_intervalle(const char * nom, double debut)
+{
+    if(traceur_actif())
+        traceur_intervalle_fin(nom, debut, compteur_horloge());
+}
+
+void traceur_intervalle_fin(const char * nom, double debut, double fin)
+{
+    FIL_TRACE * courant = NULL;
+    BLOC_TRACE * bloc = NULL;
+    int nb;
+
+    if(!traceur_actif() || !(courant = traceur_fil()))
+        return;
+
+    bloc = courant->dernier;
+    nb = atomic_load_explicit(&bloc->nb, memory_order_relaxed);
+    if(nb == NB_INTERVALLES_BLOC)
+    {
+        if(!(bloc = traceur_bloc()))
+        {
+            atomic_fetch_add(&nb_perdus, 1);
+            return;
+        }
+        atomic_store_explicit(&courant->dernier->suivant, bloc,
+                              memory_order_release);
+        courant->dernier = bloc;
+        nb = 0;
+    }
+
+    bloc->intervalles[nb].nom = nom;
+    bloc->intervalles[nb].debut = debut;
+    bloc->intervalles[nb].fin = fin;
+    //l'intervalle n'est visible qu'une fois entièrement écrit
+    atomic_store_explicit(&bloc->nb, nb + 1, memory_order_release);
+}
+
+static FIL_TRACE * traceur_fil(void)
+{
+    FIL_TRACE * nouveau = NULL;
+    unsigned numero_session = atomic_load(&session);
+
+    if(fil && session_fil == numero_session)
+        return fil;
+
+    fil = NULL;
+    if(!(nouveau = (FIL_TRACE *) malloc (sizeof(FIL_TRACE))) ||
+       !(nouveau->premier = traceur_bloc()))
+    {
+        free(nouveau);
+        atomic_fetch_add(&nb_perdus, 1);
+        return NULL;
+    }
+
+    nouveau->numero = atomic_fetch_add(&nb_fils, 1) + 1;
+    snprintf(nouveau->nom, NOM_FIL_MAX, "fil %d", nouveau->numero);
+    nouveau->dernier = nouveau->premier;
+
+    //ajout en tête sans verrou : seul le pointeur de tête est partagé
+    nouveau->suivant = atomic_load(&tete_fil);
+    while(!atomic_compare_exchange_weak(&tete_fil, &nouveau->suivant, nouveau))
+        ;
+
+    fil = nouveau;
+    session_fil = numero_session;
+    return fil;
+}
+
+static BLOC_TRACE * traceur_bloc(void)
+{
+    BLOC_TRACE * bloc = NULL;
+
+    if(!(bloc = (BLOC_TRACE *) malloc (sizeof(BLOC_TRACE))))
+        return NULL;
+
+    atomic_init(&bloc->nb, 0);
+    atomic_init(&bloc->suivant, NULL);
+    return bloc;
+}
+
+static bool traceur_ecrire(FILE * fichier)
+{
+    FIL_TRACE * courant = NULL;
+    BLOC_TRACE * bloc = NULL;
+    const INTERVALLE * intervalle = NULL;
+    bool premier = true;
+    int i, nb;
+
+    fprintf(fichier, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for(courant=atomic_load(&tete_fil) ; courant ; courant=courant->suivant)
+    {
+        fprintf(fichier, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                "\"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                premier ? "" : ",", courant->numero, courant->nom);
+        premier = false;
+
+        for(bloc=courant->premier ; bloc ;
+            bloc=atomic_load_explicit(&bloc->suivant, memory_order_acquire))
+        {
+            nb = atomic_load_explicit(&bloc->nb, memory_order_acquire);
+            for(i=0 ; i<nb ; i++)
+            {
+                intervalle = &bloc->intervalles[i];
+                fprintf(fichier, ",\n{\"name\": \"%s\", \"ph\": \"X\", "
+                        "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, "
+                        "\"tid\": %d}", intervalle->nom,
+                        (intervalle->debut - origine)*1e6,
+                        (intervalle->fin - intervalle->debut)*1e6,
+                        courant->numero);
+            }
+        }
+    }
+    fprintf(fichier, "\n]}\n");
+
+    return !ferror(fichier);
+}
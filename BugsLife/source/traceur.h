@@ -0,0 +1,49 @@
+/*!
+ \file traceur.h
+ \brief Module qui trace la chronologie d'une exécution : chaque fil
+  range ses intervalles dans ses propres blocs, sans verrou, et le tout
+  est écrit à la fin au format JSON des traces de Chrome, lisible par
+  chrome://tracing et Perfetto
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef TRACEUR_H
+#define TRACEUR_H
+
+#include <stdbool.h>
+
+//---------------------------------------------------------------------
+// commence une chronologie qui sera écrite dans nom_fichier ; le fil
+// appelant est nommé "simulation"
+bool traceur_ouvrir(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// arrête la chronologie, l'écrit et libère les blocs de tous les fils ;
+// les autres fils doivent avoir fini de tracer. Renvoie 0 si une
+// écriture a échoué
+bool traceur_fermer(void);
+
+//---------------------------------------------------------------------
+// retourne vrai si une chronologie est en cours
+bool traceur_actif(void);
+
+//---------------------------------------------------------------------
+// donne son nom au fil appelant dans la chronologie
+void traceur_nommer_fil(const char * nom);
+
+//---------------------------------------------------------------------
+// retourne l'heure de début d'un intervalle, 0 sans chronologie
+double traceur_debut(void);
+
+//---------------------------------------------------------------------
+// ajoute au fil appelant l'intervalle nom, de debut à maintenant ; nom
+// doit rester valable jusqu'à traceur_fermer
+void traceur_intervalle(const char * nom, double debut);
+
+//---------------------------------------------------------------------
+// ajoute au fil appelant l'intervalle nom, de debut à fin
+void traceur_intervalle_fin(const char * nom, double debut, double fin);
+
+#endif
@@ -0,0 +1,888 @@
+/*!
+ \file trajectoire.c
+ \brief Module qui enregistre la trajectoire de chaque fourmi et de
+  chaque nourriture : positions arrondies écrites en écarts d'une mise à
+  jour à l'autre, apparitions et disparitions, en blocs compressés en
+  arrière-plan ; et qui relit ces blocs pour rejouer une exécution
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <zlib.h>
+#include "memoire.h"
+#include "binaire.h"
+#include "traceur.h"
+#include "trajectoire.h"
+
+// fichier : signature, version et précision, puis une section par bloc ;
+// chaque bloc se lit seul : il commence par l'état des fourmilières et
+// sa première mise à jour fait apparaître toutes les entités avec leur
+// position complète
+#define SIGNATURE_TRAJECTOIRE "BUGSTRAJ"
+#define TAILLE_SIGNATURE 8
+#define VERSION_TRAJECTOIRE 3
+#define SECTION_TRAJECTOIRE 0x4A415254 // "TRAJ"
+#define DIVISIONS_UNITE 64 // positions arrondies au 1/64 d'unité
+#define MAX_UPDATES_BLOC 256
+#define TAILLE_MAX_BLOC (4 << 20) // octets avant compression
+#define NB_TAMPONS 2 // un bloc se compresse pendant que le suivant se remplit
+#define AUCUN_BLOC UINT32_MAX // entité écrite dans aucun bloc
+#define NB_MIN_ENTITES 1024 // taille initiale de la table des entités relues
+
+/*---------------------------------------------------------------------
+ Structure de données d'un bloc de mises à jour avant compression
+	clef : état des fourmilières au début du bloc, non compressé
+	brut : pour chaque mise à jour, le nombre de disparitions,
+	       d'apparitions et de déplacements puis leurs flux
+	premier_update : numéro de la première mise à jour du bloc
+	nb_updates : nombre de mises à jour du bloc
+ ----------------------------------------------------------------------*/
+typedef struct BlocTrajectoire BLOC;
+struct BlocTrajectoire
+{
+    TAMPON * clef;
+    TAMPON * brut;
+    uint32_t premier_update;
+    uint32_t nb_updates;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un enregistreur de trajectoires
+	fichier : fichier ouvert en écriture, écrit seulement par le fil
+	nb_update : nombre de mises à jour terminées
+	bloc : numéro du bloc en cours
+	retraits , apparitions , deplacements : flux de la mise à jour en
+	                                        cours
+	nb_retraits , nb_apparitions , nb_deplacements : taille de ces flux
+	dernier_deplace : identifiant du déplacement précédent, écrit en écart
+	blocs : blocs remplis à tour de rôle
+	suivant : bloc en cours de remplissage
+	sortie : section compressée, utilisée seulement par le fil
+	compresse , capacite_compresse : zone de compression du fil
+	fil : fil de compression et d'écriture
+	verrou , condition : protègent a_ecrire, arret et erreur
+	a_ecrire : bloc confié au fil, NULL s'il n'écrit rien
+	arret : demande au fil de s'arrêter
+	erreur : vrai si une écriture a échoué
+ ----------------------------------------------------------------------*/
+struct Trajectoire
+{
+    FILE * fichier;
+    uint32_t nb_update;
+    uint32_t bloc;
+    TAMPON * retraits;
+    TAMPON * apparitions;
+    TAMPON * deplacements;
+    uint32_t nb_retraits;
+    uint32_t nb_apparitions;
+    uint32_t nb_deplacements;
+    uint32_t dernier_deplace;
+    BLOC blocs[NB_TAMPONS];
+    int suivant;
+    TAMPON * sortie;
+    unsigned char * compresse;
+    uLong capacite_compresse;
+    pthread_t fil;
+    pthread_mutex_t verrou;
+    pthread_cond_t condition;
+    BLOC * a_ecrire;
+    bool arret;
+    bool erreur;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'un bloc repéré dans un fichier relu
+	premier_update , nb_updates : mises à jour du bloc
+	clef : état des fourmilières au début du bloc
+	compresse : mises à jour compressées
+	taille_brute : taille des mises à jour une fois décompressées
+ ----------------------------------------------------------------------*/
+typedef struct IndexBloc INDEX_BLOC;
+struct IndexBloc
+{
+    uint32_t premier_update;
+    uint32_t nb_updates;
+    LECTURE_BINAIRE clef;
+    LECTURE_BINAIRE compresse;
+    uint32_t taille_brute;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'une entité de l'état relu
+	identifiant : identifiant de la trace, 0 pour une case vide
+	genre_f : indice de la fourmilière décalé de deux bits et genre
+	x , y : position arrondie
+ ----------------------------------------------------------------------*/
+typedef struct Entite ENTITE;
+struct Entite
+{
+    uint32_t identifiant;
+    uint32_t genre_f;
+    int32_t x;
+    int32_t y;
+};
+
+/*---------------------------------------------------------------------
+ Structure de données d'une relecture de trajectoires
+	fichier : contenu du fichier, projeté en mémoire
+	divisions : nombre de divisions d'une unité de position
+	blocs , nb_blocs , capacite_blocs : blocs du fichier dans l'ordre
+	bloc_courant : bloc de l'état relu, -1 avant la première relecture
+	brut , capacite_brut : mises à jour décompressées du bloc courant
+	position : prochaine mise à jour à relire dans brut
+	update_courant : mise à jour de l'état relu
+	entites , capacite_entites : table des entités présentes, adressée
+	                             par identifiant ; capacité puissance de 2
+	nb_entites : nombre d'entités présentes
+ ----------------------------------------------------------------------*/
+struct Relecture
+{
+    TAMPON * fichier;
+    double divisions;
+    INDEX_BLOC * blocs;
+    int nb_blocs;
+    int capacite_blocs;
+    int bloc_courant;
+    unsigned char * brut;
+    int capacite_brut;
+    LECTURE_BINAIRE position;
+    uint32_t update_courant;
+    ENTITE * entites;
+    uint32_t capacite_entites;
+    uint32_t nb_entites;
+};
+
+static uint32_t dernier_identifiant = 0;
+static uint32_t nb_blocs_crees = 0; // un numéro de bloc ne sert qu'une fois
+
+static void trajectoire_liberer(TRAJECTOIRE * trajectoire);
+static void trajectoire_vider_update(TRAJECTOIRE * trajectoire);
+static void trajectoire_ajouter_flux(TAMPON * brut, uint32_t nb, TAMPON * flux);
+static void trajectoire_confier(TRAJECTOIRE * trajectoire, BLOC * bloc);
+static void * trajectoire_ecrire(void * argument);
+static bool trajectoire_compresser(TRAJECTOIRE * trajectoire, const BLOC * bloc);
+static bool trajectoire_lire_bloc(LECTURE_BINAIRE * section, INDEX_BLOC * bloc);
+static int trajectoire_chercher_bloc(const RELECTURE * relecture, uint32_t update);
+static bool trajectoire_decompresser(RELECTURE * relecture, int i);
+static bool trajectoire_relire_update(RELECTURE * relecture);
+static uint32_t trajectoire_hacher(uint32_t identifiant, uint32_t masque);
+static ENTITE * trajectoire_case(const RELECTURE * relecture, uint32_t identifiant);
+static bool trajectoire_inserer(RELECTURE * relecture, const ENTITE * entite);
+static void trajectoire_supprimer(RELECTURE * relecture, uint32_t identifiant);
+static uint32_t trajectoire_zigzag(int32_t valeur);
+static int32_t trajectoire_dezigzag(uint32_t valeur);
+
+TRAJECTOIRE * trajectoire_creer(const char * nom_fichier)
+{
+    TRAJECTOIRE * trajectoire = NULL;
+    TAMPON * entete = NULL;
+    LECTURE_BINAIRE contenu;
+    int i;
+
+    if(!(trajectoire = (TRAJECTOIRE *) calloc (1, sizeof(TRAJECTOIRE))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+
+    trajectoire->retraits = binaire_creer();
+    trajectoire->apparitions = binaire_creer();
+    trajectoire->deplacements = binaire_creer();
+    trajectoire->sortie = binaire_creer();
+    for(i=0 ; i<NB_TAMPONS ; i++)
+    {
+        trajectoire->blocs[i].clef = binaire_creer();
+        trajectoire->blocs[i].brut = binaire_creer();
+    }
+    entete = binaire_creer();
+
+    if(!trajectoire->retraits || !trajectoire->apparitions ||
+       !trajectoire->deplacements || !trajectoire->sortie ||
+       !trajectoire->blocs[0].clef || !trajectoire->blocs[1].clef ||
+       !trajectoire->blocs[0].brut || !trajectoire->blocs[1].brut || !entete ||
+       !(trajectoire->fichier = fopen(nom_fichier, "wb")))
+    {
+        binaire_detruire(entete);
+        trajectoire_liberer(trajectoire);
+        return NULL;
+    }
+
+    //l'en-tête est écrit tout de suite, avant que le fil ne démarre
+    binaire_ecrire_octets(entete, SIGNATURE_TRAJECTOIRE, TAILLE_SIGNATURE);
+    binaire_ecrire_entier32(entete, VERSION_TRAJECTOIRE);
+    binaire_ecrire_entier32(entete, DIVISIONS_UNITE);
+    contenu = binaire_lecture(entete);
+    if(fwrite(contenu.pos, 1, contenu.fin - contenu.pos, trajectoire->fichier) !=
+       (size_t) (contenu.fin - contenu.pos))
+        trajectoire->erreur = true;
+    binaire_detruire(entete);
+
+    pthread_mutex_init(&trajectoire->verrou, NULL);
+    pthread_cond_init(&trajectoire->condition, NULL);
+    if(pthread_create(&trajectoire->fil, NULL, trajectoire_ecrire, trajectoire))
+    {
+        pthread_cond_destroy(&trajectoire->condition);
+        pthread_mutex_destroy(&trajectoire->verrou);
+        trajectoire_liberer(trajectoire);
+        return NULL;
+    }
+
+    trajectoire->bloc = nb_blocs_crees++;
+    return trajectoire;
+}
+
+bool trajectoire_detruire(TRAJECTOIRE * trajectoire)
+{
+    bool reussi;
+
+    if(!trajectoire)
+        return 1;
+
+    trajectoire_couper(trajectoire);
+
+    pthread_mutex_lock(&trajectoire->verrou);
+    trajectoire->arret = true;
+    pthread_cond_broadcast(&trajectoire->condition);
+    pthread_mutex_unlock(&trajectoire->verrou);
+
+    //le fil termine d'abord le bloc en cours
+    pthread_join(trajectoire->fil, NULL);
+
+    reussi = !trajectoire->erreur;
+    if(fclose(trajectoire->fichier))
+        reussi = false;
+    trajectoire->fichier = NULL;
+
+    pthread_cond_destroy(&trajectoire->condition);
+    pthread_mutex_destroy(&trajectoire->verrou);
+    trajectoire_liberer(trajectoire);
+
+    return reussi;
+}
+
+void trajectoire_trace_initialiser(TRACE * trace)
+{
+    trace->identifiant = ++dernier_identifiant;
+    trace->bloc = AUCUN_BLOC;
+}
+
+TAMPON * trajectoire_clef(TRAJECTOIRE * trajectoire)
+{
+    BLOC * bloc = &trajectoire->blocs[trajectoire->suivant];
+
+    return bloc->nb_updates ? NULL : bloc->clef;
+}
+
+void trajectoire_tracer(TRAJECTOIRE * trajectoire, TRACE * trace,
+                        enum GenreTrajectoire genre, unsigned indice_f,
+                        double x, double y)
+{
+    int32_t qx = (int32_t) lround(x*DIVISIONS_UNITE);
+    int32_t qy = (int32_t) lround(y*DIVISIONS_UNITE);
+    TAMPON * flux = NULL;
+
+    if(trace->bloc != trajectoire->bloc)
+    {
+        flux = trajectoire->apparitions;
+        binaire_ecrire_entier_variable(flux, trace->identifiant);
+        binaire_ecrire_entier_variable(flux, indice_f << 2 | genre);
+        binaire_ecrire_entier_variable(flux, trajectoire_zigzag(qx));
+        binaire_ecrire_entier_variable(flux, trajectoire_zigzag(qy));
+        trajectoire->nb_apparitions++;
+        trace->bloc = trajectoire->bloc;
+    }
+    //une entité immobile n'est pas écrite ; les entités sont parcourues
+    //dans l'ordre de leur liste : l'écart entre deux identifiants
+    //successifs tient le plus souvent sur un octet
+    else if(qx != trace->x || qy != trace->y)
+    {
+        flux = trajectoire->deplacements;
+        binaire_ecrire_entier_variable(flux, trajectoire_zigzag(
+                                       (int32_t) (trace->identifiant -
+                                                  trajectoire->dernier_deplace)));
+        binaire_ecrire_entier_variable(flux, trajectoire_zigzag(qx - trace->x));
+        binaire_ecrire_entier_variable(flux, trajectoire_zigzag(qy - trace->y));
+        trajectoire->dernier_deplace = trace->identifiant;
+        trajectoire->nb_deplacements++;
+    }
+
+    trace->x = qx;
+    trace->y = qy;
+}
+
+void trajectoire_retirer(TRAJECTOIRE * trajectoire, const TRACE * trace)
+{
+    if(trace->bloc != trajectoire->bloc)
+        return;
+
+    binaire_ecrire_entier_variable(trajectoire->retraits, trace->identifiant);
+    trajectoire->nb_retraits++;
+}
+
+void trajectoire_fin_update(TRAJECTOIRE * trajectoire)
+{
+    BLOC * bloc = &trajectoire->blocs[trajectoire->suivant];
+    LECTURE_BINAIRE brut;
+
+    trajectoire->nb_update++;
+    if(!bloc->nb_updates)
+        bloc->premier_update = trajectoire->nb_update;
+
+    //les disparitions d'abord : un identifiant ne revient jamais
+    binaire_ecrire_entier_variable(bloc->brut, trajectoire->nb_retraits);
+    binaire_ecrire_entier_variable(bloc->brut, trajectoire->nb_apparitions);
+    binaire_ecrire_entier_variable(bloc->brut, trajectoire->nb_deplacements);
+    trajectoire_ajouter_flux(bloc->brut, trajectoire->nb_retraits,
+                             trajectoire->retraits);
+    trajectoire_ajouter_flux(bloc->brut, trajectoire->nb_apparitions,
+                             trajectoire->apparitions);
+    trajectoire_ajouter_flux(bloc->brut, trajectoire->nb_deplacements,
+                             trajectoire->deplacements);
+    trajectoire_vider_update(trajectoire);
+    bloc->nb_updates++;
+
+    brut = binaire_lecture(bloc->brut);
+    if(bloc->nb_updates >= MAX_UPDATES_BLOC ||
+       brut.fin - brut.pos >= TAILLE_MAX_BLOC)
+        trajectoire_couper(trajectoire);
+}
+
+void trajectoire_couper(TRAJECTOIRE * trajectoire)
+{
+    BLOC * bloc = &trajectoire->blocs[trajectoire->suivant];
+
+    //ce qui a été noté depuis la dernière mise à jour terminée concerne
+    //des entités du bloc qui se termine
+    trajectoire_vider_update(trajectoire);
+    trajectoire->bloc = nb_blocs_crees++;
+
+    if(bloc->nb_updates)
+    {
+        trajectoire_confier(trajectoire, bloc);
+        trajectoire->suivant = (trajectoire->suivant + 1)%NB_TAMPONS;
+    }
+
+    //le fil n'écrit qu'un bloc à la fois : l'autre est libre
+    bloc = &trajectoire->blocs[trajectoire->suivant];
+    binaire_vider(bloc->clef);
+    binaire_vider(bloc->brut);
+    bloc->nb_updates = 0;
+}
+
+RELECTURE * trajectoire_relecture_ouvrir(const char * nom_fichier)
+{
+    RELECTURE * relecture = NULL;
+    LECTURE_BINAIRE lecture, section;
+    char signature[TAILLE_SIGNATURE];
+    uint32_t divisions;
+
+    if(!(relecture = (RELECTURE *) calloc (1, sizeof(RELECTURE))))
+    {
+        printf("Problème de mémoire dans la fonction %s\n", __func__);
+        return NULL;
+    }
+    relecture->bloc_courant = -1;
+
+    if(!(relecture->fichier = binaire_creer()) ||
+       !binaire_charger(relecture->fichier, nom_fichier))
+    {
+        trajectoire_relecture_fermer(relecture);
+        return NULL;
+    }
+
+    lecture = binaire_lecture(relecture->fichier);
+    binaire_lire_octets(&lecture, signature, TAILLE_SIGNATURE);
+    if(memcmp(signature, SIGNATURE_TRAJECTOIRE, TAILLE_SIGNATURE) ||
+       binaire_lire_entier32(&lecture) != VERSION_TRAJECTOIRE ||
+       !(divisions = binaire_lire_entier32(&lecture)) || lecture.erreur)
+    {
+        trajectoire_relecture_fermer(relecture);
+        return NULL;
+    }
+    relecture->divisions = divisions;
+
+    //un bloc tronqué par un arrêt pendant son écriture termine le fichier
+    while(binaire_section(&lecture, SECTION_TRAJECTOIRE, &section))
+    {
+        INDEX_BLOC * bloc = NULL;
+
+        if(!memoire_reserver((void **) &relecture->blocs,
+                             &relecture->capacite_blocs,
+                             relecture->nb_blocs + 1, sizeof(INDEX_BLOC)))
+        {
+            trajectoire_relecture_fermer(relecture);
+            return NULL;
+        }
+
+        bloc = &relecture->blocs[relecture->nb_blocs];
+        if(!trajectoire_lire_bloc(&section, bloc) ||
+           (relecture->nb_blocs &&
+            bloc->premier_update != relecture->blocs[relecture->nb_blocs-1].
+                                    premier_update +
+                                    relecture->blocs[relecture->nb_blocs-1].
+                                    nb_updates))
+            break;
+        relecture->nb_blocs++;
+    }
+
+    return relecture;
+}
+
+void trajectoire_relecture_fermer(RELECTURE * relecture)
+{
+    if(!relecture)
+        return;
+
+    binaire_detruire(relecture->fichier);
+    free(relecture->blocs);
+    free(relecture->brut);
+    free(relecture->entites);
+    free(relecture);
+}
+
+uint32_t trajectoire_relecture_nb_updates(const RELECTURE * relecture)
+{
+    const INDEX_BLOC * dernier = NULL;
+
+    if(!relecture->nb_blocs)
+        return 0;
+
+    dernier = &relecture->blocs[relecture->nb_blocs - 1];
+    return dernier->premier_update + dernier->nb_updates - 1;
+}
+
+bool trajectoire_relecture_aller(RELECTURE * relecture, uint32_t update)
+{
+    int i = trajectoire_chercher_bloc(relecture, update);
+
+    if(i < 0)
+        return 0;
+
+    //avancer dans le bloc courant coûte moins que le relire depuis le
+    //début ; sinon seul le bloc de la mise à jour est décompressé
+    if(i != relecture->bloc_courant || update < relecture->update_courant)
+    {
+        if(!trajectoire_decompresser(relecture, i))
+        {
+            relecture->bloc_courant = -1;
+            return 0;
+        }
+    }
+
+    while(relecture->update_courant < update)
+        if(!trajectoire_relire_update(relecture))
+        {
+            relecture->bloc_courant = -1;
+            return 0;
+        }
+
+    return 1;
+}
+
+LECTURE_BINAIRE trajectoire_relecture_clef(const RELECTURE * relecture)
+{
+    LECTURE_BINAIRE vide = {NULL, NULL, true};
+
+    if(relecture->bloc_courant < 0)
+        return vide;
+
+    return relecture->blocs[relecture->bloc_courant].clef;
+}
+
+void trajectoire_relecture_parcourir(const RELECTURE * relecture,
+                                     void (*placer)(enum GenreTrajectoire genre,
+                                                    unsigned indice_f,
+                                                    double x, double y))
+{
+    uint32_t i;
+
+    for(i=0 ; i<relecture->capacite_entites ; i++)
+    {
+        const ENTITE * entite = &relecture->entites[i];
+
+        if(entite->identifiant)
+            placer((enum GenreTrajectoire) (entite->genre_f & 3),
+                   entite->genre_f >> 2, entite->x/relecture->divisions,
+                   entite->y/relecture->divisions);
+    }
+}
+
+//---------------------------------------------------------------------
+// libère les tampons et la structure, sans toucher au fil
+static void trajectoire_liberer(TRAJECTOIRE * trajectoire)
+{
+    int i;
+
+    if(trajectoire->fichier)
+        fclose(trajectoire->fichier);
+    binaire_detruire(trajectoire->retraits);
+    binaire_detruire(trajectoire->apparitions);
+    binaire_detruire(trajectoire->deplacements);
+    binaire_detruire(trajectoire->sortie);
+    for(i=0 ; i<NB_TAMPONS ; i++)
+    {
+        binaire_detruire(trajectoire->blocs[i].clef);
+        binaire_detruire(trajectoire->blocs[i].brut);
+    }
+    free(trajectoire->compresse);
+    free(trajectoire);
+}
+
+//---------------------------------------------------------------------
+// vide les flux de la mise à jour en cours en gardant leur capacité
+static void trajectoire_vider_update(TRAJECTOIRE * trajectoire)
+{
+    binaire_vider(trajectoire->retraits);
+    binaire_vider(trajectoire->apparitions);
+    binaire_vider(trajectoire->deplacements);
+    trajectoire->nb_retraits = 0;
+    trajectoire->nb_apparitions = 0;
+    trajectoire->nb_deplacements = 0;
+    trajectoire->dernier_deplace = 0;
+}
+
+//---------------------------------------------------------------------
+// recopie un flux non vide à la fin du bloc brut
+static void trajectoire_ajouter_flux(TAMPON * brut, uint32_t nb, TAMPON * flux)
+{
+    LECTURE_BINAIRE contenu = binaire_lecture(flux);
+
+    if(nb)
+        binaire_ecrire_octets(brut, contenu.pos, contenu.fin - contenu.pos);
+}
+
+//---------------------------------------------------------------------
+// attend que le fil ait fini le bloc précédent puis lui confie le bloc
+static void trajectoire_confier(TRAJECTOIRE * trajectoire, BLOC * bloc)
+{
+    double debut = traceur_debut();
+
+    pthread_mutex_lock(&trajectoire->verrou);
+    while(trajectoire->a_ecrire)
+        pthread_cond_wait(&trajectoire->condition, &trajectoire->verrou);
+    trajectoire->a_ecrire = bloc;
+    pthread_cond_broadcast(&trajectoire->condition);
+    pthread_mutex_unlock(&trajectoire->verrou);
+    traceur_intervalle("confier_trajectoires", debut);
+}
+
+//---------------------------------------------------------------------
+// boucle du fil : compresse chaque bloc confié et l'ajoute au fichier
+static void * trajectoire_ecrire(void * argument)
+{
+    TRAJECTOIRE * trajectoire = (TRAJECTOIRE *) argument;
+    LECTURE_BINAIRE contenu;
+    double debut;
+    bool reussi;
+
+    traceur_nommer_fil("trajectoires");
+    pthread_mutex_lock(&trajectoire->verrou);
+    while(true)
+    {
+        while(!trajectoire->a_ecrire && !trajectoire->arret)
+            pthread_cond_wait(&trajectoire->condition, &trajectoire->verrou);
+        if(!trajectoire->a_ecrire)
+            break;
+
+        //la compression se fait sans le verrou : la simulation continue
+        pthread_mutex_unlock(&trajectoire->verrou);
+        debut = traceur_debut();
+        reussi = trajectoire_compresser(trajectoire, trajectoire->a_ecrire);
+        if(reussi)
+        {
+            contenu = binaire_lecture(trajectoire->sortie);
+            reussi = fwrite(contenu.pos, 1, contenu.fin - contenu.pos,
+                            trajectoire->fichier) ==
+                     (size_t) (contenu.fin - contenu.pos) &&
+                     !fflush(trajectoire->fichier);
+        }
+        traceur_intervalle("ecriture_trajectoires", debut);
+        pthread_mutex_lock(&trajectoire->verrou);
+
+        if(!reussi)
+            trajectoire->erreur = true;
+        trajectoire->a_ecrire = NULL;
+        pthread_cond_broadcast(&trajectoire->condition);
+    }
+    pthread_mutex_unlock(&trajectoire->verrou);
+
+    return NULL;
+}
+
+//---------------------------------------------------------------------
+// met le bloc en forme dans sortie : premier numéro de mise à jour,
+// nombre de mises à jour, clef, taille brute puis le contenu compressé
+static bool trajectoire_compresser(TRAJECTOIRE * trajectoire, const BLOC * bloc)
+{
+    LECTURE_BINAIRE clef = binaire_lecture(bloc->clef);
+    LECTURE_BINAIRE brut = binaire_lecture(bloc->brut);
+    uLong taille_brute = brut.fin - brut.pos;
+    uLongf taille = compressBound(taille_brute);
+    unsigned char * compresse = NULL;
+    size_t debut;
+
+    if(binaire_get_erreur(bloc->clef) || binaire_get_erreur(bloc->brut))
+        return 0;
+
+    if(taille > trajectoire->capacite_compresse)
+    {
+        //realloc directement : les allocations du fil d'écriture ne sont
+        //pas comptées avec celles de la simulation
+        if(!(compresse = (unsigned char *) realloc (trajectoire->compresse,
+                                                    taille)))
+        {
+            printf("Problème de mémoire dans la fonction %s\n", __func__);
+            return 0;
+        }
+        trajectoire->compresse = compresse;
+        trajectoire->capacite_compresse = taille;
+    }
+
+    //le niveau le plus rapide : le fil doit suivre la simulation
+    if(compress2(trajectoire->compresse, &taille, brut.pos, taille_brute,
+                 Z_BEST_SPEED) != Z_OK)
+        return 0;
+
+    binaire_vider(trajectoire->sortie);
+    debut = binaire_debut_section(trajectoire->sortie, SECTION_TRAJECTOIRE);
+    binaire_ecrire_entier32(trajectoire->sortie, bloc->premier_update);
+    binaire_ecrire_entier32(trajectoire->sortie, bloc->nb_updates);
+    binaire_ecrire_entier32(trajectoire->sortie, clef.fin - clef.pos);
+    binaire_ecrire_octets(trajectoire->sortie, clef.pos, clef.fin - clef.pos);
+    binaire_ecrire_entier32(trajectoire->sortie, taille_brute);
+    binaire_ecrire_octets(trajectoire->sortie, trajectoire->compresse, taille);
+    binaire_fin_section(trajectoire->sortie, debut);
+
+    return !binaire_get_erreur(trajectoire->sortie);
+}
+
+//---------------------------------------------------------------------
+// repère les parties d'une section de bloc sans la décompresser
+static bool trajectoire_lire_bloc(LECTURE_BINAIRE * section, INDEX_BLOC * bloc)
+{
+    uint32_t taille_clef;
+
+    bloc->premier_update = binaire_lire_entier32(section);
+    bloc->nb_updates = binaire_lire_entier32(section);
+    taille_clef = binaire_lire_entier32(section);
+
+    if(section->erreur || !bloc->premier_update || !bloc->nb_updates ||
+       taille_clef > (size_t) (section->fin - section->pos))
+        return 0;
+
+    bloc->clef.pos = section->pos;
+    bloc->clef.fin = section->pos + taille_clef;
+    bloc->clef.erreur = false;
+    section->pos += taille_clef;
+
+    bloc->taille_brute = binaire_lire_entier32(section);
+    bloc->compresse = *section;
+
+    return !section->erreur && bloc->taille_brute <= INT_MAX;
+}
+
+//---------------------------------------------------------------------
+// indice du bloc qui contient la mise à jour, -1 si aucun
+static int trajectoire_chercher_bloc(const RELECTURE * relecture, uint32_t update)
+{
+    int debut = 0, fin = relecture->nb_blocs - 1;
+
+    //les blocs se suivent sans trou : recherche par dichotomie
+    while(debut <= fin)
+    {
+        int milieu = (debut + fin)/2;
+        const INDEX_BLOC * bloc = &relecture->blocs[milieu];
+
+        if(update < bloc->premier_update)
+            fin = milieu - 1;
+        else if(update - bloc->premier_update >= bloc->nb_updates)
+            debut = milieu + 1;
+        else
+            return milieu;
+    }
+
+    return -1;
+}
+
+//---------------------------------------------------------------------
+// décompresse le bloc i et place l'état relu juste avant sa première
+// mise à jour, sans aucune entité
+static bool trajectoire_decompresser(RELECTURE * relecture, int i)
+{
+    const INDEX_BLOC * bloc = &relecture->blocs[i];
+    uLongf taille = bloc->taille_brute;
+
+    if(!memoire_reserver((void **) &relecture->brut, &relecture->capacite_brut,
+                         bloc->taille_brute ? bloc->taille_brute : 1, 1) ||
+       uncompress(relecture->brut, &taille, bloc->compresse.pos,
+                  bloc->compresse.fin - bloc->compresse.pos) != Z_OK ||
+       taille != bloc->taille_brute)
+        return 0;
+
+    if(relecture->entites)
+        memset(relecture->entites, 0,
+               relecture->capacite_entites*sizeof(ENTITE));
+    relecture->nb_entites = 0;
+
+    relecture->position.pos = relecture->brut;
+    relecture->position.fin = relecture->brut + taille;
+    relecture->position.erreur = false;
+    relecture->update_courant = bloc->premier_update - 1;
+    relecture->bloc_courant = i;
+    return 1;
+}
+
+//---------------------------------------------------------------------
+// applique la mise à jour suivante du bloc courant à l'état relu
+static bool trajectoire_relire_update(RELECTURE * relecture)
+{
+    LECTURE_BINAIRE * lecture = &relecture->position;
+    uint32_t nb_retraits = binaire_lire_entier_variable(lecture);
+    uint32_t nb_apparitions = binaire_lire_entier_variable(lecture);
+    uint32_t nb_deplacements = binaire_lire_entier_variable(lecture);
+    uint32_t i, identifiant = 0;
+    ENTITE entite, * deplacee = NULL;
+
+    for(i=0 ; i<nb_retraits && !lecture->erreur ; i++)
+        trajectoire_supprimer(relecture, binaire_lire_entier_variable(lecture));
+
+    for(i=0 ; i<nb_apparitions && !lecture->erreur ; i++)
+    {
+        entite.identifiant = binaire_lire_entier_variable(lecture);
+        entite.genre_f = binaire_lire_entier_variable(lecture);
+        entite.x = trajectoire_dezigzag(binaire_lire_entier_variable(lecture));
+        entite.y = trajectoire_dezigzag(binaire_lire_entier_variable(lecture));
+        if(!entite.identifiant || !trajectoire_inserer(relecture, &entite))
+            return 0;
+    }
+
+    for(i=0 ; i<nb_deplacements && !lecture->erreur ; i++)
+    {
+        identifiant += trajectoire_dezigzag(binaire_lire_entier_variable(lecture));
+        deplacee = trajectoire_case(relecture, identifiant);
+        if(!deplacee || deplacee->identifiant != identifiant)
+            return 0;
+        deplacee->x += trajectoire_dezigzag(binaire_lire_entier_variable(lecture));
+        deplacee->y += trajectoire_dezigzag(binaire_lire_entier_variable(lecture));
+    }
+
+    relecture->update_courant++;
+    return !lecture->erreur;
+}
+
+//---------------------------------------------------------------------
+// case idéale d'un identifiant dans une table de masque + 1 cases ; les
+// identifiants se suivent : ils sont mélangés pour être répartis
+static uint32_t trajectoire_hacher(uint32_t identifiant, uint32_t masque)
+{
+    uint32_t h = identifiant*0x9E3779B1u;
+
+    return (h ^ h >> 16) & masque;
+}
+
+//---------------------------------------------------------------------
+// case de l'entité dans la table, ou case vide où elle serait rangée ;
+// NULL si la table n'existe pas encore
+static ENTITE * trajectoire_case(const RELECTURE * relecture, uint32_t identifiant)
+{
+    uint32_t masque = relecture->capacite_entites - 1, i;
+
+    if(!relecture->entites)
+        return NULL;
+
+    i = trajectoire_hacher(identifiant, masque);
+    while(relecture->entites[i].identifiant &&
+          relecture->entites[i].identifiant != identifiant)
+        i = (i + 1) & masque;
+
+    return &relecture->entites[i];
+}
+
+//---------------------------------------------------------------------
+// ajoute une entité à la table, qui double quand elle est à moitié
+// pleine
+static bool trajectoire_inserer(RELECTURE * relecture, const ENTITE * entite)
+{
+    ENTITE * ancienne = relecture->entites, * place = NULL;
+    uint32_t ancienne_capacite = relecture->capacite_entites, i;
+
+    if(2*(relecture->nb_entites + 1) > relecture->capacite_entites)
+    {
+        uint32_t capacite = ancienne_capacite ? 2*ancienne_capacite :
+                                                NB_MIN_ENTITES;
+
+        if(!(relecture->entites = (ENTITE *) calloc (capacite, sizeof(ENTITE))))
+        {
+            printf("Problème de mémoire dans la fonction %s\n", __func__);
+            relecture->entites = ancienne;
+            return 0;
+        }
+        relecture->capacite_entites = capacite;
+
+        for(i=0 ; i<ancienne_capacite ; i++)
+            if(ancienne[i].identifiant)
+                *trajectoire_case(relecture, ancienne[i].identifiant) =
+                    ancienne[i];
+        free(ancienne);
+    }
+
+    place = trajectoire_case(relecture, entite->identifiant);
+    if(!place->identifiant)
+        relecture->nb_entites++;
+    *place = *entite;
+    return 1;
+}
+
+//---------------------------------------------------------------------
+// retire une entité de la table en ramenant les suivantes de la même
+// série pour qu'aucune recherche ne s'arrête sur la case libérée
+static void trajectoire_supprimer(RELECTURE * relecture, uint32_t identifiant)
+{
+    ENTITE * entites = relecture->entites;
+    uint32_t masque = relecture->capacite_entites - 1, i, j, k;
+    ENTITE * place = trajectoire_case(relecture, identifiant);
+
+    if(!place || place->identifiant != identifiant)
+        return;
+
+    i = place - entites;
+    for(j = (i + 1) & masque ; entites[j].identifiant ; j = (j + 1) & masque)
+    {
+        k = trajectoire_hacher(entites[j].identifiant, masque);
+
+        //l'entité j peut combler le trou si sa case idéale n'est pas
+        //entre le trou (exclu) et elle
+        if((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j))
+        {
+            entites[i] = entites[j];
+            i = j;
+        }
+    }
+
+    entites[i].identifiant = 0;
+    relecture->nb_entites--;
+}
+
+//---------------------------------------------------------------------
+// range les petites valeurs négatives comme les petites positives pour
+// qu'elles tiennent sur peu d'octets
+static uint32_t trajectoire_zigzag(int32_t valeur)
+{
+    return valeur < 0 ? ~((uint32_t) valeur << 1) : (uint32_t) valeur << 1;
+}
+
+//---------------------------------------------------------------------
+// inverse de trajectoire_zigzag
+static int32_t trajectoire_dezigzag(uint32_t valeur)
+{
+    return (int32_t) (valeur >> 1) ^ -(int32_t) (valeur & 1);
+}
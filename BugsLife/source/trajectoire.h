@@ -0,0 +1,114 @@
+/*!
+ \file trajectoire.h
+ \brief Module qui enregistre la trajectoire de chaque fourmi et de
+  chaque nourriture : positions arrondies écrites en écarts d'une mise à
+  jour à l'autre, apparitions et disparitions, en blocs compressés en
+  arrière-plan ; et qui relit ces blocs pour rejouer une exécution
+ \author Bromet Juliette et Gervaise Lara
+ \version 3
+ \date mai 2017
+ */
+
+#ifndef TRAJECTOIRE_H
+#define TRAJECTOIRE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "binaire.h"
+
+enum GenreTrajectoire {TRAJECTOIRE_OUVRIERE, TRAJECTOIRE_GARDE,
+                       TRAJECTOIRE_NOURRITURE};
+
+/*---------------------------------------------------------------------
+ Structure de données de la trace d'une entité dans l'enregistrement des
+ trajectoires : type concret, rangé dans chaque fourmi et nourriture
+	identifiant : numéro unique de l'entité pendant l'exécution
+	bloc : bloc où l'entité a été écrite en dernier ; dans un autre bloc
+	       elle doit apparaître à nouveau avec sa position complète
+	x , y : dernière position arrondie écrite
+ ----------------------------------------------------------------------*/
+typedef struct Trace TRACE;
+struct Trace
+{
+    uint32_t identifiant;
+    uint32_t bloc;
+    int32_t x;
+    int32_t y;
+};
+
+typedef struct Trajectoire TRAJECTOIRE;
+
+typedef struct Relecture RELECTURE;
+
+//---------------------------------------------------------------------
+// crée le fichier de trajectoires et lance son fil d'écriture
+TRAJECTOIRE * trajectoire_creer(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// écrit le dernier bloc, arrête le fil d'écriture et ferme le fichier ;
+// renvoie 0 si une écriture a échoué
+bool trajectoire_detruire(TRAJECTOIRE * trajectoire);
+
+//---------------------------------------------------------------------
+// donne un nouvel identifiant à une entité qui n'a encore été écrite
+// dans aucun bloc
+void trajectoire_trace_initialiser(TRACE * trace);
+
+//---------------------------------------------------------------------
+// tampon où écrire l'état des fourmilières au début d'un nouveau bloc,
+// ou NULL si le bloc en cours a déjà le sien
+TAMPON * trajectoire_clef(TRAJECTOIRE * trajectoire);
+
+//---------------------------------------------------------------------
+// ajoute à la mise à jour en cours l'apparition de l'entité si elle est
+// absente du bloc, sinon son déplacement arrondi s'il n'est pas nul
+void trajectoire_tracer(TRAJECTOIRE * trajectoire, TRACE * trace,
+                        enum GenreTrajectoire genre, unsigned indice_f,
+                        double x, double y);
+
+//---------------------------------------------------------------------
+// ajoute à la mise à jour en cours la disparition de l'entité si elle a
+// été écrite dans le bloc
+void trajectoire_retirer(TRAJECTOIRE * trajectoire, const TRACE * trace);
+
+//---------------------------------------------------------------------
+// termine la mise à jour en cours ; un bloc plein est confié au fil
+// d'écriture
+void trajectoire_fin_update(TRAJECTOIRE * trajectoire);
+
+//---------------------------------------------------------------------
+// confie le bloc en cours au fil d'écriture même s'il n'est pas plein :
+// toutes les entités réapparaissent dans le bloc suivant
+void trajectoire_couper(TRAJECTOIRE * trajectoire);
+
+//---------------------------------------------------------------------
+// ouvre un fichier de trajectoires et repère le début de chaque bloc ;
+// renvoie NULL s'il ne peut pas être relu
+RELECTURE * trajectoire_relecture_ouvrir(const char * nom_fichier);
+
+//---------------------------------------------------------------------
+// ferme le fichier et libère l'état relu
+void trajectoire_relecture_fermer(RELECTURE * relecture);
+
+//---------------------------------------------------------------------
+// numéro de la dernière mise à jour enregistrée, 0 s'il n'y en a aucune
+uint32_t trajectoire_relecture_nb_updates(const RELECTURE * relecture);
+
+//---------------------------------------------------------------------
+// place l'état relu à la mise à jour update : depuis l'état courant si
+// elle est plus loin dans le même bloc, sinon depuis le début de son
+// bloc ; renvoie 0 si elle n'existe pas ou si le bloc est abîmé
+bool trajectoire_relecture_aller(RELECTURE * relecture, uint32_t update);
+
+//---------------------------------------------------------------------
+// état des fourmilières au début du bloc de l'état relu
+LECTURE_BINAIRE trajectoire_relecture_clef(const RELECTURE * relecture);
+
+//---------------------------------------------------------------------
+// appelle placer pour chaque entité présente dans l'état relu
+void trajectoire_relecture_parcourir(const RELECTURE * relecture,
+                                     void (*placer)(enum GenreTrajectoire genre,
+                                                    unsigned indice_f,
+                                                    double x, double y));
+
+#endif
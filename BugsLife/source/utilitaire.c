@@ -11,10 +11,22 @@
 #include <math.h>
 #include <stdbool.h>
 #include "constantes.h"
+#include "compteur.h"
 #include "utilitaire.h"
 
+//---------------------------------------------------------------------
+// fait descendre l'élément racine dans le tas des nb premiers éléments
+static void utilitaire_tamiser(char * base, size_t racine, size_t nb,
+                               size_t taille,
+                               int (*comparer)(const void *, const void *));
+
+//---------------------------------------------------------------------
+// échange deux éléments de taille taille
+static void utilitaire_echanger(char * a, char * b, size_t taille);
+
 double utilitaire_calcul_norme(double x1, double x2, double y1, double y2)
 {
+    COMPTER(COMPTEUR_CALCUL_NORME);
     return sqrt(pow(x1 - x2, 2) + pow(y1 - y2, 2));
 }
 
@@ -34,6 +46,7 @@ double utilitaire_distance_point_droite(double posx, double butx, double posy,
 {
     double pente, ordonnee_origine, d;
     
+    COMPTER(COMPTEUR_DISTANCE_POINT_DROITE);
     VECTOR v;
     v.x = butx - posx;
     v.y = buty - posy;
@@ -70,3 +83,54 @@ bool utilitaire_contact(double x1, double x2, double y1,
     
     return 0;
 }
+
+void utilitaire_trier(void * tab, size_t nb, size_t taille,
+                      int (*comparer)(const void *, const void *))
+{
+    char * base = (char *) tab;
+    size_t i, fin;
+    
+    if(nb < 2)
+        return;
+    
+    for(i=nb/2 ; i-- > 0 ; )
+        utilitaire_tamiser(base, i, nb, taille, comparer);
+    
+    //le plus grand élément du tas passe à la fin de la partie triée
+    for(fin=nb-1 ; fin>0 ; fin--)
+    {
+        utilitaire_echanger(base, base + fin*taille, taille);
+        utilitaire_tamiser(base, 0, fin, taille, comparer);
+    }
+}
+
+static void utilitaire_tamiser(char * base, size_t racine, size_t nb,
+                               size_t taille,
+                               int (*comparer)(const void *, const void *))
+{
+    size_t enfant;
+    
+    while((enfant = 2*racine + 1) < nb)
+    {
+        if(enfant + 1 < nb && 
+           comparer(base + enfant*taille, base + (enfant + 1)*taille) < 0)
+            enfant++;
+        if(comparer(base + racine*taille, base + enfant*taille) >= 0)
+            return;
+        
+        utilitaire_echanger(base + racine*taille, base + enfant*taille, taille);
+        racine = enfant;
+    }
+}
+
+static void utilitaire_echanger(char * a, char * b, size_t taille)
+{
+    char echange;
+    
+    while(taille--)
+    {
+        echange = *a;
+        *a++ = *b;
+        *b++ = echange;
+    }
+}
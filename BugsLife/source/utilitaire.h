@@ -9,6 +9,9 @@
 #ifndef UTILITAIRE_H
 #define UTILITAIRE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 /*---------------------------------------------------------------------
  Structure de données d'un vecteur : type concret
 	x , y : coordonnées du vecteur avec par exemple
@@ -48,4 +51,11 @@ bool utilitaire_contact_sans_tolerance(double x1, double x2, double y1,
 bool utilitaire_contact(double x1, double x2, double y1,
                         double y2, double r1, double r2);
 
+//---------------------------------------------------------------------
+// trie sur place nb éléments de taille taille par tas, sans allocation
+// sur le tas contrairement à qsort ; l'ordre de deux éléments égaux
+// n'est pas conservé
+void utilitaire_trier(void * tab, size_t nb, size_t taille,
+                      int (*comparer)(const void *, const void *));
+
 #endif